@@ -0,0 +1,151 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+// What a list of 100k entries keeps in memory once its pages are swapped out (see list_trim), by what it's for:
+// the paths, ids and page headers from loading, the strings of the pages left in memory, the orders of the three sorts,
+// and the search index. Heap in use as glibc tells it, so a 64 bit build: the pointer to each path is half that on the console
+
+#include <malloc.h>
+
+#include "test.h"
+#include "entries_list.h"
+#include "loading.h"
+#include "draw.h"
+#include "unicode.h"
+#include "search_index.h"
+
+#define BENCH_ENTRIES 100000
+
+static const char * const roots[] = { "/bench_entries/" };
+
+static const char * const words[] = {
+    "blue", "night", "sakura", "pixel", "retro", "ocean", "forest", "kawaii", "dark", "minimal", "star", "neon",
+    "autumn", "winter", "dragon", "cat", "garden", "galaxy", "dream", "city", "rain", "sunset", "music", "cozy",
+};
+
+// words until len characters, about what the themes on ThemePlaza have
+static void make_words(u16 * out, u32 * state, int len, int max)
+{
+    char buf[0x100] = {0};
+    int used = 0;
+    while(used < len)
+        used += sprintf(buf + used, "%s%s", used ? " " : "", words[test_random(state) % (sizeof(words) / sizeof(words[0]))]);
+    buf[max - 1] = '\0';
+    for(int i = 0; buf[i]; i++)
+        out[i] = buf[i];
+}
+
+static size_t heap_used(void)
+{
+    const struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+static void print_line(const char * what, size_t bytes)
+{
+    printf("%-32s %10zu  %7.1f\n", what, bytes, (double)bytes / BENCH_ENTRIES);
+}
+
+int main(void)
+{
+    platform_archive_open(PLATFORM_ARCHIVE_SD, 0);
+    platform_dir_create(PLATFORM_ARCHIVE_SD, u"/3ds");
+    platform_dir_create(PLATFORM_ARCHIVE_SD, u"/3ds/" APP_TITLE);
+    platform_dir_create(PLATFORM_ARCHIVE_SD, u"/3ds/" APP_TITLE "/cache");
+
+    u16 path[0x106] = {0};
+    struacat(path, roots[0]);
+    platform_dir_delete(PLATFORM_ARCHIVE_SD, path);
+    platform_dir_create(PLATFORM_ARCHIVE_SD, path);
+    for(int i = 0; i < BENCH_ENTRIES; i++)
+    {
+        char name[0x80];
+        sprintf(name, "%s%05d Pastel Night Theme.zip", roots[0], i);
+        path[0] = 0;
+        struacat(path, name);
+        platform_file_create(PLATFORM_ARCHIVE_SD, path, 0);
+    }
+
+    const size_t start = heap_used();
+    Entry_List_s list = {0};
+    list.mode = MODE_THEMES;
+    list.entries_loaded = 4;
+    // nothing saves the entries index
+    list.info_loading = true;
+    load_entries(roots, 1, &list, INSTALL_LOADING_THEMES);
+    list_trim(&list);
+    const size_t loaded = heap_used();
+
+    // what the info thread would parse from the info.smdh of every entry
+    u32 state = 1;
+    Icon_s * icon = malloc(sizeof(Icon_s));
+    for(int id = 0; id < list.entries_count; id++)
+    {
+        memset(icon, 0, sizeof(Icon_s));
+        make_words(icon->name, &state, 20, 0x40);
+        make_words(icon->desc, &state, 60, 0x80);
+        make_words(icon->author, &state, 8, 0x40);
+        Entry_s * entry = get_entry_at(&list, id);
+        parse_smdh(icon, entry, entry->path, list_entry_strings(&list, entry));
+        entry->info_pending = false;
+        if(id % ENTRIES_PAGE_SIZE == ENTRIES_PAGE_SIZE - 1)
+            list_trim(&list);
+    }
+    free(icon);
+    list.info_generation++;
+    list_trim(&list);
+    const size_t parsed = heap_used();
+
+    sort_by_name(&list);
+    list_trim(&list);
+    sort_by_author(&list);
+    list_trim(&list);
+    sort_by_filename(&list);
+    list_trim(&list);
+    const size_t sorted = heap_used();
+
+    Search_Index_s index = {0};
+    search_index_build(&index, &list);
+    const size_t indexed = heap_used();
+
+    printf("%d entries, %d of %d pages in memory\n", list.entries_count, list.resident_pages, (list.entries_count + ENTRIES_PAGE_SIZE - 1) / ENTRIES_PAGE_SIZE);
+    printf("%-32s %10s  %7s\n", "", "bytes", "/entry");
+    print_line("paths, ids and pages", loaded - start);
+    print_line("strings of the pages in memory", parsed - loaded);
+    print_line("sort orders", sorted - parsed);
+    print_line("search index", indexed - sorted);
+    print_line("total", indexed - start);
+
+    search_index_free(&index);
+    free_sort_orders(&list);
+    list_free_entries(&list);
+    arena_free(&list.strings);
+    path[0] = 0;
+    struacat(path, roots[0]);
+    platform_dir_delete(PLATFORM_ARCHIVE_SD, path);
+    platform_archive_close(PLATFORM_ARCHIVE_SD);
+    return 0;
+}
@@ -0,0 +1,146 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+// LZ11 compression and decompression speed (MB/s of decompressed data) and compression ratio, for every level.
+// Runs on the made up samples, and on the files given as arguments (a body_LZ.bin decompressed, for instance)
+
+#include "test.h"
+#include "lz.h"
+
+// each measure is repeated for at least that long
+#define BENCH_MIN_US 250000
+
+typedef struct {
+    const char * data;
+    u32 size;
+    u32 position;
+} Memory_Reader_s;
+
+static u32 memory_read_callback(void * userdata, char * buf, u32 size)
+{
+    Memory_Reader_s * reader = userdata;
+    const u32 read = min(size, reader->size - reader->position);
+    memcpy(buf, reader->data + reader->position, read);
+    reader->position += read;
+    return read;
+}
+
+static bool discard_callback(void * userdata, const char * buf, u32 size)
+{
+    (void)userdata;
+    (void)buf;
+    (void)size;
+    return true;
+}
+
+static double megabytes_per_second(u64 bytes, u64 us)
+{
+    return us ? (double)bytes / us : 0;
+}
+
+static void bench(const char * name, const char * data, u32 size)
+{
+    for(LZ11_Level level = 0; level < LZ11_LEVEL_AMOUNT; level++)
+    {
+        char * compressed = NULL;
+        u32 compressed_size = 0;
+        u64 runs = 0;
+        const u64 compress_start = platform_ticks();
+        u64 compress_us;
+        do {
+            free(compressed);
+            compressed_size = lz11_compress(data, size, &compressed, level);
+            runs++;
+        } while((compress_us = platform_ticks_to_us(platform_ticks() - compress_start)) < BENCH_MIN_US);
+        const double compress_speed = megabytes_per_second(runs * size, compress_us);
+
+        if(compressed_size == 0)
+        {
+            printf("%-24s %d  couldn't be compressed\n", name, level);
+            continue;
+        }
+
+        runs = 0;
+        u32 decompressed_size = 0;
+        const u64 decompress_start = platform_ticks();
+        u64 decompress_us;
+        do {
+            Memory_Reader_s reader = {compressed, compressed_size, 0};
+            decompressed_size = lz11_decompress_stream(memory_read_callback, &reader, discard_callback, NULL);
+            runs++;
+        } while((decompress_us = platform_ticks_to_us(platform_ticks() - decompress_start)) < BENCH_MIN_US);
+        const double decompress_speed = megabytes_per_second(runs * size, decompress_us);
+
+        printf("%-24s %d  %9u -> %9u  %6.3f  %9.2f  %9.2f%s\n", name, level, size, compressed_size,
+               (double)compressed_size / size, compress_speed, decompress_speed,
+               decompressed_size == size ? "" : "  wrong size");
+        free(compressed);
+    }
+}
+
+static char * read_host_file(const char * path, u32 * size)
+{
+    FILE * file = fopen(path, "rb");
+    if(file == NULL)
+        return NULL;
+    fseek(file, 0, SEEK_END);
+    *size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char * data = malloc(*size ? *size : 1);
+    if(fread(data, 1, *size, file) != *size)
+    {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    return data;
+}
+
+int main(int argc, char ** argv)
+{
+    printf("%-24s %s  %9s    %9s  %6s  %9s  %9s\n", "data", "L", "size", "lz size", "ratio", "comp MB/s", "dec MB/s");
+
+    Sample_s samples[SAMPLES_AMOUNT];
+    samples_make(samples);
+    for(int i = 0; i < SAMPLES_AMOUNT; i++)
+        bench(samples[i].name, samples[i].data, samples[i].size);
+    samples_free(samples);
+
+    for(int i = 1; i < argc; i++)
+    {
+        u32 size = 0;
+        char * data = read_host_file(argv[i], &size);
+        if(data == NULL)
+        {
+            DEBUG("couldn't read %s\n", argv[i]);
+            continue;
+        }
+        bench(argv[i], data, size);
+        free(data);
+    }
+
+    return 0;
+}
@@ -0,0 +1,183 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+// LZ11 decode kernel speed (MB/s of decompressed data): the reference decoder going one token at a time like the old loop,
+// a single lz11_stream_read into the whole output like decompress_lz_file, and reads of a chunk like lz11_decompress_stream.
+// Runs on the samples compressed at every level, and on the files given as arguments:
+// body_LZ.bin files are used as they are, anything else is compressed first
+
+#include "test.h"
+#include "lz.h"
+
+// each measure is repeated for at least that long
+#define BENCH_MIN_US 250000
+
+typedef struct {
+    const u8 * data;
+    u32 size;
+    u32 position;
+} Memory_Reader_s;
+
+static u32 memory_read_callback(void * userdata, char * buf, u32 size)
+{
+    Memory_Reader_s * reader = userdata;
+    const u32 read = min(size, reader->size - reader->position);
+    memcpy(buf, reader->data + reader->position, read);
+    reader->position += read;
+    return read;
+}
+
+static u32 decode_reference(const u8 * compressed, u32 compressed_size, u8 * out)
+{
+    (void)out;
+    u8 * decompressed = NULL;
+    const u32 size = reference_lz11_decompress(compressed, compressed_size, &decompressed);
+    free(decompressed);
+    return size;
+}
+
+static u32 decode_stream(const u8 * compressed, u32 compressed_size, u8 * out, u32 read_size)
+{
+    static LZ11_Stream_s stream;
+    Memory_Reader_s reader = {compressed, compressed_size, 0};
+    if(!lz11_stream_open(&stream, memory_read_callback, &reader))
+        return 0;
+
+    u32 produced = 0, read = 0;
+    do
+    {
+        // always the same buffer for the chunks, like lz11_decompress_stream
+        u8 * const dest = read_size < stream.size ? out : out + produced;
+        read = lz11_stream_read(&stream, (char *)dest, read_size);
+        produced += read;
+    } while(read != 0);
+    return stream.error ? 0 : produced;
+}
+
+static u32 decode_whole(const u8 * compressed, u32 compressed_size, u8 * out)
+{
+    return decode_stream(compressed, compressed_size, out, LZ11_MAX_SIZE);
+}
+
+static u32 decode_chunks(const u8 * compressed, u32 compressed_size, u8 * out)
+{
+    return decode_stream(compressed, compressed_size, out, LZ11_STREAM_CHUNK_SIZE);
+}
+
+typedef u32 (*decode_function)(const u8 * compressed, u32 compressed_size, u8 * out);
+
+static double measure(decode_function decode, const u8 * compressed, u32 compressed_size, u8 * out, u32 size, bool * right)
+{
+    u64 runs = 0, us = 0;
+    const u64 start = platform_ticks();
+    do {
+        *right = decode(compressed, compressed_size, out) == size;
+        runs++;
+    } while((us = platform_ticks_to_us(platform_ticks() - start)) < BENCH_MIN_US);
+    return us ? (double)(runs * size) / us : 0;
+}
+
+static void bench(const char * name, const char * level, const u8 * compressed, u32 compressed_size)
+{
+    const u32 size = compressed[1] | (compressed[2] << 8) | (compressed[3] << 16);
+    u8 * out = malloc(size ? size : 1);
+
+    bool reference_right = false, whole_right = false, chunks_right = false;
+    const double reference = measure(decode_reference, compressed, compressed_size, out, size, &reference_right);
+    const double whole = measure(decode_whole, compressed, compressed_size, out, size, &whole_right);
+    const double chunks = measure(decode_chunks, compressed, compressed_size, out, size, &chunks_right);
+
+    printf("%-24s %-2s %9u -> %9u  %9.2f  %9.2f  %9.2f  %5.2fx%s\n", name, level, compressed_size, size,
+           reference, whole, chunks, reference ? whole / reference : 0,
+           reference_right && whole_right && chunks_right ? "" : "  wrong size");
+    free(out);
+}
+
+static char * read_host_file(const char * path, u32 * size)
+{
+    FILE * file = fopen(path, "rb");
+    if(file == NULL)
+        return NULL;
+    fseek(file, 0, SEEK_END);
+    *size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char * data = malloc(*size ? *size : 1);
+    if(fread(data, 1, *size, file) != *size)
+    {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    return data;
+}
+
+static void bench_levels(const char * name, const char * data, u32 size)
+{
+    for(LZ11_Level level = 0; level < LZ11_LEVEL_AMOUNT; level++)
+    {
+        char * compressed = NULL;
+        const u32 compressed_size = lz11_compress(data, size, &compressed, level);
+        if(compressed_size != 0)
+        {
+            char level_name[4];
+            sprintf(level_name, "%d", level);
+            bench(name, level_name, (const u8 *)compressed, compressed_size);
+        }
+        free(compressed);
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    printf("%-24s %-2s %9s    %9s  %9s  %9s  %9s  %6s\n", "data", "L", "lz size", "size", "ref MB/s", "whole MB/s", "chunk MB/s", "gain");
+
+    Sample_s samples[SAMPLES_AMOUNT];
+    samples_make(samples);
+    for(int i = 0; i < SAMPLES_AMOUNT; i++)
+        bench_levels(samples[i].name, samples[i].data, samples[i].size);
+    samples_free(samples);
+
+    for(int i = 1; i < argc; i++)
+    {
+        u32 size = 0;
+        char * data = read_host_file(argv[i], &size);
+        if(data == NULL)
+        {
+            DEBUG("couldn't read %s\n", argv[i]);
+            continue;
+        }
+
+        u8 * decompressed = NULL;
+        if(reference_lz11_decompress((const u8 *)data, size, &decompressed) != 0)
+            bench(argv[i], "-", (const u8 *)data, size);
+        else
+            bench_levels(argv[i], data, size);
+        free(decompressed);
+        free(data);
+    }
+
+    return 0;
+}
@@ -27,9 +27,31 @@
 #ifndef COMMON_H
 #define COMMON_H
 
-#include <3ds.h>
+#include "platform.h"
+
+#ifdef __3DS__
 #include <citro3d.h>
 #include <citro2d.h>
+#else
+// the colors of the config are packed the way citro2d wants them, even where nothing is drawn
+#define C2D_Color32(r, g, b, a) ((u32)(r) | ((u32)(g) << 8) | ((u32)(b) << 16) | ((u32)(a) << 24))
+
+// nothing is drawn either, the lists only keep these around
+typedef struct {
+    u16 width, height;
+    float left, top, right, bottom;
+} Tex3DS_SubTexture;
+
+typedef struct {
+    void * data;
+    u16 width, height;
+} C3D_Tex;
+
+typedef struct {
+    C3D_Tex * tex;
+    const Tex3DS_SubTexture * subtex;
+} C2D_Image;
+#endif
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -31,6 +31,8 @@
 #include "fs.h"
 #include <jansson.h>
 
+#define EXTRA_PATHS_MAX 8
+
 typedef struct {
     u32 accent_color;
     u32 background_color;
@@ -41,6 +43,12 @@ typedef struct {
     u32 red_color_background;
     u32 red_color_accent;
     u32 yellow_color;
+
+    // folders the lists are loaded from, on top of main_paths
+    const char * extra_paths[MODE_AMOUNT][EXTRA_PATHS_MAX];
+    int extra_paths_count[MODE_AMOUNT];
+
+    u32 icon_cache_size; // in KiB
 } Config_s;
 
 extern Config_s config;
@@ -156,18 +156,22 @@ typedef struct {
     const char * instructions[BUTTONS_INFO_LINES][BUTTONS_INFO_COLUNMNS];
 } Instructions_s;
 
+#ifdef __3DS__
 extern C3D_RenderTarget * top;
 extern C3D_RenderTarget * bottom;
 extern C2D_TextBuf staticBuf, dynamicBuf;
 
 extern C2D_Text text[TEXT_AMOUNT];
+#endif
 
 void init_screens(void);
 void exit_screens(void);
 
 void start_frame(void);
 void end_frame(void);
+#ifdef __3DS__
 void set_screen(C3D_RenderTarget * screen);
+#endif
 
 void throw_error(const char * error, ErrorLevel level);
 bool draw_confirm(const char * conf_msg, Entry_List_s * list, DrawMode draw_mode);
@@ -180,7 +184,9 @@ void draw_loading_bar(u32 current, u32 max, InstallType type);
 void draw_text(float x, float y, float z, float scaleX, float scaleY, Color color, const char * text);
 void draw_text_wrap(float x, float y, float z, float scaleX, float scaleY, Color color, const char * text, float max_width);
 void draw_text_wrap_scaled(float x, float y, float z, Color color, const char * text, float max_scale, float min_scale, float max_width);
+#ifdef __3DS__
 void draw_text_center(gfxScreen_t target, float y, float z, float scaleX, float scaleY, Color color, const char * text);
+#endif
 void draw_home(u64 start_time, u64 cur_time);
 
 void draw_base_interface(void);
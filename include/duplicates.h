@@ -0,0 +1,57 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef DUPLICATES_H
+#define DUPLICATES_H
+
+#include "common.h"
+#include "entries_list.h"
+
+// Entries that are copies of each other, by what would get installed from them (body and BGM, or both splashes) instead of by name.
+// Only entries with the same sizes are compared, zips with different CRCs aren't even read, and the rest is hashed.
+// What was found is saved on the SD, so only the entries that changed since are looked at again
+#define DUPLICATES_PAYLOADS 2
+
+typedef struct {
+    Entry_List_s * list;
+    u32 * group_of; // by entry id: 1 + the group of copies the entry is in, 0 for none
+    u32 ids_count; // how many entries the list had when looking, later ones aren't in any group
+    u32 groups_count;
+    volatile bool done;
+} Duplicates_s;
+
+// Thread_Arg_s thread, with a Duplicates_s whose list is set as the argument
+void find_duplicates_thread(void * void_arg);
+void duplicates_free(Duplicates_s * duplicates);
+
+// sets the view of the list to the entries that have a copy. Returns false if there are none
+bool duplicates_show(const Duplicates_s * duplicates, Entry_List_s * list);
+// sets the view of the list to every entry but the copies: in each group, the first one in the list stays
+void duplicates_hide_copies(const Duplicates_s * duplicates, Entry_List_s * list);
+// deletes the copies from the SD, the list has to be loaded again after
+void duplicates_delete_copies(const Duplicates_s * duplicates, Entry_List_s * list);
+
+#endif
@@ -0,0 +1,52 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef ENTRIES_INDEX_H
+#define ENTRIES_INDEX_H
+
+#include "common.h"
+#include "entries_list.h"
+
+// What was parsed from the info.smdh of every entry under one of the roots of a list, saved on the SD between launches.
+// An entry whose path, size and mtime are the same as last time is filled from it instead of being opened
+typedef struct {
+    char * data; // the index file
+    u32 data_size;
+    u32 records_count;
+    u32 * table; // offsets of the records in data, by hash of their path. 0 for empty slots
+    u32 table_size; // power of two
+} Entries_Index_s;
+
+// returns false (with an empty index) if there's no usable index for the folder
+bool entries_index_load(Entries_Index_s * index, const char * loading_path);
+// returns true if the entry's name, description, author and placeholder color were filled from the index
+// the strings are copied to the arena of the entry's list
+bool entries_index_fill(const Entries_Index_s * index, Entry_s * entry, String_Arena_s * strings_arena);
+void entries_index_free(Entries_Index_s * index);
+// one index per root of the list
+void entries_index_save(Entry_List_s * list);
+
+#endif
@@ -28,6 +28,9 @@
 #define ENTRIES_LIST_H
 
 #include "common.h"
+#include "fs.h"
+#include "string_arena.h"
+#include "spsc_queue.h"
 #include <jansson.h>
 
 typedef enum {
@@ -36,35 +39,162 @@ typedef enum {
     SORT_NAME,
     SORT_AUTHOR,
     SORT_PATH,
+
+    SORT_AMOUNT,
 } SortMode;
 
 typedef struct {
-    u16 path[0x106];
+    // the path lives in the arena of the list the entry belongs to, the name, description and author in the one of its page
+    const u16 * path; // relative to folder, through the categories it's in
+    const char * folder; // the root of the list it was found in, "" when path is absolute
     bool is_zip;
     bool in_shuffle;
     bool no_bgm_shuffle;
     bool installed;
     u32 placeholder_color; // doubles as not-info-loaded when == 0
+    u64 file_size; // of the zip, 0 for folders
+    u64 mtime; // of the zip, or of the info.smdh of a folder
+    bool info_pending; // the info.smdh wasn't read yet: the name is the file name, until the info thread or the icon loading gets to it
+    u32 id; // where it is in the pages, which is the order it was found in. All below entries_count
+    bool is_category; // only while loading: a folder of entries, dropped from the list once they're added
 
     json_int_t tp_download_id;
-    u16 name[0x41];
-    u16 desc[0x81];
-    u16 author[0x41];
+    const u16 * name;
+    const u16 * desc;
+    const u16 * author;
 } Entry_s;
 
+// what reading the files of an entry needs, copied out under info_lock so the list can be sorted in the meantime
+typedef struct {
+    const u16 * path;
+    const char * folder;
+    u32 id;
+    bool is_zip;
+} Entry_Ref_s;
+
+static inline Entry_s entry_from_ref(const Entry_Ref_s * ref)
+{
+    return (Entry_s){.path = ref->path, .folder = ref->folder, .is_zip = ref->is_zip, .id = ref->id};
+}
+
 typedef struct {
     Tex3DS_SubTexture subtex;
     u16 x, y;
 } Entry_Icon_s;
 
+// an icon loaded ahead of the scrolling, into one of the slots of icons_info after the ring
+typedef struct {
+    int position; // in the view, -1 if the slot is free
+    int id; // of the entry it was loaded for
+} Icon_Prefetch_Slot_s;
+
+typedef enum {
+    ICON_CELL_EMPTY,
+    ICON_CELL_WANTED, // the job queue was full, it's pushed again next frame
+    ICON_CELL_QUEUED,
+    ICON_CELL_LOADED,
+} IconCellState;
+
+// what the main thread knows of the icon in a slot of icons_info
+typedef struct {
+    u32 id; // of the entry, the icon thread finds it with it
+    volatile u32 job; // bumped whenever the slot is given to another entry: the results of older jobs are dropped
+    IconCellState state;
+} Icon_Cell_s;
+
+// the icon thread takes jobs from the main thread and gives them back loaded, neither waits on the other
+typedef struct {
+    Spsc_Queue_s jobs; // Icon_Job_s, from the main thread
+    Spsc_Queue_s done; // the same, back to the main thread with their icon
+    Platform_Event wake; // jobs were pushed, or the thread has to stop
+    Platform_Event drained; // done was emptied, or the thread has to stop
+} Icon_Loader_s;
+
+// what the icon in a slot of the atlas was made from, see icon_atlas.h
+typedef struct {
+    u32 key; // hash of the folder and path of the entry
+    u32 _padding;
+    u64 file_size;
+    u64 mtime;
+} Icon_Atlas_Record_s;
+
+typedef struct {
+    Platform_File file; // the icons, in the order they were first loaded
+    bool opened;
+    bool dirty; // the records changed since they were saved
+    EntryMode mode;
+    Icon_Atlas_Record_s * records; // by slot
+    u32 slots_count;
+    u32 slots_capacity;
+    s32 * slot_of; // by entry id, -1 if the atlas has no up to date icon for the entry
+    u32 ids_capacity;
+    u32 * free_slots; // of the entries that are gone or changed, reused first
+    u32 free_count;
+    Platform_Mutex lock;
+} Icon_Atlas_s;
+
+// the entries are kept in pages that never move, so the list can grow without reallocating all of them,
+// and an entry can be pointed to while more are added. An entry stays in its page for good, sorting only changes
+// the order of the ids. Past ENTRIES_RESIDENT_PAGES, the pages away from the scrolling are written to a file
+// of fixed-size records and freed, and read back when an entry in them is asked for, see list_trim.
+// Only the entries and their strings are swapped out: the paths, the order, the sort orders and the search index
+// still grow with the list. bench/bench_entries_memory.c measures them, for 100k entries with names like
+// "00000 Pastel Night Theme.zip" that's 11 MB with every sort done, and 28 MB more for the search index
+// (built on the first search of 3 characters or more) of about 90 characters of name, description and author each
+#define ENTRIES_PAGE_SHIFT 8
+#define ENTRIES_PAGE_SIZE (1 << ENTRIES_PAGE_SHIFT)
+#define ENTRIES_RESIDENT_PAGES 32
+
+typedef struct {
+    Entry_s * entries; // NULL while it's only in the swap file
+    String_Arena_s strings; // the names, descriptions and authors of its entries
+    u64 hash; // of its records in the swap file, so they're only written again if they changed
+    u32 last_used; // pages_clock when one of its entries was last asked for
+    u16 records_count; // in the swap file
+    bool in_file; // the swap file has its records
+    bool pinned; // around the scrolling, see list_trim
+    // what's in it while it's swapped out, so going through the entries can skip it
+    bool any_pending;
+    bool any_marked; // installed or in the shuffle
+} Entry_Page_s;
+
 typedef struct {
-    Entry_s * entries;
+    Entry_Page_s * entries; // pages of ENTRIES_PAGE_SIZE entries, by id, see get_entry_at
     int entries_count;
-    int entries_capacity;
+    int entries_capacity; // in the pages allocated
+    int pages_capacity; // pages entries has room for
+    u32 * order; // the ids in the order the list is in, NULL while it's the order they were found in
+    const u16 ** paths; // by id, kept while the pages are swapped out to find an entry again
+
+    int resident_pages;
+    u32 pages_clock; // bumped by list_trim
+    Platform_File swap_file;
+    bool swap_opened;
+    struct Entry_Record_s * records; // a page of them, to go to and from the swap file
+    // held to swap a page in, which any thread can do, or out, which only the main thread does with info_lock held
+    Platform_Mutex pages_lock;
+
+    int * view; // positions in the list of the ones matching the search, in order. NULL when showing everything
+    int view_count;
 
     C3D_Tex icons_texture;
     Entry_Icon_s * icons_info;
+    int icons_head; // the icons around the visible ones are a ring of slots in icons_info, starting at this one
+    Icon_Cell_s * icon_cells; // one per slot of icons_info
+    Icon_Loader_s * icon_loader; // NULL when every icon fits in the texture
+    int icons_wanted; // cells waiting for room in the job queue
+    u32 last_icon_job;
+    bool icons_to_flush; // icons were copied to the texture this frame
 
+    int icons_spare; // slots of icons_info after the ring
+    Icon_Prefetch_Slot_s * prefetch_slots; // icons_spare of them
+    int scroll_direction; // 1 going down, -1 going up
+    float scroll_rate; // entries per second, smoothed
+    u64 last_scroll_tick;
+
+    Icon_Atlas_s icon_atlas;
+
+    // these are positions in the view, see list_get_entry
     int previous_scroll;
     int scroll;
 
@@ -81,26 +211,116 @@ typedef struct {
 
     SortMode current_sort;
 
+    String_Arena_s strings; // the paths of the entries, and the rest of the strings of the remote lists (which never get swapped out)
+    Platform_Mutex info_lock; // held to fill in a pending entry, to sort, and to swap pages out
+    volatile int info_parsed; // pending entries filled in since the list was last sorted
+    volatile bool info_loading; // the info thread is still going through the pending entries
+    u32 info_generation; // bumped whenever entries are filled in, added or removed
+
+    u32 * sort_orders[SORT_AMOUNT]; // ids of the entries in sorted order, to switch back to a sort without doing it again
+    u32 sort_generations[SORT_AMOUNT]; // info_generation when the order was made
+
     json_int_t tp_current_page;
     json_int_t tp_page_count;
     char * tp_search;
-    const char * loading_path;
+    const char * loading_path; // the first root, where downloads go
+    const char * const * roots; // the folders the entries are loaded from, each with its own entries index
+    int roots_count;
 } Entry_List_s;
 
 void sort_by_name(Entry_List_s * list);
 void sort_by_author(Entry_List_s * list);
 void sort_by_filename(Entry_List_s * list);
+// sorts the list again as the info of pending entries comes in, keeping the selected entry where it is on screen
+void resort_list(Entry_List_s * list);
+void free_sort_orders(Entry_List_s * list);
+// adds a zip saved in the folder of the list after it was loaded (or updates it if it was overwritten)
+// where the current sort puts it, reading only its info. Returns its new position in the entries, or -1
+ssize_t list_insert_zip(Entry_List_s * list, const u16 * name, u64 size);
+
+// the entry with an id, read back from the swap file if its page was swapped out. Another thread than the main one
+// has to hold info_lock while it uses it, the main thread can keep it until the next list_trim if it's around the scrolling
+Entry_s * list_read_entry(const Entry_List_s * list, int id);
+static inline Entry_s * get_entry_at(const Entry_List_s * list, int id)
+{
+    Entry_Page_s * const page = &list->entries[id >> ENTRIES_PAGE_SHIFT];
+    Entry_s * const entries = __atomic_load_n(&page->entries, __ATOMIC_ACQUIRE);
+    if(entries == NULL)
+        return list_read_entry(list, id);
+
+    page->last_used = list->pages_clock;
+    return &entries[id & (ENTRIES_PAGE_SIZE - 1)];
+}
+
+// the id of the entry at a position in the whole list
+static inline int list_id_at(const Entry_List_s * list, int position)
+{
+    return list->order != NULL ? (int)list->order[position] : position;
+}
+
+// where the strings parsed for an entry of a local list go, they're swapped out with it
+String_Arena_s * list_entry_strings(Entry_List_s * list, const Entry_s * entry);
+
+// the entries shown, which is all of them unless there's a view
+int list_get_count(const Entry_List_s * list);
+int list_get_id(const Entry_List_s * list, int index);
+Entry_s * list_get_entry(const Entry_List_s * list, int index);
+void list_clear_view(Entry_List_s * list);
+// every entry by id, allocated with malloc. For threads going through all of them
+Entry_Ref_s * list_snapshot(Entry_List_s * list, int * count);
+// if it's still there
+void list_set_installed(Entry_List_s * list, const Entry_Ref_s * ref);
+// after an install: the entry is the only one installed, or with NULL the ones that were in the shuffle are, and it's emptied
+void list_mark_installed(Entry_List_s * list, const Entry_s * installed);
+// copies up to max of the entries in the shuffle to shuffle, returns how many there are
+int list_get_shuffle(Entry_List_s * list, Entry_s * shuffle, int max);
+// the id of the first entry from id on (going around) whose info is pending, -1 if there's none.
+// info_lock has to be held, the swapped out pages are only read back if they have some
+int list_next_pending(Entry_List_s * list, int id);
+
+// goes through the entries without making the list read back the swapped out pages, they're read into the walk instead.
+// info_lock has to be held, unless no other thread uses the list. The entries can't be changed nor kept past the walk,
+// and going by id reads every page only once
+typedef struct {
+    Entry_List_s * list;
+    int page; // the one in entries, -1 for none
+    const Entry_s * entries;
+    Entry_s * buffer;
+    String_Arena_s strings;
+} Entry_Walk_s;
+
+void list_walk_start(Entry_Walk_s * walk, Entry_List_s * list);
+const Entry_s * list_walk_entry(Entry_Walk_s * walk, int id);
+void list_walk_end(Entry_Walk_s * walk);
+
+// on the main thread every frame: the least recently used pages past ENTRIES_RESIDENT_PAGES are swapped out,
+// except the ones with entries around the scrolling (what's on screen, in the icon ring or loaded ahead)
+void list_trim(Entry_List_s * list);
 
+// path has to hold 0x106 characters
+void entry_get_path(const Entry_s * entry, u16 * path);
 void delete_entry(Entry_s * entry, bool is_file);
 // assumes list has been memset to 0
 typedef enum InstallType_e InstallType;
-Result load_entries(const char * loading_path, Entry_List_s * list, const InstallType loading_screen);
+// the entries are the folders and zips in the roots, and in the categories (folders of only folders and zips) under them
+Result load_entries(const char * const * roots, int roots_count, Entry_List_s * list, const InstallType loading_screen);
 u32 load_data(const char * filename, const Entry_s * entry, char ** buf);
+// same as load_data, but the buffer comes from the pool and has to be given back with pool_free
+u32 load_pooled_data(const char * filename, const Entry_s * entry, char ** buf);
+bool open_data_stream(const char * filename, const Entry_s * entry, Data_Stream_s * stream);
+// loads several files of an entry at once (one pass for zips), returning how many were found
+u32 load_data_multi(const char ** filenames, const Entry_s * entry, char ** bufs, u32 * sizes, int count);
+// slot in icons_info of the index-th icon kept, going down from the first one above the screen
+int get_icon_slot(const Entry_List_s * list, int index);
 C2D_Image get_icon_at(Entry_List_s * list, size_t index);
+// false while the icon for the entry at index is still being loaded, what's in the texture is someone else's
+bool icon_ready_at(const Entry_List_s * list, size_t index);
 
-// assumes list doesn't have any elements yet
+// assumes list doesn't have any elements yet. Only makes room for the pages, they're allocated as entries get added
 void list_init_capacity(Entry_List_s * list, const int init_capacity);
-// assumes list has been inited with a non zero capacity
+// assumes list has been inited
 ssize_t list_add_entry(Entry_List_s * list);
+// deletes the swap file too
+void list_free_entries(Entry_List_s * list);
 
 #endif
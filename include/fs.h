@@ -30,14 +30,11 @@
 #include "common.h"
 #include "badges.h"
 #include "config.h"
+#include "lz.h"
+#include "zip.h"
 
 #define ILLEGAL_CHARS "><\"?;:/\\+,.|[=]*\n\r"
 
-extern FS_Archive ArchiveSD;
-extern FS_Archive ArchiveHomeExt;
-extern FS_Archive ArchiveThemeExt;
-extern FS_Archive ArchiveBadgeExt;
-
 typedef struct {
     u32 enable : 1;
     u32 browser: 1;
@@ -55,22 +52,80 @@ typedef struct {
     u32 coppa : 1;
 } Parental_Restrictions_s;
 
+typedef enum {
+    DATA_STREAM_FILE,
+    DATA_STREAM_ZIP_INDEX,
+    DATA_STREAM_ZIP_ARCHIVE,
+} Data_Stream_Type;
+
+// Reads a loose file or a file in a zip a chunk at a time, instead of all at once
+typedef struct {
+    Data_Stream_Type type;
+    u32 size;
+    u32 position;
+
+    Platform_File handle;
+    Zip_Member_Reader_s zip_member;
+    struct archive * archive;
+    // libarchive can't go back, the zip is opened again to rewind
+    u16 zip_path[0x106];
+    char file_name[0x40];
+} Data_Stream_s;
+
+// Bytes that went through file_to_buf, the data streams and the write functions, to measure how much I/O the installs do
+typedef struct {
+    u64 read;
+    u64 written;
+    u64 zeroed; // written by zero_fill_handle, not counted in written
+} IO_Stats_s;
+
+// The zips save_zip_to_sd wrote since they were last taken, so they can be added to their list instead of loading every list again
+#define SAVED_ZIPS_MAX 16
+typedef struct {
+    RemoteMode mode;
+    u16 name[0x106]; // in main_paths[mode]
+    u32 size;
+} Saved_Zip_s;
+
 Result init_sd(void);
 Result open_archives(void);
 Result open_badge_extdata(void);
 Result close_archives(void);
 Result load_parental_controls(Parental_Restrictions_s *restrictions);
 
-u32 file_to_buf(FS_Path path, FS_Archive archive, char ** buf);
+u32 file_to_buf(const u16 * path, PlatformArchive archive, char ** buf);
 u32 zip_memory_to_buf(const char * file_name, void * zip_memory, size_t zip_size, char ** buf);
 u32 zip_file_to_buf(const char * file_name, const u16 * zip_path, char ** buf);
-u32 decompress_lz_file(FS_Path file_name, FS_Archive archive, char ** buf);
-u32 compress_lz_file_fast(FS_Path path, FS_Archive archive, char * in_buf, u32 size);
+// read several files in one pass over the zip, returning how many were found
+u32 zip_memory_to_bufs(const char ** file_names, void * zip_memory, size_t zip_size, char ** bufs, u32 * sizes, int count);
+u32 zip_file_to_bufs(const char ** file_names, const u16 * zip_path, char ** bufs, u32 * sizes, int count);
+u32 decompress_lz_file(const u16 * file_name, PlatformArchive archive, char ** buf);
+u32 compress_lz_file(const u16 * path, PlatformArchive archive, char * in_buf, u32 size, LZ11_Level level);
+u32 patch_lz_file(const u16 * path, PlatformArchive archive, u32 compressed_size, u32 offset, const char * patch, u32 patch_size);
+
+// open functions return false if the file can't be found or read
+bool stream_open_file(Data_Stream_s * stream, const u16 * path, PlatformArchive archive);
+bool stream_open_zip(Data_Stream_s * stream, const char * file_name, const u16 * zip_path);
+// returns the amount of bytes put in buf, less than size only at the end of the file or on error
+u32 stream_read(Data_Stream_s * stream, char * buf, u32 size);
+bool stream_rewind(Data_Stream_s * stream);
+void stream_close(Data_Stream_s * stream);
 
-Result buf_to_file(u32 size, FS_Path path, FS_Archive archive, char * buf);
-Result zero_handle_memeasy(Handle handle);
-void remake_file(FS_Path path, FS_Archive archive, u32 size);
+Result buf_to_file(u32 size, const u16 * path, PlatformArchive archive, char * buf);
+// Replaces the file at path with one of file_size bytes, the first size of them from buf and the rest zeroes:
+// every byte is written once. buf can be NULL for a file of only zeroes
+Result write_file(const u16 * path, PlatformArchive archive, const char * buf, u32 size, u32 file_size);
+// Replaces the file at path with one of size bytes without writing to it,
+// for callers that write every byte themselves (zero_fill_handle can fill the gaps)
+Result create_file(const u16 * path, PlatformArchive archive, u32 size);
+Result write_handle(Platform_File handle, u64 offset, const char * buf, u32 size);
+// zeroes the bytes of the file from offset to end
+Result zero_fill_handle(Platform_File handle, u64 offset, u64 end);
+Result zero_handle_memeasy(Platform_File handle);
+void get_io_stats(IO_Stats_s * stats);
 void save_zip_to_sd(char * filename, u32 size, char * buf, RemoteMode mode);
+// returns how many zips were saved, or -1 if there were too many to keep track of. Either way, they aren't kept after
+int take_saved_zips(Saved_Zip_s * zips);
 s16 for_each_file_zip(u16 *zip_path, u32 (*zip_iter_callback)(char *filebuf, u64 file_size, const char *name, void *userdata), void *userdata);
 
 #endif
@@ -0,0 +1,50 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef ICON_ATLAS_H
+#define ICON_ATLAS_H
+
+#include "common.h"
+#include "entries_list.h"
+
+// The big icons of a list's entries, saved on the SD between launches as they are in the smdh (already tiled for the texture).
+// The icons file only ever has icons one after the other, and a small records file says which entry, by size and mtime, each slot is for.
+// Entries that are new or changed get a slot the first time their smdh is read
+#define ICON_ATLAS_ICON_SIZE (48 * 48 * sizeof(u16))
+
+// matches the entries of the list to the slots from last time
+void icon_atlas_open(Icon_Atlas_s * atlas, Entry_List_s * list);
+// saves the records if they changed
+void icon_atlas_close(Icon_Atlas_s * atlas);
+
+// reads the icons of entries, from the first one for as long as they are in consecutive slots, with one read.
+// Returns how many were read to icons
+int icon_atlas_read_run(Icon_Atlas_s * atlas, Entry_s * const * entries, int count, u16 * icons);
+void icon_atlas_store(Icon_Atlas_s * atlas, const Entry_s * entry, const u16 * big_icon);
+// for an entry whose icon changed
+void icon_atlas_forget(Icon_Atlas_s * atlas, const Entry_s * entry);
+
+#endif
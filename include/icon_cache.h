@@ -0,0 +1,59 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef ICON_CACHE_H
+#define ICON_CACHE_H
+
+#include "common.h"
+#include "entries_list.h"
+
+// The big icons of the entries that left the texture, as they are in the smdh (already tiled), least recently used ones dropped first
+// They are found by the path of the entry, since sorting moves the entries themselves around
+#define ICON_CACHE_BLOCK_SIZE (48 * 48 * sizeof(u16))
+// in KiB, "Icon Cache Size" in the config, 0 to disable
+#define ICON_CACHE_DEFAULT_SIZE 512
+
+typedef struct {
+    u32 capacity; // icons that fit in the budget
+    u32 used;
+    u32 hits;
+    u32 misses;
+    u32 evictions;
+} Icon_Cache_Stats_s;
+
+void icon_cache_init(u32 budget_kib);
+void icon_cache_exit(void);
+// the entries are about to be freed, the address of their paths could come back for others
+void icon_cache_clear(void);
+
+// copies the cached icon of entry to the texture, false if it wasn't there
+bool icon_cache_copy(const Entry_s * entry, C3D_Tex * texture, const Entry_Icon_s * icon);
+void icon_cache_add(const Entry_s * entry, const u16 * big_icon);
+// for an entry whose icon changed
+void icon_cache_forget(const Entry_s * entry);
+void icon_cache_get_stats(Icon_Cache_Stats_s * stats);
+
+#endif
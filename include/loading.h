@@ -46,6 +46,9 @@ enum ICON_IDS_OFFSET {
     ICONS_OFFSET_AMOUNT,
 };
 
+// pages of icons the texture has room for on top of the ring, to load ahead of the scrolling
+#define ICONS_PREFETCH_PAGES 4
+
 typedef struct {
     u8 _padding1[4 + 2 + 2];
 
@@ -64,17 +67,42 @@ typedef struct {
     volatile bool run_thread;
 } Thread_Arg_s;
 
+typedef struct {
+    Entry_List_s * list;
+    u32 id; // see Icon_Cell_s
+    u32 job;
+    int slot; // in icons_info
+    u16 * icon; // set by the icon thread, from the pool. NULL if the entry has none
+} Icon_Job_s;
+
 void copy_texture_data(C3D_Tex * texture, const u16 * src, const Entry_Icon_s * current_icon);
-void parse_smdh(Icon_s * icon, Entry_s * entry, const u16 * fallback_name);
+// once the icons of a batch were copied, so the GPU sees them
+void flush_texture_data(C3D_Tex * texture);
+// the strings of the icon are copied to the arena, fallback_name has to outlive the entry
+void parse_smdh(Icon_s * icon, Entry_s * entry, const u16 * fallback_name, String_Arena_s * strings);
 
 
 bool load_preview_from_buffer(char * row_pointers, u32 size, C2D_Image * preview_image, int * preview_offset, int height);
 bool load_preview(const Entry_List_s * list, C2D_Image * preview_image, int * preview_offset);
 void free_preview(C2D_Image preview_image);
 Result load_audio(const Entry_s *, audio_s *);
+#ifdef __3DS__
 Result load_audio_ogg(const Entry_s * entry, audio_ogg_s * audio);
+#endif
+// with silent, a list that has an icon loader gets its icons from the icon thread instead
 void load_icons_first(Entry_List_s * current_list, bool silent);
 void handle_scrolling(Entry_List_s * list);
+
+bool icon_loader_init(Icon_Loader_s * loader);
+// once the icon thread is stopped, drops the jobs that are left
+void icon_loader_clear(Icon_Loader_s * loader);
+void icon_loader_free(Icon_Loader_s * loader);
+// on the main thread every frame, neither waits for the icon thread:
+// puts the icons that were loaded in their texture, then gives out jobs for the ones that scrolled in
+void finish_icon_jobs(Icon_Loader_s * loader);
+void update_icons(Entry_List_s * list);
+// the thread_arg is the Icon_Loader_s
 void load_icons_thread(void * void_arg);
+void load_info_thread(void * void_arg);
 
 #endif
@@ -0,0 +1,100 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef LZ_H
+#define LZ_H
+
+#include "common.h"
+
+#define LZ11_MAGIC 0x11
+#define LZ11_HEADER_SIZE 4
+#define LZ11_MAX_SIZE 0xFFFFFF // the 24 bit header is the only one the home menu uses
+
+#define LZ11_WINDOW_SIZE 0x1000
+#define LZ11_MIN_MATCH 3
+#define LZ11_MAX_MATCH 0x10110
+
+typedef enum {
+    LZ11_LEVEL_FAST, // greedy parsing, short hash chains
+    LZ11_LEVEL_LAZY, // one step lazy matching, medium hash chains
+    LZ11_LEVEL_MAX, // lazy matching over the whole window
+
+    LZ11_LEVEL_AMOUNT,
+} LZ11_Level;
+
+#define LZ11_STREAM_CHUNK_SIZE 0x1000
+
+// returns the amount of bytes put in buf, 0 once the input is exhausted
+typedef u32 (*lz11_read_callback)(void * userdata, char * buf, u32 size);
+// returns false to stop decompressing early
+typedef bool (*lz11_write_callback)(void * userdata, const char * buf, u32 size);
+
+// Incremental decoder: memory use is the window and one input chunk,
+// no matter the size of the compressed or decompressed data
+typedef struct {
+    lz11_read_callback read;
+    void * userdata;
+
+    u8 in[LZ11_STREAM_CHUNK_SIZE];
+    u32 in_pos;
+    u32 in_len;
+    bool in_eof; // the read callback has nothing left
+
+    u8 history[LZ11_WINDOW_SIZE]; // end of the output of the previous reads, back-references within one read use its buffer
+    u32 size; // decompressed size, from the header
+    u32 written; // decompressed bytes produced so far
+
+    u8 flags; // flag byte of the current token group, shifted as tokens are read
+    u8 flags_left; // tokens left in the current group
+    u32 match_len; // bytes of the current back-reference not yet produced
+    u32 match_disp;
+
+    bool error;
+} LZ11_Stream_s;
+
+// returns the size of the compressed data allocated into *out_buf, 0 on failure
+u32 lz11_compress(const char * in_buf, u32 size, char ** out_buf, LZ11_Level level);
+
+// How much of the compressed data lz11_patch needs to patch bytes up to patch_end:
+// every token starting less than a window after them, and the rest of that flag group
+#define LZ11_PATCH_INPUT_SIZE(patch_end) (LZ11_HEADER_SIZE + ((patch_end) + LZ11_WINDOW_SIZE) * 9 / 8 + 0x40)
+
+// Replaces patch_size bytes at offset in the decompressed data of in_buf, without decompressing or compressing all of it.
+// in_buf only needs to hold the start of the compressed data (see LZ11_PATCH_INPUT_SIZE).
+// On success, the first *replaced bytes of the compressed data are to be replaced by the *out_size bytes allocated into *out_buf;
+// both sizes are 0 if the data already contains the patch
+bool lz11_patch(const char * in_buf, u32 in_size, u32 offset, const char * patch, u32 patch_size, char ** out_buf, u32 * out_size, u32 * replaced);
+
+// reads the header, returns false if the input isn't LZ11 data
+bool lz11_stream_open(LZ11_Stream_s * stream, lz11_read_callback read_callback, void * userdata);
+// decompresses up to size bytes into buf, returns the amount produced.
+// 0 means the end of the data was reached, or stream->error is set if it was corrupt
+u32 lz11_stream_read(LZ11_Stream_s * stream, char * buf, u32 size);
+// decompresses everything, handing it to write_callback in chunks.
+// returns the amount of bytes handed over, 0 on error
+u32 lz11_decompress_stream(lz11_read_callback read_callback, void * read_userdata, lz11_write_callback write_callback, void * write_userdata);
+
+#endif
@@ -31,8 +31,17 @@
 #include "fs.h"
 #include "unicode.h"
 
+#ifdef __3DS__
 #include <tremor/ivorbisfile.h>
 #include <tremor/ivorbiscodec.h>
+#else
+// only the BCSTM parsing is built on a computer, it reads the ADPCM state with the layout of ndsp
+typedef struct {
+    u16 index;
+    s16 history0;
+    s16 history1;
+} ndspAdpcmData;
+#endif
 
 #define BUFFER_COUNT 8
 #define BUF_TO_READ 48000 // How much data should be buffered at a time for ogg
@@ -57,32 +66,44 @@ typedef struct {
     u32 last_block_size;
     u32 current_block;
     unsigned short adpcm_coefs[2][16];
+#ifdef __3DS__
     ndspWaveBuf wave_buf[2][BUFFER_COUNT];
+#endif
     ndspAdpcmData adpcm_data[2][2];
     unsigned short channel[2];
     unsigned int active_channels;
     u8 *buffer_data[2][BUFFER_COUNT];
     volatile bool stop;
+#ifdef __3DS__
     Thread playing_thread;
+#endif
 } audio_s;
 
+#ifdef __3DS__
 typedef struct {
     OggVorbis_File vf;
     ndspWaveBuf wave_buf[2];
     float mix[12];
     u8 buf_pos;
     long data_read;
-    char * filebuf;
-    u32 filesize;
+    Data_Stream_s stream;
     
     volatile bool stop;
     Thread playing_thread;
 } audio_ogg_s;
 
+#endif
+
+// reads the header of the BCSTM in music_buf, freeing it if the file can't be played
+int init_audio(audio_s *);
+
+#ifdef __3DS__
 void play_audio(audio_s *);
 void stop_audio(audio_s **);
 
+int ogg_open_stream(audio_ogg_s *);
 void play_audio_ogg(audio_ogg_s *);
 void stop_audio_ogg(audio_ogg_s **);
+#endif
 
 #endif
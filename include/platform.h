@@ -0,0 +1,196 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+// The system services the core modules need, so they can also be built and profiled on a computer.
+// Built with libctru on the console (platform_ctr.c), and with POSIX everywhere else (platform_posix.c),
+// where the archives are directories under $PLATFORM_ROOT (./sdmc by default)
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __3DS__
+#include <3ds.h>
+
+typedef Handle Platform_File;
+typedef Handle Platform_Dir;
+typedef LightLock Platform_Mutex;
+typedef LightEvent Platform_Event;
+typedef Thread Platform_Thread;
+#else
+#include <pthread.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef int64_t s64;
+typedef s32 Result;
+
+#define R_SUCCEEDED(res) ((res) >= 0)
+#define R_FAILED(res) ((res) < 0)
+
+#define BIT(n) (1U << (n))
+
+// the results the modules make themselves keep the libctru layout, so every failure is still negative
+#define MAKERESULT(level, summary, module, description) \
+    ((Result)((((u32)(level) & 0x1F) << 27) | (((u32)(summary) & 0x3F) << 21) | (((u32)(module) & 0xFF) << 10) | ((u32)(description) & 0x3FF)))
+
+enum {
+    RL_SUCCESS = 0,
+    RL_FATAL = 0x1F,
+    RL_USAGE = 0x1C,
+    RL_PERMANENT = 0x1B,
+};
+
+enum {
+    RS_SUCCESS = 0,
+    RS_NOTFOUND = 4,
+    RS_INVALIDARG = 7,
+    RS_CANCELED = 9,
+};
+
+enum {
+    RM_COMMON = 0,
+    RM_UTIL = 59,
+    RM_APPLICATION = 254,
+};
+
+enum {
+    RD_SUCCESS = 0,
+    RD_CANCEL_REQUESTED = 0x3FB,
+    RD_NOT_FOUND = 0x3FA,
+    RD_NO_DATA = 0x3EF,
+    RD_TOO_LARGE = 0x3E9,
+    RD_INVALID_SELECTION = 0x3E8,
+};
+
+typedef int Platform_File;
+typedef struct Platform_Dir_s * Platform_Dir;
+typedef pthread_mutex_t Platform_Mutex;
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool signaled;
+    bool sticky;
+} Platform_Event;
+typedef struct Platform_Thread_s * Platform_Thread;
+#endif
+
+typedef enum {
+    PLATFORM_ARCHIVE_SD,
+    PLATFORM_ARCHIVE_HOME_EXT,
+    PLATFORM_ARCHIVE_THEME_EXT,
+    PLATFORM_ARCHIVE_BADGE_EXT,
+
+    PLATFORM_ARCHIVES_AMOUNT,
+} PlatformArchive;
+
+#define PLATFORM_OPEN_READ  (1 << 0)
+#define PLATFORM_OPEN_WRITE (1 << 1)
+
+typedef struct {
+    u16 name[0x106];
+    char short_ext[4]; // upper case, like the one of the 8.3 name on the console
+    bool is_directory;
+    bool is_hidden;
+    u64 size;
+} Platform_Dir_Entry_s;
+
+// Paths are UTF-16, like the paths of the entries.
+// Results are the libctru ones on the console; on a computer they are -errno, check them with R_FAILED/R_SUCCEEDED and platform_not_found
+bool platform_not_found(Result res);
+
+// The SD archive has to be opened before anything else. extdata_id is only used on the console, for the extdata archives
+Result platform_archive_open(PlatformArchive archive, u32 extdata_id);
+// makes the extdata of an archive that isn't there yet
+Result platform_archive_create(PlatformArchive archive, u32 extdata_id);
+Result platform_archive_close(PlatformArchive archive);
+
+Result platform_file_open(Platform_File * file, PlatformArchive archive, const u16 * path, u32 flags);
+// read/written can be NULL
+Result platform_file_read(Platform_File file, u64 offset, void * buf, u32 size, u32 * read);
+Result platform_file_write(Platform_File file, u64 offset, const void * buf, u32 size, u32 * written);
+Result platform_file_get_size(Platform_File file, u64 * size);
+Result platform_file_flush(Platform_File file);
+void platform_file_close(Platform_File file);
+Result platform_file_create(PlatformArchive archive, const u16 * path, u64 size);
+Result platform_file_delete(PlatformArchive archive, const u16 * path);
+// last modification time of a file or folder, only for the SD
+Result platform_file_get_mtime(PlatformArchive archive, const u16 * path, u64 * mtime);
+
+Result platform_dir_open(Platform_Dir * dir, PlatformArchive archive, const u16 * path);
+// reads up to count entries, read is 0 once every entry was read
+Result platform_dir_read(Platform_Dir dir, Platform_Dir_Entry_s * entries, u32 count, u32 * read);
+void platform_dir_close(Platform_Dir dir);
+Result platform_dir_create(PlatformArchive archive, const u16 * path);
+// with everything in it
+Result platform_dir_delete(PlatformArchive archive, const u16 * path);
+
+// priority and core only matter on the console. Returns NULL on failure
+Platform_Thread platform_thread_create(void (*entry)(void *), void * arg, size_t stack_size, int priority, int core);
+// waits for the thread to end, then frees it
+void platform_thread_join(Platform_Thread thread);
+// how many threads of the application can run at the same time,
+// and the core to create the nth of them on
+int platform_core_count(void);
+int platform_core_id(int n);
+
+void platform_mutex_init(Platform_Mutex * mutex);
+void platform_mutex_lock(Platform_Mutex * mutex);
+void platform_mutex_unlock(Platform_Mutex * mutex);
+
+// a sticky event stays signaled until cleared, otherwise one wait clears it
+void platform_event_init(Platform_Event * event, bool sticky);
+void platform_event_signal(Platform_Event * event);
+void platform_event_wait(Platform_Event * event);
+void platform_event_clear(Platform_Event * event);
+
+u64 platform_ticks(void);
+u64 platform_ticks_to_us(u64 ticks);
+
+#define SHA256_HASH_SIZE 32
+
+void platform_sha256(const void * data, size_t size, u8 hash[SHA256_HASH_SIZE]);
+
+// for data read in pieces, hashed in software on the console too
+typedef struct {
+    u32 state[8];
+    u8 block[64];
+    u64 size;
+} Platform_Sha256_s;
+
+void platform_sha256_init(Platform_Sha256_s * context);
+void platform_sha256_update(Platform_Sha256_s * context, const void * data, size_t size);
+void platform_sha256_final(Platform_Sha256_s * context, u8 hash[SHA256_HASH_SIZE]);
+
+#endif
@@ -0,0 +1,57 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef POOL_H
+#define POOL_H
+
+#include "common.h"
+
+// Buffers are handed out from power of two size classes, from POOL_MIN_SIZE to POOL_MAX_SIZE.
+// Bigger ones go straight to the heap
+#define POOL_MIN_SIZE 0x400
+#define POOL_MAX_SIZE 0x40000
+#define POOL_CLASSES_COUNT 9
+// freed buffers kept around per class, the rest goes back to the heap
+#define POOL_KEEP_PER_CLASS 4
+
+typedef struct {
+    u32 in_use; // bytes handed out and not released yet
+    u32 high_water; // highest in_use reached
+    u32 cached; // bytes kept for reuse
+    u32 allocations;
+    u32 reuses; // allocations served without going to the heap
+} Pool_Stats_s;
+
+void pool_init(void);
+void pool_exit(void);
+
+// The contents of the buffer are NOT zeroed. Returns NULL if out of memory
+void * pool_alloc(u32 size);
+// Only for buffers from pool_alloc, NULL is fine
+void pool_free(void * buf);
+void pool_get_stats(Pool_Stats_s * stats);
+
+#endif
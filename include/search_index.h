@@ -0,0 +1,49 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+
+#include "common.h"
+#include "entries_list.h"
+
+// Trigrams of the case folded name, author and description of the entries of a list, pointing to the ids of the entries that have them.
+// A search only has to check the entries that have every trigram of the query, instead of going through the whole list
+#define SEARCH_INDEX_BUCKETS 0x1000 // trigrams are hashed into these, a few false positives are weeded out when checking
+
+typedef struct {
+    u32 * starts; // SEARCH_INDEX_BUCKETS + 1 offsets in ids
+    u32 * ids; // for every bucket, the ids of the entries with a trigram in it, ascending
+    u32 generation; // info_generation of the list when it was built
+} Search_Index_s;
+
+bool search_index_build(Search_Index_s * index, Entry_List_s * list);
+void search_index_free(Search_Index_s * index);
+// sets the view of the list to the entries matching query (UTF-8), or removes it if query is empty.
+// Returns how many entries matched, the view is left as it was if none did
+int search_index_filter(Search_Index_s * index, Entry_List_s * list, const char * query);
+
+#endif
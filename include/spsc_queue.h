@@ -0,0 +1,51 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include "common.h"
+
+// A ring of fixed size items that one thread pushes to and another pops from, without either of them ever waiting on the other.
+// The capacity is rounded up to a power of two
+typedef struct {
+    u8 * items;
+    u32 item_size;
+    u32 mask;
+    u32 head; // next to pop, only moved by the consumer
+    u32 tail; // next to push, only moved by the producer
+} Spsc_Queue_s;
+
+bool spsc_queue_init(Spsc_Queue_s * queue, u32 capacity, u32 item_size);
+// only once neither thread uses it anymore
+void spsc_queue_free(Spsc_Queue_s * queue);
+
+// false if the queue is full
+bool spsc_queue_push(Spsc_Queue_s * queue, const void * item);
+// false if the queue is empty
+bool spsc_queue_pop(Spsc_Queue_s * queue, void * item);
+
+#endif
@@ -0,0 +1,52 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef STRING_ARENA_H
+#define STRING_ARENA_H
+
+#include "common.h"
+
+// UTF-16 strings that live as long as the list they belong to, packed in big chunks instead of fixed-size arrays.
+// A chunk is never moved nor freed before the whole arena is, so the strings can be pointed to directly
+#define STRING_ARENA_CHUNK_SIZE 0x4000 // in u16
+
+typedef struct String_Arena_Chunk_s {
+    struct String_Arena_Chunk_s * next;
+    u32 size; // in u16
+    u16 data[];
+} String_Arena_Chunk_s;
+
+typedef struct {
+    String_Arena_Chunk_s * chunks; // the one being filled first
+    u32 used; // in the first chunk
+} String_Arena_s;
+
+// copies len characters of str and a terminator, returns an empty string if out of memory
+const u16 * arena_add(String_Arena_s * arena, const u16 * str, size_t len);
+const u16 * arena_add_utf8(String_Arena_s * arena, const char * str);
+void arena_free(String_Arena_s * arena);
+
+#endif
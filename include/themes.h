@@ -74,7 +74,7 @@ Result theme_install(Entry_s * theme);
 Result no_bgm_install(Entry_s * theme);
 Result bgm_install(Entry_s * theme);
 
-Result shuffle_install(const Entry_List_s * themes);
+Result shuffle_install(Entry_List_s * themes);
 
 Result dump_current_theme(void);
 Result dump_all_themes(void);
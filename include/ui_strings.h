@@ -115,6 +115,13 @@ typedef struct {
     const char *not_enough_themes;
     const char *uninstall_confirm;
     const char *delete_confirm;
+    const char *search_q;
+    const char *search;
+    const char *no_matches;
+    const char *duplicates_busy;
+    const char *no_duplicates;
+    const char *delete_duplicates_confirm;
+    const char *hide_duplicates_confirm;
 } Main_Strings_s;
 
 typedef struct {
@@ -184,6 +191,24 @@ typedef struct {
     Badge_Strings_s badges;
 } Language_s;
 
+#ifndef __3DS__
+// the languages of the console settings, the strings can be picked the same way elsewhere
+typedef enum {
+    CFG_LANGUAGE_JP = 0,
+    CFG_LANGUAGE_EN = 1,
+    CFG_LANGUAGE_FR = 2,
+    CFG_LANGUAGE_DE = 3,
+    CFG_LANGUAGE_IT = 4,
+    CFG_LANGUAGE_ES = 5,
+    CFG_LANGUAGE_ZH = 6,
+    CFG_LANGUAGE_KO = 7,
+    CFG_LANGUAGE_NL = 8,
+    CFG_LANGUAGE_PT = 9,
+    CFG_LANGUAGE_RU = 10,
+    CFG_LANGUAGE_TW = 11,
+} CFG_Language;
+#endif
+
 typedef enum {
     LANGUAGE_EN,
 
@@ -34,5 +34,15 @@ size_t strulen(const u16 *, ssize_t);
 void struacat(u16 * input, const char * addition);
 void printu(u16 * input);
 size_t strucat(u16 * destination, const u16 * source);
+// lowercase for ASCII and Latin-1, fullwidth forms become their ASCII counterpart
+u16 fold_case(u16 c);
+
+#ifndef __3DS__
+// the libctru conversions: nothing is written past len units, no terminator is added,
+// and the returned length is the one of the whole string, or -1 if it isn't valid
+ssize_t utf8_to_utf16(u16 * out, const u8 * in, size_t len);
+ssize_t utf16_to_utf8(u8 * out, const u16 * in, size_t len);
+ssize_t utf16_to_utf32(u32 * out, const u16 * in, size_t len);
+#endif
 
 #endif
\ No newline at end of file
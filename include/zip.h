@@ -0,0 +1,86 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef ZIP_H
+#define ZIP_H
+
+#include "common.h"
+
+#define ZIP_INDEX_CACHE_SIZE 32
+
+// One file of a zip, from its central directory
+typedef struct {
+    u32 name_offset; // in the names of the index
+    u32 local_header_offset;
+    u32 compressed_size;
+    u32 size;
+    u32 crc;
+    u16 method;
+    u16 flags;
+} Zip_Member_s;
+
+// Reads one member a chunk at a time, inflating it if needed
+typedef struct {
+    Platform_File file;
+    Zip_Member_s member; // size is 0 if the member wasn't found
+    u64 data_offset;
+    u64 offset; // of the next compressed byte
+    u32 compressed_left;
+    u32 produced;
+    u32 crc; // of what was produced so far, checked once everything is
+    struct z_stream_s * inflate; // NULL for stored members
+    u8 * chunk;
+    bool error;
+} Zip_Member_Reader_s;
+
+typedef struct {
+    u16 path[0x106];
+    u64 zip_size; // a zip with a different size was replaced, and its index is rebuilt
+    u32 last_used;
+    u32 members_count;
+    Zip_Member_s * members;
+    char * names;
+} Zip_Index_s;
+
+void zip_index_init(void);
+void zip_index_exit(void);
+// drops the cached index of a zip that was written to or deleted
+void zip_index_forget(const u16 * zip_path);
+
+// Reads the files of file_names from the zip at zip_path on the SD, seeking straight to them with the cached central directory.
+// Returns false if the index can't be used for them (zip64, encryption, unknown method, ...) and libarchive should be used instead,
+// otherwise true with sizes[i] 0 for the files the zip doesn't have. bufs can be NULL to only get the sizes
+bool zip_index_read(const u16 * zip_path, const char ** file_names, char ** bufs, u32 * sizes, int count);
+
+// Same as zip_index_read, but for reading the file in chunks: reader->member.size is 0 if it isn't there.
+// A reader that was opened has to be closed, even if the file wasn't found
+bool zip_index_open(Zip_Member_Reader_s * reader, const u16 * zip_path, const char * file_name);
+void zip_index_close(Zip_Member_Reader_s * reader);
+// returns the amount of bytes put in buf, 0 at the end of the file or on error (reader->error)
+u32 zip_member_read(Zip_Member_Reader_s * reader, char * buf, u32 size);
+bool zip_member_rewind(Zip_Member_Reader_s * reader);
+
+#endif
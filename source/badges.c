@@ -32,7 +32,7 @@
 #include "draw.h"
 #include "ui_strings.h"
 
-Handle badgeDataHandle;
+Platform_File badgeDataHandle;
 char *badgeMngBuffer;
 u16 *rgb_buf_64x64;
 u16 *rgb_buf_32x32;
@@ -87,12 +87,12 @@ int install_badge_generic(char *file_buf, u64 file_size, u16 *name, int *badge_c
         remove_exten(name);
         for (int j = 0; j < 16; ++j) // Copy name for all 16 languages
         {
-            FSFILE_Write(badgeDataHandle, NULL, 0x35E80 + *badge_count * 16 * 0x8A + j * 0x8A, name, 0x8A, 0);
+            platform_file_write(badgeDataHandle, 0x35E80 + *badge_count * 16 * 0x8A + j * 0x8A, name, 0x8A, NULL);
         }
-        FSFILE_Write(badgeDataHandle, NULL, 0x318F80 + *badge_count * 0x2800, rgb_buf_64x64 + badge * 64 * 64, 64 * 64 * 2, 0);
-        FSFILE_Write(badgeDataHandle, NULL, 0x31AF80 + *badge_count * 0x2800, alpha_buf_64x64 + badge * 64 * 64/2, 64 * 64/2, 0);
-        FSFILE_Write(badgeDataHandle, NULL, 0xCDCF80 + *badge_count * 0xA00, rgb_buf_32x32 + badge * 32 * 32, 32 * 32 * 2, 0);
-        FSFILE_Write(badgeDataHandle, NULL, 0xCDD780 + *badge_count * 0xA00, alpha_buf_32x32 + badge * 32 * 32/2, 32 * 32/2, 0);
+        platform_file_write(badgeDataHandle, 0x318F80 + *badge_count * 0x2800, rgb_buf_64x64 + badge * 64 * 64, 64 * 64 * 2, NULL);
+        platform_file_write(badgeDataHandle, 0x31AF80 + *badge_count * 0x2800, alpha_buf_64x64 + badge * 64 * 64/2, 64 * 64/2, NULL);
+        platform_file_write(badgeDataHandle, 0xCDCF80 + *badge_count * 0xA00, rgb_buf_32x32 + badge * 32 * 32, 32 * 32 * 2, NULL);
+        platform_file_write(badgeDataHandle, 0xCDD780 + *badge_count * 0xA00, alpha_buf_32x32 + badge * 32 * 32/2, 32 * 32/2, NULL);
 
         int badge_id = *badge_count + 1;
         memcpy(badgeMngBuffer + 0x3E8 + *badge_count * 0x28 + 0x4, &badge_id, 4);
@@ -113,17 +113,17 @@ int install_badge_generic(char *file_buf, u64 file_size, u16 *name, int *badge_c
     return badges_installed;
 }
 
-int install_badge_png(FS_Path badge_path, FS_DirectoryEntry badge_file, int *badge_count, int set_id)
+int install_badge_png(const u16 *badge_path, Platform_Dir_Entry_s *badge_file, int *badge_count, int set_id)
 {
     u64 res;
     char *file_buf = NULL;
-    res = file_to_buf(badge_path, ArchiveSD, &file_buf);
-    if (res != badge_file.fileSize)
+    res = file_to_buf(badge_path, PLATFORM_ARCHIVE_SD, &file_buf);
+    if (res != badge_file->size)
     {
         return -1;
     }
 
-    int badges = install_badge_generic(file_buf, badge_file.fileSize, badge_file.name, badge_count, set_id);
+    int badges = install_badge_generic(file_buf, badge_file->size, badge_file->name, badge_count, set_id);
     free(file_buf);
     return badges;
 }
@@ -157,50 +157,51 @@ int install_badge_zip(u16 *path, int *badge_count, int set_id)
     return data.installed;
 }
 
-int install_badge_dir(FS_DirectoryEntry set_dir, int *badge_count, int set_id)
+int install_badge_dir(Platform_Dir_Entry_s *set_dir, int *badge_count, int set_id)
 {
     Result res;
-    Handle folder;
+    Platform_Dir folder;
     int start_idx = *badge_count;
     char *icon_buf = NULL;
     int icon_size = 0;
     
-    FS_DirectoryEntry *badge_files = calloc(1024, sizeof(FS_DirectoryEntry));
+    Platform_Dir_Entry_s *badge_files = calloc(1024, sizeof(Platform_Dir_Entry_s));
     u16 path[512] = {0};
     u16 set_icon[17] = {0};
     utf8_to_utf16(set_icon, (u8 *) "_seticon.png", 16);
     struacat(path, main_paths[REMOTE_MODE_BADGES]);
-    strucat(path, set_dir.name);
-    res = FSUSER_OpenDirectory(&folder, ArchiveSD, fsMakePath(PATH_UTF16, path));
+    strucat(path, set_dir->name);
+    res = platform_dir_open(&folder, PLATFORM_ARCHIVE_SD, path);
     if (R_FAILED(res))
     {
+        free(badge_files);
         return -1;
     }
-    u32 entries_read;
-    res = FSDIR_Read(folder, &entries_read, 1024, badge_files);
+    u32 entries_read = 0;
+    res = platform_dir_read(folder, badge_files, 1024, &entries_read);
     int badges_in_set = 0;
     progress_finish += entries_read;
     for (u32 i = 0; i < entries_read && *badge_count < 1000; ++i)
     {
-        if (!strcmp(badge_files[i].shortExt, "PNG"))
+        if (!strcmp(badge_files[i].short_ext, "PNG"))
         {
             memset(path, 0, 512 * sizeof(u16));
             struacat(path, main_paths[REMOTE_MODE_BADGES]);
-            strucat(path, set_dir.name);
+            strucat(path, set_dir->name);
             struacat(path, "/");
             strucat(path, badge_files[i].name);
             if (!memcmp(set_icon, badge_files[i].name, 16))
             {
                 DEBUG("Found set icon for folder set %d\n", set_id);
-                icon_size = file_to_buf(fsMakePath(PATH_UTF16, path), ArchiveSD, &icon_buf);
+                icon_size = file_to_buf(path, PLATFORM_ARCHIVE_SD, &icon_buf);
                 continue;
             }
-            badges_in_set += install_badge_png(fsMakePath(PATH_UTF16, path), badge_files[i], badge_count, set_id);
-        } else if (!strcmp(badge_files[i].shortExt, "ZIP"))
+            badges_in_set += install_badge_png(path, &badge_files[i], badge_count, set_id);
+        } else if (!strcmp(badge_files[i].short_ext, "ZIP"))
         {
             memset(path, 0, 512 * sizeof(u16));
             struacat(path, main_paths[REMOTE_MODE_BADGES]);
-            strucat(path, set_dir.name);
+            strucat(path, set_dir->name);
             struacat(path, "/");
             strucat(path, badge_files[i].name);
             badges_in_set += install_badge_zip(path, badge_count, set_id);
@@ -218,7 +219,7 @@ int install_badge_dir(FS_DirectoryEntry set_dir, int *badge_count, int set_id)
     u32 total_count = 0xFFFF * badges_in_set;
     for (int i = 0; i < 16; ++i)
     {
-        FSFILE_Write(badgeDataHandle, NULL, set_index * 0x8A0 + i * 0x8A, set_dir.name, strulen(set_dir.name, 0x45) * 2 + 2, 0);
+        platform_file_write(badgeDataHandle, set_index * 0x8A0 + i * 0x8A, set_dir->name, strulen(set_dir->name, 0x45) * 2 + 2, NULL);
     }
     badgeMngBuffer[0x3D8 + set_index/8] |= 0 << (set_index % 8);
 
@@ -238,22 +239,26 @@ int install_badge_dir(FS_DirectoryEntry set_dir, int *badge_count, int set_id)
     {
         DEBUG("Falling back on default icon\n");
         if (icon_buf) free(icon_buf);
+        icon_buf = NULL;
         FILE *fp = fopen("romfs:/hb_set.png", "rb");
-        fseek(fp, 0L, SEEK_END);
-        icon_size = ftell(fp);
-        icon_buf = malloc(icon_size);
-        fseek(fp, 0L, SEEK_SET);
-        fread(icon_buf, 1, icon_size, fp);
-        fclose(fp);
-        pngToRGB565(icon_buf, icon_size, rgb_buf_64x64, alpha_buf_64x64, rgb_buf_32x32, alpha_buf_32x32, true);
+        if (fp)
+        {
+            fseek(fp, 0L, SEEK_END);
+            icon_size = ftell(fp);
+            icon_buf = malloc(icon_size);
+            fseek(fp, 0L, SEEK_SET);
+            fread(icon_buf, 1, icon_size, fp);
+            fclose(fp);
+            pngToRGB565(icon_buf, icon_size, rgb_buf_64x64, alpha_buf_64x64, rgb_buf_32x32, alpha_buf_32x32, true);
+        }
     }
 
     free(icon_buf);
-    FSFILE_Write(badgeDataHandle, NULL, 0x250F80 + set_index * 0x2000, rgb_buf_64x64, 64 * 64 * 2, 0);
+    platform_file_write(badgeDataHandle, 0x250F80 + set_index * 0x2000, rgb_buf_64x64, 64 * 64 * 2, NULL);
     badgeMngBuffer[0x3D8 + set_index/8] |= 0 << (set_index % 8);
     end:
     free(badge_files);
-    FSDIR_Close(folder);
+    platform_dir_close(folder);
     return badges_in_set;
 }
 
@@ -286,7 +291,7 @@ void free_list(SetNode *head)
     }
 }
 
-SetNode * extract_sets(char *badgeMngBuffer, Handle backupDataHandle)
+SetNode * extract_sets(char *badgeMngBuffer, Platform_File backupDataHandle)
 {
     u32 setCount = *((u32 *) (badgeMngBuffer + 0x4));
 
@@ -294,7 +299,7 @@ SetNode * extract_sets(char *badgeMngBuffer, Handle backupDataHandle)
     {
         u16 set_path[256] = {0};
         struacat(set_path, "/3ds/" APP_TITLE "/BadgeBackups/Unknown Set");
-        FSUSER_CreateDirectory(ArchiveSD, fsMakePath(PATH_UTF16, set_path), FS_ATTRIBUTE_DIRECTORY);
+        platform_dir_create(PLATFORM_ARCHIVE_SD, set_path);
         return NULL;
     }
 
@@ -313,7 +318,7 @@ SetNode * extract_sets(char *badgeMngBuffer, Handle backupDataHandle)
         {
             DEBUG("Processing icon for set %lu at index %lu\n", cursor->set_id, cursor->set_index);
             u16 utf16SetName[0x46] = {0};
-            FSFILE_Read(backupDataHandle, NULL, cursor->set_index * 16 * 0x8A, utf16SetName, 0x8A);
+            platform_file_read(backupDataHandle, cursor->set_index * 16 * 0x8A, utf16SetName, 0x8A, NULL);
             replace_chars(utf16SetName, ILLEGAL_CHARS, u'-');
             u16 set_path[256] = {0};
             struacat(set_path, "/3ds/" APP_TITLE "/BadgeBackups/");
@@ -322,9 +327,9 @@ SetNode * extract_sets(char *badgeMngBuffer, Handle backupDataHandle)
             {
                 struacat(set_path, "Unknown Set");
             }
-            FSUSER_CreateDirectory(ArchiveSD, fsMakePath(PATH_UTF16, set_path), FS_ATTRIBUTE_DIRECTORY);
+            platform_dir_create(PLATFORM_ARCHIVE_SD, set_path);
             memset(icon_alpha_buf, 255, 64 * 64 * 0.5);
-            FSFILE_Read(backupDataHandle, NULL, 0x250F80 + cursor->set_index * 0x2000, icon_rgb_buf, 0x2000);
+            platform_file_read(backupDataHandle, 0x250F80 + cursor->set_index * 0x2000, icon_rgb_buf, 0x2000, NULL);
             char filename[256] = {0};
             utf16_to_utf8((u8 *) filename, set_path, 256);
             strcat(filename, "/_seticon.png");
@@ -346,12 +351,12 @@ Result extract_badges(void)
 {
     DEBUG("Dumping installed badges...\n");
     char *badgeMngBuffer = NULL;
-    u32 size = file_to_buf(fsMakePath(PATH_ASCII, "/BadgeMngFile.dat"), ArchiveBadgeExt, &badgeMngBuffer);
+    u32 size = file_to_buf(u"/BadgeMngFile.dat", PLATFORM_ARCHIVE_BADGE_EXT, &badgeMngBuffer);
     DEBUG("%lu bytes read\n", size);
 
     Result res = 0;
     SetNode *head;
-    Handle backupDataHandle;
+    Platform_File backupDataHandle;
     u16 *badge_rgb_buf = malloc(64 * 64 * 2);
     u8 *badge_alpha_buf = malloc(64 * 64 * 0.5);
     u32 badge_count = 0;
@@ -359,7 +364,7 @@ Result extract_badges(void)
     DEBUG("%lu badges found\n", badge_count);
     if (badge_count > 0)
     {
-        res = FSUSER_OpenFile(&backupDataHandle, ArchiveBadgeExt, fsMakePath(PATH_ASCII, "/BadgeData.dat"), FS_OPEN_READ, 0);
+        res = platform_file_open(&backupDataHandle, PLATFORM_ARCHIVE_BADGE_EXT, u"/BadgeData.dat", PLATFORM_OPEN_READ);
         if (R_FAILED(res))
         {
             free(badgeMngBuffer);
@@ -392,7 +397,7 @@ Result extract_badges(void)
         char filename[512] = {0};
 
         u16 utf16Name[0x46] = {0};
-        FSFILE_Read(backupDataHandle, NULL, 0x35E80 + i * 16 * 0x8A, utf16Name, 0x8A);
+        platform_file_read(backupDataHandle, 0x35E80 + i * 16 * 0x8A, utf16Name, 0x8A, NULL);
         replace_chars(utf16Name, ILLEGAL_CHARS, u'-');
         char utf8Name[256] = {0};
         res = utf16_to_utf8((u8 *) utf8Name, utf16Name, 256);
@@ -406,7 +411,7 @@ Result extract_badges(void)
             } else
             {
                 u16 utf16SetName[0x46] = {0};
-                FSFILE_Read(backupDataHandle, NULL, set_index * 16 * 0x8A, utf16SetName, 0x8A);
+                platform_file_read(backupDataHandle, set_index * 16 * 0x8A, utf16SetName, 0x8A, NULL);
                 replace_chars(utf16SetName, ILLEGAL_CHARS, u'-');
                 char utf8SetName[128] = {0};
                 res = utf16_to_utf8((u8 *) utf8SetName, utf16SetName, 128);
@@ -429,8 +434,8 @@ Result extract_badges(void)
         }
         DEBUG("Dump filename: %s\n", filename);
 
-        FSFILE_Read(backupDataHandle, NULL, 0x318F80 + i * 0x2800, badge_rgb_buf, 0x2000);
-        FSFILE_Read(backupDataHandle, NULL, 0x318F80 + i * 0x2800 + 0x2000, badge_alpha_buf, 0x800);
+        platform_file_read(backupDataHandle, 0x318F80 + i * 0x2800, badge_rgb_buf, 0x2000, NULL);
+        platform_file_read(backupDataHandle, 0x318F80 + i * 0x2800 + 0x2000, badge_alpha_buf, 0x800, NULL);
         rgb565ToPngFile(filename, badge_rgb_buf, badge_alpha_buf, 64, 64);
         draw_loading_bar(i + 1, badge_count, INSTALL_DUMPING_BADGES);
     }
@@ -439,7 +444,7 @@ Result extract_badges(void)
     free(badge_rgb_buf);
     free(badge_alpha_buf);
     free_list(head);
-    FSFILE_Close(backupDataHandle);
+    platform_file_close(backupDataHandle);
 
     return res;
 }
@@ -449,40 +454,43 @@ Result backup_badges_fast(void)
     char *badgeMng = NULL;
 
     DEBUG("writing badge data: making files...\n");
-    char mng_path[128] = "/3ds/" APP_TITLE "/BadgeMngFile.dat";
-    char data_path[128] = "/3ds/" APP_TITLE "/BadgeData.dat";
-    DEBUG("mng_path: %s, data_path: %s\n", mng_path, data_path);
+    const u16 *mng_path = u"/3ds/" APP_TITLE "/BadgeMngFile.dat";
+    const u16 *data_path = u"/3ds/" APP_TITLE "/BadgeData.dat";
 
-    Handle dataHandle = 0;
-    Handle sdHandle = 0;
+    Platform_File dataHandle = 0;
+    Platform_File sdHandle = 0;
 
     DEBUG("loading existing badge mng file...\n");
-    u32 mngRead = file_to_buf(fsMakePath(PATH_ASCII, "/BadgeMngFile.dat"), ArchiveBadgeExt, &badgeMng);
+    u32 mngRead = file_to_buf(u"/BadgeMngFile.dat", PLATFORM_ARCHIVE_BADGE_EXT, &badgeMng);
     DEBUG("loading existing badge data file\n");
-    Result res = FSUSER_OpenFile(&dataHandle, ArchiveBadgeExt, fsMakePath(PATH_ASCII, "/BadgeData.dat"), FS_OPEN_READ, 0);
+    Result res = platform_file_open(&dataHandle, PLATFORM_ARCHIVE_BADGE_EXT, u"/BadgeData.dat", PLATFORM_OPEN_READ);
     if (mngRead != BADGE_MNG_SIZE || R_FAILED(res))
     {
         char err_string[128] = {0};
         sprintf(err_string, language.badges.extdata_locked, res);
         throw_error(err_string, ERROR_LEVEL_WARNING);
         if (badgeMng) free(badgeMng);
-        if (dataHandle) FSFILE_Close(dataHandle);
-        FSFILE_Close(sdHandle);
+        if (R_SUCCEEDED(res)) platform_file_close(dataHandle);
+        return -1;
+    }
+    platform_file_create(PLATFORM_ARCHIVE_SD, data_path, BADGE_DATA_SIZE);
+    res = platform_file_open(&sdHandle, PLATFORM_ARCHIVE_SD, data_path, PLATFORM_OPEN_WRITE);
+    if (R_FAILED(res))
+    {
+        DEBUG("Failed to open the badge data backup: 0x%08lx\n", res);
+        free(badgeMng);
+        platform_file_close(dataHandle);
         return -1;
     }
-    remake_file(fsMakePath(PATH_ASCII, mng_path), ArchiveSD, BADGE_MNG_SIZE);
-
-    FSUSER_CreateFile(ArchiveSD, fsMakePath(PATH_ASCII, data_path), 0, BADGE_DATA_SIZE);
-    FSUSER_OpenFile(&sdHandle, ArchiveSD, fsMakePath(PATH_ASCII, data_path), FS_OPEN_WRITE, 0);
 
     DEBUG("writing badge data: writing BadgeMngFile...\n");
-    res = buf_to_file(mngRead, fsMakePath(PATH_ASCII, mng_path), ArchiveSD, badgeMng);
+    res = write_file(mng_path, PLATFORM_ARCHIVE_SD, badgeMng, mngRead, BADGE_MNG_SIZE);
     if (R_FAILED(res))
     {
         DEBUG("Failed to write badgemngfile: 0x%08lx\n", res);
         free(badgeMng);
-        FSFILE_Close(dataHandle);
-        FSFILE_Close(sdHandle);
+        platform_file_close(dataHandle);
+        platform_file_close(sdHandle);
         return -1;
     }
     DEBUG("writing badge data: writing badgedata...\n");
@@ -492,30 +500,34 @@ Result backup_badges_fast(void)
     while (size > 0)
     {
         u32 read = 0;
-        res = FSFILE_Read(dataHandle, &read, cur, buf, min(0x10000, size));
-        res = FSFILE_Write(sdHandle, NULL, cur, buf, read, FS_WRITE_FLUSH);
+        res = platform_file_read(dataHandle, cur, buf, min(0x10000, size), &read);
+        if (R_FAILED(res) || read == 0)
+            break;
+        res = platform_file_write(sdHandle, cur, buf, read, NULL);
         size -= read;
         cur += read;
     }
 
+    platform_file_flush(sdHandle);
+
     free(badgeMng);
     free(buf);
-    FSFILE_Close(dataHandle);
-    FSFILE_Close(sdHandle);
+    platform_file_close(dataHandle);
+    platform_file_close(sdHandle);
     return 0;
 }
 
 Result install_badges(void)
 {
-    Handle handle = 0;
-    Handle folder = 0;
+    Platform_File handle = 0;
+    Platform_Dir folder = 0;
     Result res = 0;
     draw_loading_bar(0, 1, INSTALL_BADGES);
     {
-        char testpath[128] = "/3ds/" APP_TITLE "/BadgeData.dat";
-        if (R_FAILED(res = FSUSER_OpenFile(&handle, ArchiveSD, fsMakePath(PATH_ASCII, testpath), FS_OPEN_READ, 0)))
+        if (R_FAILED(res = platform_file_open(&handle, PLATFORM_ARCHIVE_SD, u"/3ds/" APP_TITLE "/BadgeData.dat", PLATFORM_OPEN_READ)))
         {
-            if (R_SUMMARY(res) == RS_NOTFOUND)
+            handle = 0;
+            if (platform_not_found(res))
             {
                 res = backup_badges_fast();
                 if (R_FAILED(res)) return res;
@@ -526,8 +538,11 @@ Result install_badges(void)
         }
     }
 
-    if (handle) FSFILE_Close(handle);
+    if (handle) platform_file_close(handle);
+    handle = 0;
 
+    u32 nnidNum = 0xFFFFFFFF;
+#ifdef __3DS__
     DEBUG("Initializing ACT\n");
     res = actInit(true);
     if (R_FAILED(res))
@@ -545,7 +560,6 @@ Result install_badges(void)
     }
 
     DEBUG("Getting NNID\n");
-    u32 nnidNum = 0xFFFFFFFF;
     res = ACT_GetAccountInfo(&nnidNum, sizeof(nnidNum), ACT_DEFAULT_ACCOUNT, INFO_TYPE_PRINCIPAL_ID);
     if (R_FAILED(res))
     {
@@ -553,6 +567,7 @@ Result install_badges(void)
         return res;
     }
     DEBUG("NNID found: 0x%08lx\n", nnidNum);
+#endif
 
     badgeMngBuffer = NULL;
     badgeDataHandle = 0;
@@ -562,22 +577,25 @@ Result install_badges(void)
     alpha_buf_32x32 = NULL;
 
     DEBUG("Opening badge directory\n");
-    FS_DirectoryEntry *badge_files = calloc(1024, sizeof(FS_DirectoryEntry));
-    res = FSUSER_OpenDirectory(&folder, ArchiveSD, fsMakePath(PATH_ASCII, main_paths[REMOTE_MODE_BADGES]));
+    Platform_Dir_Entry_s *badge_files = calloc(1024, sizeof(Platform_Dir_Entry_s));
+    u16 badges_path[0x106] = {0};
+    struacat(badges_path, main_paths[REMOTE_MODE_BADGES]);
+    res = platform_dir_open(&folder, PLATFORM_ARCHIVE_SD, badges_path);
     if (R_FAILED(res))
     {
         DEBUG("Failed to open folder: %lx\n", res);
+        folder = 0;
         goto end;
     }
 
-    u32 entries_read;
-    res = FSDIR_Read(folder, &entries_read, 1024, badge_files);
+    u32 entries_read = 0;
+    res = platform_dir_read(folder, badge_files, 1024, &entries_read);
     DEBUG("%lu files found\n", entries_read);
     rgb_buf_64x64 = malloc(12*6*64*64*2); //12x6 badges in sheet max, 64x64 pixel badges, 2 bytes per RGB data
     alpha_buf_64x64 = malloc(12*6*64*64/2); //Same thing, but 2 pixels of alpha data per byte
     rgb_buf_32x32 = malloc(12*6*32*32*2); //Same thing, but 32x32
     alpha_buf_32x32 = malloc(12*6*32*32/2);
-    res = FSUSER_OpenFile(&badgeDataHandle, ArchiveBadgeExt, fsMakePath(PATH_ASCII, "/BadgeData.dat"), FS_OPEN_WRITE, 0);
+    res = platform_file_open(&badgeDataHandle, PLATFORM_ARCHIVE_BADGE_EXT, u"/BadgeData.dat", PLATFORM_OPEN_WRITE);
     badgeMngBuffer = calloc(1, BADGE_MNG_SIZE);
 
     if (!rgb_buf_64x64)
@@ -633,7 +651,7 @@ Result install_badges(void)
     draw_loading_bar(progress_status, progress_finish, INSTALL_BADGES);
     for (u32 i = 0; i < entries_read && badge_count < 1000; ++i)
     {
-        if (!strcmp(badge_files[i].shortExt, "PNG"))
+        if (!strcmp(badge_files[i].short_ext, "PNG"))
         {
             if (default_set == 0)
             {
@@ -644,8 +662,8 @@ Result install_badges(void)
             u16 path[0x512] = {0};
             struacat(path, main_paths[REMOTE_MODE_BADGES]);
             strucat(path, badge_files[i].name);
-            default_set_count += install_badge_png(fsMakePath(PATH_UTF16, path), badge_files[i], &badge_count, default_set);
-        } else if (!strcmp(badge_files[i].shortExt, "ZIP"))
+            default_set_count += install_badge_png(path, &badge_files[i], &badge_count, default_set);
+        } else if (!strcmp(badge_files[i].short_ext, "ZIP"))
         {
             if (default_set == 0)
             {
@@ -657,10 +675,10 @@ Result install_badges(void)
             strucat(path, badge_files[i].name);
 
             default_set_count += install_badge_zip(path, &badge_count, default_set);
-        } else if (badge_files[i].attributes & FS_ATTRIBUTE_DIRECTORY)
+        } else if (badge_files[i].is_directory)
         {
             set_count += 1;
-            u32 count = install_badge_dir(badge_files[i], &badge_count, set_count);
+            u32 count = install_badge_dir(&badge_files[i], &badge_count, set_count);
             if (count == 0)
                 set_count -= 1;
         }
@@ -677,7 +695,7 @@ Result install_badges(void)
         {
             u16 name[0x8A/2] = {0};
             utf8_to_utf16(name, (u8 *) "Other Badges", 0x8A);
-            FSFILE_Write(badgeDataHandle, NULL, default_index * 0x8A0 + i * 0x8A, &name, strulen(name, 0x45) * 2, 0);
+            platform_file_write(badgeDataHandle, default_index * 0x8A0 + i * 0x8A, &name, strulen(name, 0x45) * 2, NULL);
         }
         badgeMngBuffer[0x3D8 + default_index/8] |= 1 << (default_index % 8);
 
@@ -692,18 +710,21 @@ Result install_badges(void)
         memcpy(badgeMngBuffer + 0xA028 + 0x24 + default_index * 0x30, &default_idx, 4);
 
         FILE *fp = fopen("romfs:/anemone_set.png", "rb");
-        fseek(fp, 0L, SEEK_END);
-        ssize_t size = ftell(fp);
-        char *icon_buf = malloc(size);
-        fseek(fp, 0L, SEEK_SET);
-        fread(icon_buf, 1, size, fp);
-        fclose(fp);
-        pngToRGB565(icon_buf, size, rgb_buf_64x64, alpha_buf_64x64, rgb_buf_32x32, alpha_buf_32x32, true);
-        free(icon_buf);
-        FSFILE_Write(badgeDataHandle, NULL, 0x250F80 + default_index * 0x2000, rgb_buf_64x64, 64 * 64 * 2, 0);
+        if (fp)
+        {
+            fseek(fp, 0L, SEEK_END);
+            ssize_t size = ftell(fp);
+            char *icon_buf = malloc(size);
+            fseek(fp, 0L, SEEK_SET);
+            fread(icon_buf, 1, size, fp);
+            fclose(fp);
+            pngToRGB565(icon_buf, size, rgb_buf_64x64, alpha_buf_64x64, rgb_buf_32x32, alpha_buf_32x32, true);
+            free(icon_buf);
+        }
+        platform_file_write(badgeDataHandle, 0x250F80 + default_index * 0x2000, rgb_buf_64x64, 64 * 64 * 2, NULL);
     }
 
-    FSFILE_Flush(badgeDataHandle);
+    platform_file_flush(badgeDataHandle);
 
     u32 total_badges = 0xFFFF * badge_count; // Quantity * unique badges?
 
@@ -729,14 +750,15 @@ Result install_badges(void)
         memset(badgeMngBuffer + 0xA028 + 0x30 * i + 0x28, 0x00, 0x8);
     }
 
-    res = FSUSER_OpenFile(&handle, ArchiveBadgeExt, fsMakePath(PATH_ASCII, "/BadgeMngFile.dat"), FS_OPEN_READ, 0);
+    res = platform_file_open(&handle, PLATFORM_ARCHIVE_BADGE_EXT, u"/BadgeMngFile.dat", PLATFORM_OPEN_READ);
     if (res == 0)
     {
-        FSFILE_Read(handle, NULL, 0xB2E8, badgeMngBuffer+0xB2E8, 360 * 0x18);
-        FSFILE_Close(handle);
+        platform_file_read(handle, 0xB2E8, badgeMngBuffer+0xB2E8, 360 * 0x18, NULL);
+        platform_file_close(handle);
     }
+    handle = 0;
 
-    res = buf_to_file(BADGE_MNG_SIZE, fsMakePath(PATH_ASCII, "/BadgeMngFile.dat"), ArchiveBadgeExt, badgeMngBuffer);
+    res = buf_to_file(BADGE_MNG_SIZE, u"/BadgeMngFile.dat", PLATFORM_ARCHIVE_BADGE_EXT, badgeMngBuffer);
     if (res)
     {
         DEBUG("Error writing badge manage data! %lx\n", res);
@@ -748,14 +770,16 @@ Result install_badges(void)
 
     
     end:
+#ifdef __3DS__
     actExit();
+#endif
     if (rgb_buf_64x64) free(rgb_buf_64x64);
     if (alpha_buf_64x64) free(alpha_buf_64x64);
     if (rgb_buf_32x32) free(rgb_buf_32x32);
     if (alpha_buf_32x32) free(alpha_buf_32x32);
-    if (handle) FSFILE_Close(handle);
-    if (folder) FSDIR_Close(folder);
-    if (badgeDataHandle) FSFILE_Close(badgeDataHandle);
+    if (handle) platform_file_close(handle);
+    if (folder) platform_dir_close(folder);
+    if (badgeDataHandle) platform_file_close(badgeDataHandle);
     if (badgeMngBuffer) free(badgeMngBuffer);
     if (badge_files) free(badge_files);
     return res;
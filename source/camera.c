@@ -362,34 +362,15 @@ bool init_qr(void)
             {
                 RemoteMode mode = REMOTE_MODE_AMOUNT;
 
-                char * buf = NULL;
-                do {
-                    if(zip_memory_to_buf("body_LZ.bin", zip_buf, zip_size, &buf) != 0)
-                    {
-                        mode = REMOTE_MODE_THEMES;
-                        break;
-                    }
-
-                    free(buf);
-                    buf = NULL;
-                    if(zip_memory_to_buf("splash.bin", zip_buf, zip_size, &buf) != 0)
-                    {
-                        mode = REMOTE_MODE_SPLASHES;
-                        break;
-                    }
-
-                    free(buf);
-                    buf = NULL;
-                    if(zip_memory_to_buf("splashbottom.bin", zip_buf, zip_size, &buf) != 0)
-                    {
-                        mode = REMOTE_MODE_SPLASHES;
-                        break;
-                    }
-                }
-                while(false);
-
-                free(buf);
-                buf = NULL;
+                // only which files are there matters, nothing needs to be extracted
+                const char * probe_files[3] = { "body_LZ.bin", "splash.bin", "splashbottom.bin" };
+                u32 probe_sizes[3] = {0};
+                zip_memory_to_bufs(probe_files, zip_buf, zip_size, NULL, probe_sizes, 3);
+
+                if(probe_sizes[0] != 0)
+                    mode = REMOTE_MODE_THEMES;
+                else if(probe_sizes[1] != 0 || probe_sizes[2] != 0)
+                    mode = REMOTE_MODE_SPLASHES;
 
                 if(mode != REMOTE_MODE_AMOUNT)
                 {
@@ -25,16 +25,64 @@
 */
 
 #include "config.h"
+#include "icon_cache.h"
+#include "unicode.h"
 
 Config_s config;
 
+// the paths in the config are ASCII
+static Result test_dir(const char * path)
+{
+    u16 utf16_path[0x106] = {0};
+    struacat(utf16_path, path);
+
+    Platform_Dir dir;
+    Result res = platform_dir_open(&dir, PLATFORM_ARCHIVE_SD, utf16_path);
+    if(R_SUCCEEDED(res))
+        platform_dir_close(dir);
+    return res;
+}
+
+static void load_extra_paths(json_t * value, EntryMode mode)
+{
+    size_t i;
+    json_t * path_value;
+    json_array_foreach(value, i, path_value)
+    {
+        if(!json_is_string(path_value) || config.extra_paths_count[mode] == EXTRA_PATHS_MAX)
+            continue;
+
+        const char * str = json_string_value(path_value);
+        const size_t len = strlen(str);
+        if(len == 0)
+            continue;
+
+        bool need_slash = str[len - 1] != '/';
+        char * extra_path = calloc(1, len + 1 + (need_slash ? 1 : 0));
+        if(extra_path == NULL)
+            continue;
+        memcpy(extra_path, str, len);
+        if(need_slash) extra_path[len] = '/';
+
+        Result res;
+        if(R_SUCCEEDED(res = test_dir(extra_path)))
+        {
+            config.extra_paths[mode][config.extra_paths_count[mode]++] = extra_path;
+        } else
+        {
+            DEBUG("Failed test - ignoring %s. Err 0x%08lx\n", extra_path, res);
+            free(extra_path);
+        }
+    }
+}
+
 void load_config(void)
 {
-    Handle test_handle;
     Result res;
+    bool icon_cache_size_set = false;
     memset(&config, 0, sizeof(Config_s));
     char *json_buf = NULL;
-    u32 json_len = file_to_buf(fsMakePath(PATH_ASCII, "/3ds/" APP_TITLE "/config.json"), ArchiveSD, &json_buf);
+    u32 json_len = file_to_buf(u"/3ds/" APP_TITLE "/config.json", PLATFORM_ARCHIVE_SD, &json_buf);
     if (json_len)
     {
         json_error_t error;
@@ -168,10 +216,9 @@ void load_config(void)
                     char *theme_path = calloc(1, strlen(json_string_value(value)) + 1 + (need_slash ? 1 : 0));
                     memcpy(theme_path, json_string_value(value), strlen(json_string_value(value)));
                     if (need_slash) theme_path[strlen(json_string_value(value))] = '/';
-                    if (R_SUCCEEDED(res = FSUSER_OpenDirectory(&test_handle, ArchiveSD, fsMakePath(PATH_ASCII, theme_path))))
+                    if (R_SUCCEEDED(res = test_dir(theme_path)))
                     {
                         main_paths[REMOTE_MODE_THEMES] = theme_path;
-                        FSDIR_Close(test_handle);
                     } else
                     {
                         DEBUG("Failed test - reverting to default. Err 0x%08lx\n", res);
@@ -184,26 +231,37 @@ void load_config(void)
                     char *splash_path = calloc(1, strlen(json_string_value(value)) + 1 + (need_slash ? 1 : 0));
                     memcpy(splash_path, json_string_value(value), strlen(json_string_value(value)));
                     if (need_slash) splash_path[strlen(json_string_value(value))] = '/';
-                    if (R_SUCCEEDED(res = FSUSER_OpenDirectory(&test_handle, ArchiveSD, fsMakePath(PATH_ASCII, splash_path))))
+                    if (R_SUCCEEDED(res = test_dir(splash_path)))
                     {
                         main_paths[REMOTE_MODE_SPLASHES] = splash_path;
-                        FSDIR_Close(test_handle);
                     } else
                     {
                         DEBUG("Failed test - reverting to default. Err 0x%08lx\n", res);
                         free(splash_path);
                     }
                 }
+                else if (json_is_array(value) && !strcmp(key, "Themes Extra Paths"))
+                {
+                    load_extra_paths(value, MODE_THEMES);
+                }
+                else if (json_is_array(value) && !strcmp(key, "Splashes Extra Paths"))
+                {
+                    load_extra_paths(value, MODE_SPLASHES);
+                }
+                else if (json_is_integer(value) && !strcmp(key, "Icon Cache Size"))
+                {
+                    config.icon_cache_size = max(0, min(json_integer_value(value), 0x4000));
+                    icon_cache_size_set = true;
+                }
                 else if (json_is_string(value) && !strcmp(key, "Badges Path"))
                 {
                     bool need_slash = json_string_value(value)[strlen(json_string_value(value)) - 1] != '/';
                     char *badge_path = calloc(1, strlen(json_string_value(value)) + 1 + (need_slash ? 1 : 0));
                     memcpy(badge_path, json_string_value(value), strlen(json_string_value(value)));
                     if (need_slash) badge_path[strlen(json_string_value(value))] = '/';
-                    if (R_SUCCEEDED(res = FSUSER_OpenDirectory(&test_handle, ArchiveSD, fsMakePath(PATH_ASCII, badge_path))))
+                    if (R_SUCCEEDED(res = test_dir(badge_path)))
                     {
                         main_paths[REMOTE_MODE_BADGES] = badge_path;
-                        FSDIR_Close(test_handle);
                     } else
                     {
                         DEBUG("Failed test - reverting to default. Err 0x%08lx\n", res);
@@ -243,5 +301,8 @@ void load_config(void)
     if (config.yellow_color == 0)
         config.yellow_color = C2D_Color32(239, 220, 11, 255);
 
+    if (!icon_cache_size_set)
+        config.icon_cache_size = ICON_CACHE_DEFAULT_SIZE;
+
     if (json_buf) free(json_buf);
 }
\ No newline at end of file
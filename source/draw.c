@@ -563,7 +563,7 @@ void draw_grid_interface(Entry_List_s * list, Instructions_s instructions, int e
     draw_instructions(instructions);
 
     int selected_entry = list->selected_entry;
-    Entry_s * current_entry = &list->entries[selected_entry];
+    Entry_s * current_entry = list_get_entry(list, selected_entry);
     draw_entry_info(current_entry);
 
     set_screen(bottom);
@@ -589,7 +589,7 @@ void draw_grid_interface(Entry_List_s * list, Instructions_s instructions, int e
     {
         if(i >= list->entries_count) break;
 
-        current_entry = &list->entries[i];
+        current_entry = list_get_entry(list, i);
 
         char name[0x41] = {0};
         utf16_to_utf8((u8 *)name, current_entry->name, 0x40);
@@ -607,8 +607,12 @@ void draw_grid_interface(Entry_List_s * list, Instructions_s instructions, int e
 
         if(current_entry->placeholder_color == 0)
         {
-            const C2D_Image image = get_icon_at(list, i);
-            C2D_DrawImageAt(image, horizontal_offset, vertical_offset, 0.5f, NULL, 1.0f, 1.0f);
+            // nothing until the icon is there
+            if(icon_ready_at(list, i))
+            {
+                const C2D_Image image = get_icon_at(list, i);
+                C2D_DrawImageAt(image, horizontal_offset, vertical_offset, 0.5f, NULL, 1.0f, 1.0f);
+            }
         }
         else
         {
@@ -662,7 +666,8 @@ void draw_interface(Entry_List_s * list, Instructions_s instructions, DrawMode d
 
     draw_c2d_text_center(GFX_TOP, 4, 0.5f, 0.5f, 0.5f, colors[COLOR_WHITE_ACCENT], mode_string[current_mode]);
 
-    if(list->entries == NULL || list->entries_count == 0)
+    const int count = list_get_count(list);
+    if(list->entries == NULL || count == 0)
     {
         C2D_Text * mode_found_string[MODE_AMOUNT] = {
             &text[TEXT_NO_THEME_FOUND],
@@ -701,7 +706,7 @@ void draw_interface(Entry_List_s * list, Instructions_s instructions, DrawMode d
     draw_instructions(instructions);
 
     int selected_entry = list->selected_entry;
-    Entry_s * current_entry = &list->entries[selected_entry];
+    Entry_s * current_entry = list_get_entry(list, selected_entry);
     draw_entry_info(current_entry);
 
     set_screen(bottom);
@@ -750,14 +755,14 @@ void draw_interface(Entry_List_s * list, Instructions_s instructions, DrawMode d
     //----------------------------------------------------------------
     if(list->scroll > 0)
         draw_image_tint(sprites_arrow_up_idx, 141, 220, accent_tint);
-    if(list->scroll + list->entries_loaded < list->entries_count)
+    if(list->scroll + list->entries_loaded < count)
         draw_image_tint(sprites_arrow_down_idx, 157, 220, accent_tint);
 
     for(int i = list->scroll; i < (list->entries_loaded + list->scroll); i++)
     {
-        if(i >= list->entries_count) break;
+        if(i >= count) break;
 
-        current_entry = &list->entries[i];
+        current_entry = list_get_entry(list, i);
 
         char name[0x41] = {0};
         utf16_to_utf8((u8 *)name, current_entry->name, 0x40);
@@ -800,15 +805,16 @@ void draw_interface(Entry_List_s * list, Instructions_s instructions, DrawMode d
 
         if(current_entry->placeholder_color == 0)
         {
-            C2D_Image image;
-            if(list->entries_count > list->entries_loaded * ICONS_OFFSET_AMOUNT)
+            int icon_index = i;
+            if(count > list->entries_loaded * ICONS_OFFSET_AMOUNT)
             {
                 const int offset_to_visible_icons = ICONS_VISIBLE * list->entries_loaded;
-                image = get_icon_at(list, offset_to_visible_icons + (i - list->scroll));
+                icon_index = offset_to_visible_icons + (i - list->scroll);
             }
-            else
-                image = get_icon_at(list, i);
-            C2D_DrawImageAt(image, horizontal_offset, vertical_offset, 0.5f, NULL, 1.0f, 1.0f);
+
+            // nothing until the icon is there
+            if(icon_ready_at(list, icon_index))
+                C2D_DrawImageAt(get_icon_at(list, icon_index), horizontal_offset, vertical_offset, 0.5f, NULL, 1.0f, 1.0f);
         }
         else
         {
@@ -817,7 +823,7 @@ void draw_interface(Entry_List_s * list, Instructions_s instructions, DrawMode d
     }
 
     char entries_count_str[0x20] = {0};
-    sprintf(entries_count_str, "/%i", list->entries_count);
+    sprintf(entries_count_str, "/%i", count);
     float x = 316;
     float width = 0;
     get_text_dimensions(entries_count_str, 0.6, 0.6, &width, NULL);
@@ -830,7 +836,7 @@ void draw_interface(Entry_List_s * list, Instructions_s instructions, DrawMode d
     x -= width;
     draw_text(x, 219, 0.5, 0.6, 0.6, colors[COLOR_WHITE_ACCENT], selected_entry_str);
 
-    if(list->entries_count < 10000)
+    if(count < 10000)
         draw_c2d_text(176, 219, 0.5, 0.6, 0.6, colors[COLOR_WHITE_ACCENT], &text[TEXT_SELECTED]);
     else
         draw_c2d_text(176, 219, 0.5, 0.6, 0.6, colors[COLOR_WHITE_ACCENT], &text[TEXT_SELECTED_SHORT]);
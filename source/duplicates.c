@@ -0,0 +1,658 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include "duplicates.h"
+#include "loading.h"
+#include "fs.h"
+#include "unicode.h"
+
+#define FINGERPRINTS_MAGIC 0x50524746 // FGRP
+#define FINGERPRINTS_VERSION 1
+
+#define FINGERPRINT_SIZES (1 << 0)
+#define FINGERPRINT_CRCS (1 << 1) // only for zips whose central directory could be used
+#define FINGERPRINT_HASH (1 << 2)
+
+#define HASH_CHUNK_SIZE 0x10000
+
+static const char * payload_names[MODE_AMOUNT][DUPLICATES_PAYLOADS] = {
+    { "/body_LZ.bin", "/bgm.bcstm" },
+    { "/splash.bin", "/splashbottom.bin" },
+};
+
+typedef struct {
+    u32 magic;
+    u32 version;
+    u32 records_count;
+} Fingerprints_Header_s;
+
+// followed by the folder (UTF-8) and the path of the entry, without terminators
+typedef struct {
+    u64 file_size;
+    u64 mtime;
+    u32 sizes[DUPLICATES_PAYLOADS];
+    u32 crcs[DUPLICATES_PAYLOADS];
+    u8 hash[SHA256_HASH_SIZE];
+    u8 flags;
+    u8 folder_len;
+    u16 path_len;
+} Fingerprint_Record_s;
+
+typedef struct {
+    char * data;
+    u32 data_size;
+    u32 * table; // offsets of the records in data, by hash of their folder and path. 0 for empty slots
+    u32 table_size; // power of two
+    u32 records_count;
+} Fingerprints_s;
+
+typedef struct {
+    const u16 * path;
+    const char * folder;
+    u64 file_size;
+    u64 mtime;
+    u32 id;
+    u32 sizes[DUPLICATES_PAYLOADS];
+    u32 crcs[DUPLICATES_PAYLOADS];
+    int hash_slot; // in the hashes, -1 until hashed
+    bool is_zip;
+    u8 flags;
+} Candidate_s;
+
+typedef struct {
+    u8 (* hashes)[SHA256_HASH_SIZE];
+    int count;
+    int capacity;
+} Hashes_s;
+
+static void get_fingerprints_path(u16 * out, EntryMode mode)
+{
+    char path[0x80];
+    sprintf(path, "/3ds/" APP_TITLE "/cache/fingerprints_%d.bin", mode);
+    out[0] = 0;
+    struacat(out, path);
+}
+
+static u32 hash_key(const char * folder, size_t folder_len, const u16 * path, size_t path_len)
+{
+    u32 hash = 2166136261u;
+    for(size_t i = 0; i < folder_len; i++)
+        hash = (hash ^ (u8)folder[i]) * 16777619u;
+    for(size_t i = 0; i < path_len; i++)
+        hash = (hash ^ path[i]) * 16777619u;
+    return hash;
+}
+
+static u32 record_size(const Fingerprint_Record_s * record)
+{
+    return sizeof(Fingerprint_Record_s) + record->folder_len + record->path_len * sizeof(u16);
+}
+
+static void fingerprints_free(Fingerprints_s * fingerprints)
+{
+    free(fingerprints->data);
+    free(fingerprints->table);
+    memset(fingerprints, 0, sizeof(Fingerprints_s));
+}
+
+static bool fingerprints_load(Fingerprints_s * fingerprints, EntryMode mode)
+{
+    memset(fingerprints, 0, sizeof(Fingerprints_s));
+
+    u16 path[0x80];
+    get_fingerprints_path(path, mode);
+    fingerprints->data_size = file_to_buf(path, PLATFORM_ARCHIVE_SD, &fingerprints->data);
+
+    Fingerprints_Header_s header;
+    if(fingerprints->data_size < sizeof(header))
+    {
+        fingerprints_free(fingerprints);
+        return false;
+    }
+
+    memcpy(&header, fingerprints->data, sizeof(header));
+    if(header.magic != FINGERPRINTS_MAGIC || header.version != FINGERPRINTS_VERSION || header.records_count == 0)
+    {
+        DEBUG("Ignoring outdated fingerprints %s\n", path);
+        fingerprints_free(fingerprints);
+        return false;
+    }
+
+    // no more than the data can hold, which also keeps the table size from overflowing
+    const u32 records_max = (fingerprints->data_size - sizeof(header)) / sizeof(Fingerprint_Record_s);
+    if(header.records_count > records_max)
+        header.records_count = records_max;
+
+    fingerprints->table_size = 1;
+    while(fingerprints->table_size < header.records_count * 2)
+        fingerprints->table_size <<= 1;
+    fingerprints->table = calloc(fingerprints->table_size, sizeof(u32));
+    if(fingerprints->table == NULL)
+    {
+        fingerprints_free(fingerprints);
+        return false;
+    }
+
+    u32 offset = sizeof(header);
+    for(u32 i = 0; i < header.records_count; i++)
+    {
+        Fingerprint_Record_s record;
+        if(offset + sizeof(record) > fingerprints->data_size)
+            break;
+        memcpy(&record, fingerprints->data + offset, sizeof(record));
+        if(offset + record_size(&record) > fingerprints->data_size)
+            break;
+
+        const char * record_folder = fingerprints->data + offset + sizeof(record);
+        const u16 * record_path = (const u16 *)(record_folder + record.folder_len);
+        u32 slot = hash_key(record_folder, record.folder_len, record_path, record.path_len) & (fingerprints->table_size - 1);
+        while(fingerprints->table[slot] != 0)
+            slot = (slot + 1) & (fingerprints->table_size - 1);
+        fingerprints->table[slot] = offset;
+        fingerprints->records_count++;
+
+        offset += record_size(&record);
+    }
+
+    return true;
+}
+
+static int add_hash(Hashes_s * hashes, const u8 * hash)
+{
+    if(hashes->count == hashes->capacity)
+    {
+        const int next_capacity = max(hashes->capacity * 2, 64);
+        u8 (* new_hashes)[SHA256_HASH_SIZE] = realloc(hashes->hashes, next_capacity * SHA256_HASH_SIZE);
+        if(new_hashes == NULL)
+            return -1;
+        hashes->hashes = new_hashes;
+        hashes->capacity = next_capacity;
+    }
+
+    memcpy(hashes->hashes[hashes->count], hash, SHA256_HASH_SIZE);
+    return hashes->count++;
+}
+
+// returns true if the candidate was found with the same size and mtime as when it was saved
+static bool fingerprints_fill(const Fingerprints_s * fingerprints, Candidate_s * candidate, Hashes_s * hashes)
+{
+    if(fingerprints->table == NULL)
+        return false;
+
+    const size_t folder_len = strlen(candidate->folder);
+    const size_t path_len = strulen(candidate->path, 0x106);
+    u32 slot = hash_key(candidate->folder, folder_len, candidate->path, path_len) & (fingerprints->table_size - 1);
+    for(; fingerprints->table[slot] != 0; slot = (slot + 1) & (fingerprints->table_size - 1))
+    {
+        const char * data = fingerprints->data + fingerprints->table[slot];
+        Fingerprint_Record_s record;
+        memcpy(&record, data, sizeof(record));
+        const char * record_folder = data + sizeof(record);
+        const char * record_path = record_folder + record.folder_len;
+
+        if(record.folder_len != folder_len || record.path_len != path_len
+            || memcmp(record_folder, candidate->folder, folder_len) || memcmp(record_path, candidate->path, path_len * sizeof(u16)))
+            continue;
+
+        if(record.file_size != candidate->file_size || record.mtime != candidate->mtime || !(record.flags & FINGERPRINT_SIZES))
+            return false;
+
+        memcpy(candidate->sizes, record.sizes, sizeof(candidate->sizes));
+        memcpy(candidate->crcs, record.crcs, sizeof(candidate->crcs));
+        candidate->flags = record.flags & (FINGERPRINT_SIZES | FINGERPRINT_CRCS);
+        if(record.flags & FINGERPRINT_HASH)
+        {
+            candidate->hash_slot = add_hash(hashes, record.hash);
+            if(candidate->hash_slot >= 0)
+                candidate->flags |= FINGERPRINT_HASH;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+static void fingerprints_save(const Candidate_s * candidates, u32 count, const Hashes_s * hashes, EntryMode mode)
+{
+    u32 size = sizeof(Fingerprints_Header_s);
+    u32 records_count = 0;
+    for(u32 i = 0; i < count; i++)
+    {
+        if(!(candidates[i].flags & FINGERPRINT_SIZES))
+            continue;
+        size += sizeof(Fingerprint_Record_s) + strlen(candidates[i].folder) + strulen(candidates[i].path, 0x106) * sizeof(u16);
+        records_count++;
+    }
+
+    char * buf = malloc(size);
+    if(buf == NULL)
+        return;
+
+    const Fingerprints_Header_s header = {
+        .magic = FINGERPRINTS_MAGIC,
+        .version = FINGERPRINTS_VERSION,
+        .records_count = records_count,
+    };
+    memcpy(buf, &header, sizeof(header));
+
+    u32 offset = sizeof(header);
+    for(u32 i = 0; i < count; i++)
+    {
+        const Candidate_s * const candidate = &candidates[i];
+        if(!(candidate->flags & FINGERPRINT_SIZES))
+            continue;
+
+        Fingerprint_Record_s record = {
+            .file_size = candidate->file_size,
+            .mtime = candidate->mtime,
+            .flags = candidate->flags,
+            .folder_len = strlen(candidate->folder),
+            .path_len = strulen(candidate->path, 0x106),
+        };
+        memcpy(record.sizes, candidate->sizes, sizeof(record.sizes));
+        memcpy(record.crcs, candidate->crcs, sizeof(record.crcs));
+        if(candidate->flags & FINGERPRINT_HASH)
+            memcpy(record.hash, hashes->hashes[candidate->hash_slot], SHA256_HASH_SIZE);
+
+        memcpy(buf + offset, &record, sizeof(record));
+        char * strings = buf + offset + sizeof(record);
+        memcpy(strings, candidate->folder, record.folder_len);
+        memcpy(strings + record.folder_len, candidate->path, record.path_len * sizeof(u16));
+        offset += record_size(&record);
+    }
+
+    u16 path[0x80];
+    get_fingerprints_path(path, mode);
+    write_file(path, PLATFORM_ARCHIVE_SD, buf, offset, offset);
+    free(buf);
+}
+
+static void candidate_to_entry(const Candidate_s * candidate, Entry_s * entry)
+{
+    memset(entry, 0, sizeof(Entry_s));
+    entry->path = candidate->path;
+    entry->folder = candidate->folder;
+    entry->is_zip = candidate->is_zip;
+}
+
+// only opens the files: a loose file has its size in the SD's tables, a zipped one in the central directory, with its CRC
+static void probe_payloads(Candidate_s * candidate, EntryMode mode)
+{
+    Entry_s entry;
+    candidate_to_entry(candidate, &entry);
+
+    candidate->flags = FINGERPRINT_SIZES | (candidate->is_zip ? FINGERPRINT_CRCS : 0);
+    for(int i = 0; i < DUPLICATES_PAYLOADS; i++)
+    {
+        candidate->sizes[i] = 0;
+        candidate->crcs[i] = 0;
+
+        Data_Stream_s stream;
+        if(!open_data_stream(payload_names[mode][i], &entry, &stream))
+            continue;
+
+        candidate->sizes[i] = stream.size;
+        if(stream.type == DATA_STREAM_ZIP_INDEX)
+            candidate->crcs[i] = stream.zip_member.member.crc;
+        else
+            candidate->flags &= ~FINGERPRINT_CRCS;
+        stream_close(&stream);
+    }
+}
+
+static void hash_payloads(Candidate_s * candidate, Hashes_s * hashes, EntryMode mode, char * chunk)
+{
+    Entry_s entry;
+    candidate_to_entry(candidate, &entry);
+
+    u8 payload_hashes[DUPLICATES_PAYLOADS][SHA256_HASH_SIZE] = {0};
+    for(int i = 0; i < DUPLICATES_PAYLOADS; i++)
+    {
+        if(candidate->sizes[i] == 0)
+            continue;
+
+        // the bgm can be megabytes, it's hashed a chunk at a time
+        Data_Stream_s stream;
+        u32 size = 0;
+        if(open_data_stream(payload_names[mode][i], &entry, &stream))
+        {
+            Platform_Sha256_s context;
+            platform_sha256_init(&context);
+            if(stream.size == candidate->sizes[i])
+            {
+                u32 read = 0;
+                while(size < stream.size && (read = stream_read(&stream, chunk, min(HASH_CHUNK_SIZE, stream.size - size))) != 0)
+                {
+                    platform_sha256_update(&context, chunk, read);
+                    size += read;
+                }
+            }
+            platform_sha256_final(&context, payload_hashes[i]);
+            stream_close(&stream);
+        }
+
+        // changed since its size was taken, it'll be looked at again next time
+        if(size != candidate->sizes[i])
+        {
+            candidate->flags = 0;
+            return;
+        }
+    }
+
+    u8 hash[SHA256_HASH_SIZE];
+    platform_sha256(payload_hashes, sizeof(payload_hashes), hash);
+    candidate->hash_slot = add_hash(hashes, hash);
+    if(candidate->hash_slot >= 0)
+        candidate->flags |= FINGERPRINT_HASH;
+}
+
+static int compare_sizes(const void * a, const void * b)
+{
+    const Candidate_s * const candidate_a = (const Candidate_s *)a;
+    const Candidate_s * const candidate_b = (const Candidate_s *)b;
+    for(int i = 0; i < DUPLICATES_PAYLOADS; i++)
+    {
+        if(candidate_a->sizes[i] != candidate_b->sizes[i])
+            return candidate_a->sizes[i] < candidate_b->sizes[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+// a zip whose CRCs no other entry of the same sizes shares can't be a copy. Anything without CRCs has to be hashed
+static bool needs_hash(const Candidate_s * run, int run_length, int index)
+{
+    const Candidate_s * const candidate = &run[index];
+    if(candidate->flags & FINGERPRINT_HASH)
+        return false;
+    if(!(candidate->flags & FINGERPRINT_CRCS))
+        return true;
+
+    for(int i = 0; i < run_length; i++)
+    {
+        if(i == index)
+            continue;
+        if(!(run[i].flags & FINGERPRINT_CRCS) || !memcmp(run[i].crcs, candidate->crcs, sizeof(candidate->crcs)))
+            return true;
+    }
+    return false;
+}
+
+void find_duplicates_thread(void * void_arg)
+{
+    Thread_Arg_s * arg = (Thread_Arg_s *)void_arg;
+    Duplicates_s * duplicates = (Duplicates_s *)arg->thread_arg;
+    Entry_List_s * list = duplicates->list;
+    if(list == NULL || list->entries == NULL || list->mode >= MODE_AMOUNT)
+        return;
+
+    // the paths of the entries stay in the list, even when their pages are swapped out
+    platform_mutex_lock(&list->info_lock);
+    const u32 count = list->entries_count;
+    Candidate_s * candidates = calloc(count, sizeof(Candidate_s));
+    if(candidates != NULL)
+    {
+        Entry_Walk_s walk;
+        list_walk_start(&walk, list);
+        for(u32 i = 0; i < count; i++)
+        {
+            const Entry_s * const entry = list_walk_entry(&walk, i);
+            Candidate_s * const candidate = &candidates[i];
+            candidate->path = entry->path;
+            candidate->folder = entry->folder != NULL ? entry->folder : "";
+            candidate->file_size = entry->file_size;
+            candidate->mtime = entry->mtime;
+            candidate->id = entry->id;
+            candidate->is_zip = entry->is_zip;
+            candidate->hash_slot = -1;
+        }
+        list_walk_end(&walk);
+    }
+    platform_mutex_unlock(&list->info_lock);
+    u32 * group_of = calloc(count, sizeof(u32));
+    char * chunk = malloc(HASH_CHUNK_SIZE);
+    if(candidates == NULL || group_of == NULL || chunk == NULL)
+    {
+        free(candidates);
+        free(group_of);
+        free(chunk);
+        return;
+    }
+
+    Hashes_s hashes = {0};
+    Fingerprints_s fingerprints;
+    fingerprints_load(&fingerprints, list->mode);
+    bool changed = fingerprints.records_count != count;
+    for(u32 i = 0; i < count && arg->run_thread; i++)
+    {
+        if(fingerprints_fill(&fingerprints, &candidates[i], &hashes))
+            continue;
+
+        probe_payloads(&candidates[i], list->mode);
+        changed = true;
+    }
+    fingerprints_free(&fingerprints);
+
+    qsort(candidates, count, sizeof(Candidate_s), compare_sizes);
+
+    u32 groups_count = 0;
+    for(u32 start = 0, end = 0; start < count && arg->run_thread; start = end)
+    {
+        for(end = start + 1; end < count && !compare_sizes(&candidates[start], &candidates[end]); end++);
+
+        Candidate_s * const run = &candidates[start];
+        const int run_length = end - start;
+        if(run_length < 2 || !(run->flags & FINGERPRINT_SIZES) || (run->sizes[0] == 0 && run->sizes[1] == 0))
+            continue;
+
+        for(int i = 0; i < run_length && arg->run_thread; i++)
+        {
+            if(!needs_hash(run, run_length, i))
+                continue;
+
+            hash_payloads(&run[i], &hashes, list->mode, chunk);
+            changed = true;
+        }
+
+        // there's rarely more than a few entries with the same sizes
+        for(int i = 0; i < run_length; i++)
+        {
+            if(!(run[i].flags & FINGERPRINT_HASH) || group_of[run[i].id] != 0)
+                continue;
+
+            for(int j = i + 1; j < run_length; j++)
+            {
+                if(!(run[j].flags & FINGERPRINT_HASH) || memcmp(hashes.hashes[run[i].hash_slot], hashes.hashes[run[j].hash_slot], SHA256_HASH_SIZE))
+                    continue;
+
+                if(group_of[run[i].id] == 0)
+                    group_of[run[i].id] = ++groups_count;
+                group_of[run[j].id] = group_of[run[i].id];
+            }
+        }
+    }
+
+    if(arg->run_thread)
+    {
+        if(changed)
+            fingerprints_save(candidates, count, &hashes, list->mode);
+
+        DEBUG("%lu groups of duplicates in %lu entries\n", groups_count, count);
+        duplicates->group_of = group_of;
+        duplicates->ids_count = count;
+        duplicates->groups_count = groups_count;
+        duplicates->done = true;
+    }
+    else
+    {
+        free(group_of);
+    }
+
+    free(chunk);
+    free(hashes.hashes);
+    free(candidates);
+}
+
+void duplicates_free(Duplicates_s * duplicates)
+{
+    free(duplicates->group_of);
+    memset(duplicates, 0, sizeof(Duplicates_s));
+}
+
+static u32 get_group(const Duplicates_s * duplicates, u32 id)
+{
+    return id < duplicates->ids_count ? duplicates->group_of[id] : 0;
+}
+
+// calls found for every entry that has a copy, in list order, with whether it's the first of its group.
+// info_lock has to be held, so the order stays the same
+static int for_each_copy(const Duplicates_s * duplicates, const Entry_List_s * list, void (*found)(const Entry_List_s *, int, bool, void *), void * userdata)
+{
+    if(!duplicates->done || duplicates->groups_count == 0)
+        return 0;
+
+    u8 * seen = calloc(duplicates->groups_count + 1, sizeof(u8));
+    if(seen == NULL)
+        return 0;
+
+    int total = 0;
+    for(int i = 0; i < list->entries_count; i++)
+    {
+        const u32 group = get_group(duplicates, list_id_at(list, i));
+        if(group == 0)
+            continue;
+
+        found(list, i, !seen[group], userdata);
+        seen[group] = 1;
+        total++;
+    }
+
+    free(seen);
+    return total;
+}
+
+typedef struct {
+    int * view;
+    int view_count;
+} Duplicates_View_s;
+
+static void add_to_view(const Entry_List_s * list, int position, bool first, void * userdata)
+{
+    (void)list;
+    (void)first;
+    Duplicates_View_s * view = (Duplicates_View_s *)userdata;
+    view->view[view->view_count++] = position;
+}
+
+static void mark_copy(const Entry_List_s * list, int position, bool first, void * userdata)
+{
+    (void)list;
+    if(!first)
+        ((u8 *)userdata)[position] = 1;
+}
+
+bool duplicates_show(const Duplicates_s * duplicates, Entry_List_s * list)
+{
+    Duplicates_View_s view = {0};
+    platform_mutex_lock(&list->info_lock);
+    view.view = malloc(list->entries_count * sizeof(int));
+    if(view.view == NULL)
+    {
+        platform_mutex_unlock(&list->info_lock);
+        return false;
+    }
+
+    for_each_copy(duplicates, list, add_to_view, &view);
+    if(view.view_count != 0)
+    {
+        list_clear_view(list);
+        list->view = view.view;
+        list->view_count = view.view_count;
+    }
+    platform_mutex_unlock(&list->info_lock);
+
+    if(view.view_count == 0)
+        free(view.view);
+    return view.view_count != 0;
+}
+
+void duplicates_hide_copies(const Duplicates_s * duplicates, Entry_List_s * list)
+{
+    platform_mutex_lock(&list->info_lock);
+    u8 * copies = calloc(list->entries_count, sizeof(u8));
+    int * view = malloc(list->entries_count * sizeof(int));
+    if(copies == NULL || view == NULL)
+    {
+        platform_mutex_unlock(&list->info_lock);
+        free(copies);
+        free(view);
+        return;
+    }
+
+    for_each_copy(duplicates, list, mark_copy, copies);
+    int view_count = 0;
+    for(int i = 0; i < list->entries_count; i++)
+    {
+        if(!copies[i])
+            view[view_count++] = i;
+    }
+    list_clear_view(list);
+    list->view = view;
+    list->view_count = view_count;
+    platform_mutex_unlock(&list->info_lock);
+
+    free(copies);
+}
+
+void duplicates_delete_copies(const Duplicates_s * duplicates, Entry_List_s * list)
+{
+    // which entries to delete is decided under the lock, the deleting itself is a long way to the SD
+    platform_mutex_lock(&list->info_lock);
+    u8 * copies = calloc(list->entries_count, sizeof(u8));
+    Entry_Ref_s * refs = malloc(list->entries_count * sizeof(Entry_Ref_s));
+    int refs_count = 0;
+    if(copies != NULL && refs != NULL)
+    {
+        for_each_copy(duplicates, list, mark_copy, copies);
+        for(int i = 0; i < list->entries_count; i++)
+        {
+            if(!copies[i])
+                continue;
+
+            const Entry_s * entry = get_entry_at(list, list_id_at(list, i));
+            refs[refs_count++] = (Entry_Ref_s){entry->path, entry->folder, entry->id, entry->is_zip};
+        }
+    }
+    platform_mutex_unlock(&list->info_lock);
+
+    for(int i = 0; i < refs_count; i++)
+    {
+        Entry_s entry = entry_from_ref(&refs[i]);
+        delete_entry(&entry, entry.is_zip);
+    }
+
+    free(refs);
+    free(copies);
+}
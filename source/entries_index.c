@@ -0,0 +1,254 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include "entries_index.h"
+#include "fs.h"
+#include "unicode.h"
+
+#define ENTRIES_INDEX_MAGIC 0x58444941 // AIDX
+#define ENTRIES_INDEX_VERSION 1
+
+typedef struct {
+    u32 magic;
+    u32 version;
+    u32 records_count;
+} Entries_Index_Header_s;
+
+// followed by the path (relative to the folder), name, description and author, without terminators
+typedef struct {
+    u64 file_size;
+    u64 mtime;
+    u32 placeholder_color;
+    u16 path_len;
+    u16 name_len;
+    u16 desc_len;
+    u16 author_len;
+} Entries_Index_Record_s;
+
+static void get_index_path(u16 * out, const char * loading_path)
+{
+    u32 hash = 2166136261u;
+    for(const char * c = loading_path; *c != '\0'; c++)
+        hash = (hash ^ (u8)*c) * 16777619u;
+
+    char path[0x80];
+    sprintf(path, "/3ds/" APP_TITLE "/cache/index_%08lx.bin", hash);
+    out[0] = 0;
+    struacat(out, path);
+}
+
+static u32 hash_path(const u16 * path, size_t len)
+{
+    u32 hash = 2166136261u;
+    for(size_t i = 0; i < len; i++)
+        hash = (hash ^ path[i]) * 16777619u;
+    return hash;
+}
+
+static u32 record_size(const Entries_Index_Record_s * record)
+{
+    return sizeof(Entries_Index_Record_s) + (record->path_len + record->name_len + record->desc_len + record->author_len) * sizeof(u16);
+}
+
+bool entries_index_load(Entries_Index_s * index, const char * loading_path)
+{
+    memset(index, 0, sizeof(Entries_Index_s));
+
+    u16 path[0x80];
+    get_index_path(path, loading_path);
+    index->data_size = file_to_buf(path, PLATFORM_ARCHIVE_SD, &index->data);
+
+    Entries_Index_Header_s header;
+    if(index->data_size < sizeof(header))
+    {
+        entries_index_free(index);
+        return false;
+    }
+
+    memcpy(&header, index->data, sizeof(header));
+    if(header.magic != ENTRIES_INDEX_MAGIC || header.version != ENTRIES_INDEX_VERSION || header.records_count == 0)
+    {
+        DEBUG("Ignoring outdated entries index %s\n", path);
+        entries_index_free(index);
+        return false;
+    }
+
+    // no more than the data can hold, which also keeps the table size from overflowing
+    const u32 records_max = (index->data_size - sizeof(header)) / sizeof(Entries_Index_Record_s);
+    if(header.records_count > records_max)
+        header.records_count = records_max;
+
+    index->records_count = header.records_count;
+    index->table_size = 1;
+    while(index->table_size < header.records_count * 2)
+        index->table_size <<= 1;
+    index->table = calloc(index->table_size, sizeof(u32));
+    if(index->table == NULL)
+    {
+        entries_index_free(index);
+        return false;
+    }
+
+    u32 offset = sizeof(header);
+    for(u32 i = 0; i < header.records_count; i++)
+    {
+        Entries_Index_Record_s record;
+        if(offset + sizeof(record) > index->data_size)
+            break;
+        memcpy(&record, index->data + offset, sizeof(record));
+        if(offset + record_size(&record) > index->data_size)
+            break;
+
+        const u16 * record_path = (const u16 *)(index->data + offset + sizeof(record));
+        u32 slot = hash_path(record_path, record.path_len) & (index->table_size - 1);
+        while(index->table[slot] != 0)
+            slot = (slot + 1) & (index->table_size - 1);
+        index->table[slot] = offset;
+
+        offset += record_size(&record);
+    }
+
+    return true;
+}
+
+bool entries_index_fill(const Entries_Index_s * index, Entry_s * entry, String_Arena_s * strings_arena)
+{
+    if(index->table == NULL)
+        return false;
+
+    const u16 * relative_path = entry->path;
+    const size_t path_len = strulen(relative_path, 0x106);
+
+    u32 slot = hash_path(relative_path, path_len) & (index->table_size - 1);
+    for(; index->table[slot] != 0; slot = (slot + 1) & (index->table_size - 1))
+    {
+        const char * data = index->data + index->table[slot];
+        Entries_Index_Record_s record;
+        memcpy(&record, data, sizeof(record));
+        const char * strings = data + sizeof(record);
+
+        if(record.path_len != path_len || memcmp(strings, relative_path, path_len * sizeof(u16)))
+            continue;
+
+        if(record.file_size != entry->file_size || record.mtime != entry->mtime)
+            return false;
+
+        if(record.name_len > 0x40 || record.desc_len > 0x80 || record.author_len > 0x40)
+            return false;
+
+        strings += record.path_len * sizeof(u16);
+        entry->name = arena_add(strings_arena, (const u16 *)strings, record.name_len);
+        strings += record.name_len * sizeof(u16);
+        entry->desc = arena_add(strings_arena, (const u16 *)strings, record.desc_len);
+        strings += record.desc_len * sizeof(u16);
+        entry->author = arena_add(strings_arena, (const u16 *)strings, record.author_len);
+        entry->placeholder_color = record.placeholder_color;
+        return true;
+    }
+
+    return false;
+}
+
+void entries_index_free(Entries_Index_s * index)
+{
+    free(index->data);
+    free(index->table);
+    memset(index, 0, sizeof(Entries_Index_s));
+}
+
+static void save_root_index(Entry_List_s * list, const char * root)
+{
+    // the swapped out pages are read into the walks, not back into the list
+    Entry_Walk_s walk;
+    list_walk_start(&walk, list);
+    u32 size = sizeof(Entries_Index_Header_s);
+    u32 records_count = 0;
+    for(int i = 0; i < list->entries_count; i++)
+    {
+        const Entry_s * const entry = list_walk_entry(&walk, i);
+        if(entry->folder != root)
+            continue;
+
+        size += sizeof(Entries_Index_Record_s) + (strulen(entry->path, 0x106) + strulen(entry->name, 0x40) + strulen(entry->desc, 0x80) + strulen(entry->author, 0x40)) * sizeof(u16);
+        records_count++;
+    }
+    list_walk_end(&walk);
+
+    char * buf = malloc(size);
+    if(buf == NULL)
+        return;
+
+    const Entries_Index_Header_s header = {
+        .magic = ENTRIES_INDEX_MAGIC,
+        .version = ENTRIES_INDEX_VERSION,
+        .records_count = records_count,
+    };
+    memcpy(buf, &header, sizeof(header));
+
+    u32 offset = sizeof(header);
+    list_walk_start(&walk, list);
+    for(int i = 0; i < list->entries_count; i++)
+    {
+        const Entry_s * const entry = list_walk_entry(&walk, i);
+        if(entry->folder != root)
+            continue;
+
+        const u16 * relative_path = entry->path;
+        const Entries_Index_Record_s record = {
+            .file_size = entry->file_size,
+            .mtime = entry->mtime,
+            .placeholder_color = entry->placeholder_color,
+            .path_len = strulen(relative_path, 0x106),
+            .name_len = strulen(entry->name, 0x40),
+            .desc_len = strulen(entry->desc, 0x80),
+            .author_len = strulen(entry->author, 0x40),
+        };
+
+        memcpy(buf + offset, &record, sizeof(record));
+        char * strings = buf + offset + sizeof(record);
+        memcpy(strings, relative_path, record.path_len * sizeof(u16));
+        strings += record.path_len * sizeof(u16);
+        memcpy(strings, entry->name, record.name_len * sizeof(u16));
+        strings += record.name_len * sizeof(u16);
+        memcpy(strings, entry->desc, record.desc_len * sizeof(u16));
+        strings += record.desc_len * sizeof(u16);
+        memcpy(strings, entry->author, record.author_len * sizeof(u16));
+
+        offset += record_size(&record);
+    }
+    list_walk_end(&walk);
+
+    u16 path[0x80];
+    get_index_path(path, root);
+    write_file(path, PLATFORM_ARCHIVE_SD, buf, offset, offset);
+    free(buf);
+}
+
+void entries_index_save(Entry_List_s * list)
+{
+    for(int i = 0; i < list->roots_count; i++)
+        save_root_index(list, list->roots[i]);
+}
@@ -28,204 +28,1532 @@
 #include "loading.h"
 #include "draw.h"
 #include "fs.h"
+#include "pool.h"
+#include "entries_index.h"
 #include "unicode.h"
+#include "zip.h"
+#include "icon_cache.h"
+#include "icon_atlas.h"
+
+void entry_get_path(const Entry_s * entry, u16 * path)
+{
+    path[0] = 0;
+    if(entry->folder != NULL)
+        struacat(path, entry->folder);
+    if(entry->path != NULL)
+        strucat(path, entry->path);
+}
+
+void parse_smdh(Icon_s * icon, Entry_s * entry, const u16 * fallback_name, String_Arena_s * strings)
+{
+    if(icon == NULL)
+    {
+        entry->name = fallback_name;
+        entry->desc = (const u16 *)u"No description";
+        entry->author = (const u16 *)u"Unknown author";
+        entry->placeholder_color = C2D_Color32(rand() % 255, rand() % 255, rand() % 255, 255);
+        return;
+    }
+
+    entry->name = arena_add(strings, icon->name, strulen(icon->name, 0x40));
+    entry->desc = arena_add(strings, icon->desc, strulen(icon->desc, 0x80));
+    entry->author = arena_add(strings, icon->author, strulen(icon->author, 0x40));
+    entry->placeholder_color = 0;
+}
 
 void delete_entry(Entry_s * entry, bool is_file)
 {
+    u16 path[0x106] = {0};
+    entry_get_path(entry, path);
     if(is_file)
-        FSUSER_DeleteFile(ArchiveSD, fsMakePath(PATH_UTF16, entry->path));
+    {
+        zip_index_forget(path);
+        platform_file_delete(PLATFORM_ARCHIVE_SD, path);
+    }
     else
-        FSUSER_DeleteDirectoryRecursively(ArchiveSD, fsMakePath(PATH_UTF16, entry->path));
+    {
+        platform_dir_delete(PLATFORM_ARCHIVE_SD, path);
+    }
+}
+
+u32 load_data_multi(const char ** filenames, const Entry_s * entry, char ** bufs, u32 * sizes, int count)
+{
+    u16 entry_path[0x106] = {0};
+    entry_get_path(entry, entry_path);
+    if(entry->is_zip)
+    {
+        const char * zip_names[count];
+        for(int i = 0; i < count; i++)
+            zip_names[i] = filenames[i] + 1; //the first character will always be '/' because of the other case
+
+        return zip_file_to_bufs(zip_names, entry_path, bufs, sizes, count);
+    }
+    else
+    {
+        u32 found = 0;
+        for(int i = 0; i < count; i++)
+        {
+            u16 path[0x106] = {0};
+            strucat(path, entry_path);
+            struacat(path, filenames[i]);
+
+            bufs[i] = NULL;
+            sizes[i] = file_to_buf(path, PLATFORM_ARCHIVE_SD, &bufs[i]);
+            if(sizes[i] != 0)
+                found++;
+        }
+
+        return found;
+    }
 }
 
 u32 load_data(const char * filename, const Entry_s * entry, char ** buf)
 {
+    u32 size = 0;
+    load_data_multi(&filename, entry, buf, &size, 1);
+    return size;
+}
+
+u32 load_pooled_data(const char * filename, const Entry_s * entry, char ** buf)
+{
+    *buf = NULL;
+
+    Data_Stream_s stream;
+    if(!open_data_stream(filename, entry, &stream))
+        return 0;
+
+    u32 size = stream.size;
+    if(size != 0)
+    {
+        *buf = pool_alloc(size);
+        u32 done = 0, read = 0;
+        while(*buf != NULL && done < size && (read = stream_read(&stream, *buf + done, size - done)) != 0)
+            done += read;
+
+        if(done != size)
+        {
+            pool_free(*buf);
+            *buf = NULL;
+            size = 0;
+        }
+    }
+
+    stream_close(&stream);
+    return size;
+}
+
+bool open_data_stream(const char * filename, const Entry_s * entry, Data_Stream_s * stream)
+{
+    u16 path[0x106] = {0};
+    entry_get_path(entry, path);
     if(entry->is_zip)
     {
-        return zip_file_to_buf(filename + 1, entry->path, buf); //the first character will always be '/' because of the other case
+        return stream_open_zip(stream, filename + 1, path);
     }
     else
     {
-        u16 path[0x106] = {0};
-        strucat(path, entry->path);
         struacat(path, filename);
 
-        return file_to_buf(fsMakePath(PATH_UTF16, path), ArchiveSD, buf);
+        return stream_open_file(stream, path, PLATFORM_ARCHIVE_SD);
     }
 }
 
+int get_icon_slot(const Entry_List_s * list, int index)
+{
+    // lists that keep every icon never move the ring
+    if(list->icons_head == 0)
+        return index;
+
+    const int slots = list->entries_loaded * ICONS_OFFSET_AMOUNT;
+    return (list->icons_head + index) % slots;
+}
+
 C2D_Image get_icon_at(Entry_List_s * list, size_t index)
 {
     return (C2D_Image){
         .tex = &list->icons_texture,
-        .subtex = &list->icons_info[index].subtex,
+        .subtex = &list->icons_info[get_icon_slot(list, index)].subtex,
     };
 }
 
-static int compare_entries_base(const Entry_s * const a, const Entry_s * const b)
+bool icon_ready_at(const Entry_List_s * list, size_t index)
+{
+    return list->icon_cells == NULL || list->icon_cells[get_icon_slot(list, index)].state == ICON_CELL_LOADED;
+}
+
+// a page in the swap file is ENTRIES_PAGE_SIZE of these, with the strings of the entries in them
+typedef struct Entry_Record_s {
+    Entry_s entry; // without the name, description and author, the path and folder stay in the list
+    bool has_strings;
+    bool name_is_path; // while the info is pending
+    u16 name[0x40];
+    u16 desc[0x80];
+    u16 author[0x40];
+} Entry_Record_s;
+
+static Entry_s unreadable_entry;
+
+static void get_swap_path(u16 * out, EntryMode mode)
+{
+    char path[0x80];
+    sprintf(path, "/3ds/" APP_TITLE "/cache/entries_%d.bin", mode);
+    out[0] = 0;
+    struacat(out, path);
+}
+
+static bool is_swapped_out(const Entry_Page_s * page)
+{
+    return __atomic_load_n(&page->entries, __ATOMIC_ACQUIRE) == NULL;
+}
+
+// like get_entry_at, without making the page look used: for going through every entry
+static Entry_s * peek_entry_at(const Entry_List_s * list, int id)
+{
+    Entry_s * const entries = __atomic_load_n(&list->entries[id >> ENTRIES_PAGE_SHIFT].entries, __ATOMIC_ACQUIRE);
+    return entries != NULL ? &entries[id & (ENTRIES_PAGE_SIZE - 1)] : list_read_entry(list, id);
+}
+
+static int entries_in_page(const Entry_List_s * list, int page_index)
+{
+    return max(0, min(ENTRIES_PAGE_SIZE, list->entries_count - (page_index << ENTRIES_PAGE_SHIFT)));
+}
+
+static void copy_record_string(u16 * out, const u16 * str, size_t max_len)
+{
+    if(str != NULL)
+        memcpy(out, str, strulen(str, max_len) * sizeof(u16));
+}
+
+static void write_record(const Entry_s * entry, Entry_Record_s * record)
+{
+    memset(record, 0, sizeof(Entry_Record_s));
+    memcpy(&record->entry, entry, sizeof(Entry_s));
+    // they point to the arena of the page, which is somewhere else every time it's read back
+    record->entry.name = NULL;
+    record->entry.desc = NULL;
+    record->entry.author = NULL;
+
+    record->has_strings = entry->name != NULL;
+    record->name_is_path = entry->name == entry->path;
+    if(!record->name_is_path)
+        copy_record_string(record->name, entry->name, 0x40);
+    copy_record_string(record->desc, entry->desc, 0x80);
+    copy_record_string(record->author, entry->author, 0x40);
+}
+
+static void read_record(const Entry_Record_s * record, Entry_s * entry, String_Arena_s * strings)
+{
+    memcpy(entry, &record->entry, sizeof(Entry_s));
+    if(!record->has_strings)
+        return;
+
+    entry->name = record->name_is_path ? entry->path : arena_add(strings, record->name, strulen(record->name, 0x40));
+    entry->desc = arena_add(strings, record->desc, strulen(record->desc, 0x80));
+    entry->author = arena_add(strings, record->author, strulen(record->author, 0x40));
+}
+
+// FNV-1a, a word at a time: a page is hashed every time it's swapped out
+static u64 hash_records(const Entry_Record_s * records, int count)
+{
+    const u8 * const data = (const u8 *)records;
+    const size_t size = count * sizeof(Entry_Record_s);
+    u64 hash = 14695981039346656037ull;
+    size_t i = 0;
+    for(; i + sizeof(u64) <= size; i += sizeof(u64))
+    {
+        u64 word;
+        memcpy(&word, data + i, sizeof(u64));
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+    for(; i < size; i++)
+        hash = (hash ^ data[i]) * 1099511628211ull;
+    return hash;
+}
+
+// pages_lock has to be held
+static bool open_swap_file(Entry_List_s * list)
+{
+    if(list->swap_opened)
+        return true;
+
+    if(list->records == NULL)
+        list->records = malloc(ENTRIES_PAGE_SIZE * sizeof(Entry_Record_s));
+    if(list->records == NULL)
+        return false;
+
+    // whatever a previous run left in it is never read, only the pages written since
+    u16 path[0x80];
+    get_swap_path(path, list->mode);
+    Result res = platform_file_open(&list->swap_file, PLATFORM_ARCHIVE_SD, path, PLATFORM_OPEN_READ | PLATFORM_OPEN_WRITE);
+    if(R_FAILED(res))
+    {
+        platform_file_create(PLATFORM_ARCHIVE_SD, path, 0);
+        res = platform_file_open(&list->swap_file, PLATFORM_ARCHIVE_SD, path, PLATFORM_OPEN_READ | PLATFORM_OPEN_WRITE);
+    }
+    if(R_FAILED(res))
+    {
+        DEBUG("Failed to open the swap file of list %d: 0x%08lx\n", list->mode, res);
+        return false;
+    }
+
+    list->swap_opened = true;
+    return true;
+}
+
+// into records, pages_lock has to be held
+static bool read_records(Entry_List_s * list, int page_index)
+{
+    const u32 size = list->entries[page_index].records_count * sizeof(Entry_Record_s);
+    u32 read = 0;
+    return list->swap_opened && R_SUCCEEDED(platform_file_read(list->swap_file, (u64)page_index * ENTRIES_PAGE_SIZE * sizeof(Entry_Record_s), list->records, size, &read)) && read == size;
+}
+
+// from records, the entries past the ones that were written are empty
+static void read_page(const Entry_List_s * list, int page_index, Entry_s * entries, String_Arena_s * strings)
+{
+    const int count = list->entries[page_index].records_count;
+    for(int i = 0; i < count; i++)
+        read_record(&list->records[i], &entries[i], strings);
+    memset(entries + count, 0, (ENTRIES_PAGE_SIZE - count) * sizeof(Entry_s));
+}
+
+// pages_lock has to be held
+static bool swap_in_page(Entry_List_s * list, int page_index)
+{
+    Entry_Page_s * const page = &list->entries[page_index];
+    Entry_s * const entries = malloc(ENTRIES_PAGE_SIZE * sizeof(Entry_s));
+    if(entries == NULL || !read_records(list, page_index))
+    {
+        free(entries);
+        return false;
+    }
+
+    read_page(list, page_index, entries, &page->strings);
+    page->hash = hash_records(list->records, page->records_count);
+    list->resident_pages++;
+    // get_entry_at looks at it without pages_lock
+    __atomic_store_n(&page->entries, entries, __ATOMIC_RELEASE);
+    return true;
+}
+
+// the records are only written if they changed since the page was read back
+static bool swap_out_page(Entry_List_s * list, int page_index)
+{
+    Entry_Page_s * const page = &list->entries[page_index];
+    const int count = entries_in_page(list, page_index);
+    platform_mutex_lock(&list->pages_lock);
+    if(!open_swap_file(list))
+    {
+        platform_mutex_unlock(&list->pages_lock);
+        return false;
+    }
+
+    page->any_pending = false;
+    page->any_marked = false;
+    for(int i = 0; i < count; i++)
+    {
+        const Entry_s * const entry = &page->entries[i];
+        write_record(entry, &list->records[i]);
+        page->any_pending |= entry->info_pending;
+        page->any_marked |= entry->installed || entry->in_shuffle;
+    }
+
+    const u64 hash = hash_records(list->records, count);
+    if(!page->in_file || page->records_count != count || page->hash != hash)
+    {
+        const u32 size = count * sizeof(Entry_Record_s);
+        u32 written = 0;
+        page->in_file = false;
+        if(R_FAILED(platform_file_write(list->swap_file, (u64)page_index * ENTRIES_PAGE_SIZE * sizeof(Entry_Record_s), list->records, size, &written)) || written != size)
+        {
+            platform_mutex_unlock(&list->pages_lock);
+            return false;
+        }
+
+        page->hash = hash;
+        page->records_count = count;
+        page->in_file = true;
+    }
+
+    Entry_s * const entries = page->entries;
+    __atomic_store_n(&page->entries, NULL, __ATOMIC_RELEASE);
+    free(entries);
+    arena_free(&page->strings);
+    list->resident_pages--;
+    platform_mutex_unlock(&list->pages_lock);
+    return true;
+}
+
+// swaps out the least recently used pages that weren't used since the last time, until there are only
+// ENTRIES_RESIDENT_PAGES left, or only pinned ones. On the main thread, with info_lock held
+static void trim_pages(Entry_List_s * list)
+{
+    const int pages = list->entries_capacity >> ENTRIES_PAGE_SHIFT;
+    while(list->resident_pages > ENTRIES_RESIDENT_PAGES)
+    {
+        int oldest = -1;
+        for(int i = 0; i < pages; i++)
+        {
+            const Entry_Page_s * const page = &list->entries[i];
+            if(page->entries == NULL || page->pinned || page->last_used == list->pages_clock)
+                continue;
+            if(oldest < 0 || page->last_used < list->entries[oldest].last_used)
+                oldest = i;
+        }
+
+        if(oldest < 0 || !swap_out_page(list, oldest))
+            break;
+    }
+
+    list->pages_clock++;
+}
+
+Entry_s * list_read_entry(const Entry_List_s * const_list, int id)
+{
+    // the pages are a cache of the swap file, reading one back doesn't change what's in the list
+    Entry_List_s * const list = (Entry_List_s *)const_list;
+    Entry_Page_s * const page = &list->entries[id >> ENTRIES_PAGE_SHIFT];
+    platform_mutex_lock(&list->pages_lock);
+    // another thread may have read it back in the meantime
+    if(page->entries == NULL && !swap_in_page(list, id >> ENTRIES_PAGE_SHIFT))
+    {
+        platform_mutex_unlock(&list->pages_lock);
+        DEBUG("Failed to read entry %d back\n", id);
+        // out of memory: what's done to it is lost, but whoever asked for it has something to look at
+        memset(&unreadable_entry, 0, sizeof(Entry_s));
+        unreadable_entry.path = unreadable_entry.name = unreadable_entry.desc = unreadable_entry.author = (const u16 *)u"";
+        unreadable_entry.folder = "";
+        unreadable_entry.id = id;
+        return &unreadable_entry;
+    }
+
+    page->last_used = list->pages_clock;
+    platform_mutex_unlock(&list->pages_lock);
+    return &page->entries[id & (ENTRIES_PAGE_SIZE - 1)];
+}
+
+String_Arena_s * list_entry_strings(Entry_List_s * list, const Entry_s * entry)
+{
+    return &list->entries[entry->id >> ENTRIES_PAGE_SHIFT].strings;
+}
+
+static void pin_entry(Entry_List_s * list, int id)
+{
+    if(id >= 0 && id < list->entries_count)
+        list->entries[id >> ENTRIES_PAGE_SHIFT].pinned = true;
+}
+
+void list_trim(Entry_List_s * list)
+{
+    if(list->entries == NULL)
+        return;
+
+    platform_mutex_lock(&list->info_lock);
+    if(list->resident_pages <= ENTRIES_RESIDENT_PAGES)
+    {
+        list->pages_clock++;
+        platform_mutex_unlock(&list->info_lock);
+        return;
+    }
+
+    // the entries the main thread keeps pointers to, see loading.c
+    const int count = list_get_count(list);
+    const int ring = list->entries_loaded * ICONS_OFFSET_AMOUNT;
+    const int ring_start = list->scroll - list->entries_loaded * ICONS_VISIBLE;
+    for(int i = 0; i < ring && count != 0; i++)
+        pin_entry(list, list_get_id(list, ((ring_start + i) % count + count) % count));
+    if(list->selected_entry < count)
+        pin_entry(list, list_get_id(list, list->selected_entry));
+    for(int i = 0; i < list->icons_spare; i++)
+    {
+        if(list->prefetch_slots[i].position >= 0 && list->prefetch_slots[i].position < count)
+            pin_entry(list, list_get_id(list, list->prefetch_slots[i].position));
+    }
+    for(int i = 0; i < ring + list->icons_spare && list->icon_cells != NULL; i++)
+    {
+        if(list->icon_cells[i].state != ICON_CELL_EMPTY)
+            pin_entry(list, list->icon_cells[i].id);
+    }
+
+    trim_pages(list);
+
+    for(int i = 0; i < (list->entries_capacity >> ENTRIES_PAGE_SHIFT); i++)
+        list->entries[i].pinned = false;
+    platform_mutex_unlock(&list->info_lock);
+}
+
+void list_walk_start(Entry_Walk_s * walk, Entry_List_s * list)
+{
+    memset(walk, 0, sizeof(Entry_Walk_s));
+    walk->list = list;
+    walk->page = -1;
+}
+
+const Entry_s * list_walk_entry(Entry_Walk_s * walk, int id)
+{
+    Entry_List_s * const list = walk->list;
+    const int page_index = id >> ENTRIES_PAGE_SHIFT;
+    if(page_index != walk->page)
+    {
+        walk->page = page_index;
+        arena_free(&walk->strings);
+        platform_mutex_lock(&list->pages_lock);
+        walk->entries = list->entries[page_index].entries;
+        if(walk->entries == NULL)
+        {
+            if(walk->buffer == NULL)
+                walk->buffer = malloc(ENTRIES_PAGE_SIZE * sizeof(Entry_s));
+            if(walk->buffer != NULL && read_records(list, page_index))
+            {
+                read_page(list, page_index, walk->buffer, &walk->strings);
+                walk->entries = walk->buffer;
+            }
+        }
+        platform_mutex_unlock(&list->pages_lock);
+    }
+
+    // without room for the page, the list reads it back
+    if(walk->entries == NULL)
+        return get_entry_at(list, id);
+    return &walk->entries[id & (ENTRIES_PAGE_SIZE - 1)];
+}
+
+void list_walk_end(Entry_Walk_s * walk)
+{
+    free(walk->buffer);
+    arena_free(&walk->strings);
+    memset(walk, 0, sizeof(Entry_Walk_s));
+}
+
+// the first characters of the string the entries are sorted by, case folded, so most comparisons don't have to look at the rest
+#define SORT_KEY_PREFIX 6
+typedef struct {
+    u16 filled; // entries without info (placeholder_color != 0) go last
+    u16 prefix[SORT_KEY_PREFIX];
+    u32 id; // also breaks ties, so the entries that compare the same stay in the order they were found in
+    const u16 * rest; // of the string, past the prefix
+} Sort_Key_s;
+
+static const u16 * get_sort_string(const Entry_s * entry, SortMode mode)
+{
+    const u16 * str = mode == SORT_NAME ? entry->name : mode == SORT_AUTHOR ? entry->author : entry->path;
+    return str != NULL ? str : (const u16 *)u"";
+}
+
+static int compare_keys(const Sort_Key_s * a, const Sort_Key_s * b)
+{
+    if(a->filled != b->filled)
+        return (int)a->filled - (int)b->filled;
+
+    for(int i = 0; i < SORT_KEY_PREFIX; i++)
+    {
+        if(a->prefix[i] != b->prefix[i])
+            return (int)a->prefix[i] - (int)b->prefix[i];
+        if(a->prefix[i] == 0)
+            return (int)a->id - (int)b->id;
+    }
+
+    // same prefix, the rest of the strings decide
+    const u16 * str_a = a->rest;
+    const u16 * str_b = b->rest;
+    while(*str_a && fold_case(*str_a) == fold_case(*str_b))
+    {
+        str_a++;
+        str_b++;
+    }
+    if(*str_a != *str_b)
+        return (int)fold_case(*str_a) - (int)fold_case(*str_b);
+
+    return (int)a->id - (int)b->id;
+}
+
+// bottom-up merge sort, returns whichever of the two buffers ends up holding the sorted keys
+static Sort_Key_s * sort_keys(Sort_Key_s * keys, Sort_Key_s * temp, u32 count)
+{
+    for(u32 width = 1; width < count; width *= 2)
+    {
+        for(u32 left = 0; left < count; left += 2 * width)
+        {
+            const u32 middle = min(left + width, count);
+            const u32 right = min(left + 2 * width, count);
+            u32 i = left, j = middle, k = left;
+            while(i < middle && j < right)
+                temp[k++] = compare_keys(&keys[j], &keys[i]) < 0 ? keys[j++] : keys[i++];
+            while(i < middle)
+                temp[k++] = keys[i++];
+            while(j < right)
+                temp[k++] = keys[j++];
+        }
+
+        Sort_Key_s * const swap = keys;
+        keys = temp;
+        temp = swap;
+    }
+
+    return keys;
+}
+
+// with rests, the rest of the string is copied there: the entry may be in a page that gets swapped out
+static void make_sort_key(const Entry_s * entry, SortMode mode, Sort_Key_s * key, String_Arena_s * rests)
+{
+    memset(key, 0, sizeof(Sort_Key_s));
+    key->filled = entry->placeholder_color != 0;
+    key->id = entry->id;
+
+    const u16 * str = get_sort_string(entry, mode);
+    int len = 0;
+    for(; len < SORT_KEY_PREFIX && str[len] != 0; len++)
+        key->prefix[len] = fold_case(str[len]);
+
+    // the paths stay in the list
+    key->rest = str + len;
+    if(rests != NULL && mode != SORT_PATH && *key->rest != 0)
+        key->rest = arena_add(rests, key->rest, strulen(key->rest, 0x106));
+}
+
+// fills order with the ids of the entries in sorted order
+static bool make_sort_order(Entry_List_s * list, SortMode mode, u32 * order)
+{
+    const u32 count = list->entries_count;
+    Sort_Key_s * keys = malloc(2 * count * sizeof(Sort_Key_s));
+    if(keys == NULL)
+        return false;
+
+    String_Arena_s rests = {0};
+    Entry_Walk_s walk;
+    list_walk_start(&walk, list);
+    for(u32 id = 0; id < count; id++)
+        make_sort_key(list_walk_entry(&walk, id), mode, &keys[id], &rests);
+    list_walk_end(&walk);
+
+    const Sort_Key_s * sorted = sort_keys(keys, keys + count, count);
+    for(u32 i = 0; i < count; i++)
+        order[i] = sorted[i].id;
+
+    arena_free(&rests);
+    free(keys);
+    return true;
+}
+
+// the order the list is in is kept from the first sort on
+static bool make_order(Entry_List_s * list)
+{
+    if(list->order != NULL)
+        return true;
+
+    list->order = malloc(max(list->entries_capacity, 1) * sizeof(u32));
+    if(list->order == NULL)
+        return false;
+
+    for(int i = 0; i < list->entries_count; i++)
+        list->order[i] = i;
+    return true;
+}
+
+static int compare_view_indexes(const void * a, const void * b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+static void sort_list(Entry_List_s * list, SortMode mode)
+{
+    if(list->entries == NULL || list->entries_count == 0)
+        return;
+
+    platform_mutex_lock(&list->info_lock);
+
+    const u32 count = list->entries_count;
+    if(list->sort_orders[mode] == NULL || list->sort_generations[mode] != list->info_generation)
+    {
+        u32 * order = realloc(list->sort_orders[mode], count * sizeof(u32));
+        if(order == NULL || !make_sort_order(list, mode, order))
+        {
+            free(order != NULL ? order : list->sort_orders[mode]);
+            list->sort_orders[mode] = NULL;
+            goto end;
+        }
+        list->sort_orders[mode] = order;
+        list->sort_generations[mode] = list->info_generation;
+    }
+
+    if(!make_order(list))
+        goto end;
+
+    if(list->view != NULL)
+    {
+        // the view follows the entries to their new positions
+        u32 * const positions = malloc(count * sizeof(u32));
+        if(positions == NULL)
+            goto end;
+
+        for(u32 i = 0; i < count; i++)
+            positions[list->sort_orders[mode][i]] = i;
+        for(int i = 0; i < list->view_count; i++)
+            list->view[i] = positions[list->order[list->view[i]]];
+        qsort(list->view, list->view_count, sizeof(int), compare_view_indexes);
+        free(positions);
+    }
+
+    // only the ids move, the entries stay in their pages
+    memcpy(list->order, list->sort_orders[mode], count * sizeof(u32));
+
+    end:
+    list->info_parsed = 0;
+    platform_mutex_unlock(&list->info_lock);
+}
+
+int list_get_count(const Entry_List_s * list)
+{
+    return list->view != NULL ? list->view_count : list->entries_count;
+}
+
+int list_get_id(const Entry_List_s * list, int index)
 {
-    // entry->placeholder_color == 0 means it is not filled (no name, author, description)
-    // if a is filled and b is filled, return == 0
-    // if a is not filled and b is not filled, return == 0
-    // if a is not filled, return < 0
-    // if b is an unfilled entry, return > 0
-    return ((int)(a->placeholder_color != 0)) - ((int)(b->placeholder_color != 0));
+    return list_id_at(list, list->view != NULL ? list->view[index] : index);
 }
 
-typedef int (*sort_comparator)(const void *, const void *);
-static int compare_entries_by_name(const void * a, const void * b)
+Entry_s * list_get_entry(const Entry_List_s * list, int index)
 {
-    const Entry_s * const entry_a = (const Entry_s *)a;
-    const Entry_s * const entry_b = (const Entry_s *)b;
-    const int base = compare_entries_base(entry_a, entry_b);
-    if(base)
-        return base;
+    return get_entry_at(list, list_get_id(list, index));
+}
+
+void list_clear_view(Entry_List_s * list)
+{
+    free(list->view);
+    list->view = NULL;
+    list->view_count = 0;
+}
+
+Entry_Ref_s * list_snapshot(Entry_List_s * list, int * count)
+{
+    platform_mutex_lock(&list->info_lock);
+    *count = list->entries_count;
+    Entry_Ref_s * refs = *count ? malloc(*count * sizeof(Entry_Ref_s)) : NULL;
+    if(refs == NULL)
+        *count = 0;
+
+    Entry_Walk_s walk;
+    list_walk_start(&walk, list);
+    for(int i = 0; i < *count; i++)
+    {
+        const Entry_s * entry = list_walk_entry(&walk, i);
+        refs[i].path = entry->path;
+        refs[i].folder = entry->folder;
+        refs[i].id = entry->id;
+        refs[i].is_zip = entry->is_zip;
+    }
+    list_walk_end(&walk);
+    platform_mutex_unlock(&list->info_lock);
+    return refs;
+}
+
+void list_set_installed(Entry_List_s * list, const Entry_Ref_s * ref)
+{
+    platform_mutex_lock(&list->info_lock);
+    if(ref->id < (u32)list->entries_count)
+    {
+        Entry_s * entry = get_entry_at(list, ref->id);
+        if(entry->path == ref->path)
+            entry->installed = true;
+    }
+    platform_mutex_unlock(&list->info_lock);
+}
+
+void list_mark_installed(Entry_List_s * list, const Entry_s * installed)
+{
+    platform_mutex_lock(&list->info_lock);
+    for(int id = 0; id < list->entries_count; id++)
+    {
+        // nothing to change in the swapped out pages that have nothing marked
+        const Entry_Page_s * const page = &list->entries[id >> ENTRIES_PAGE_SHIFT];
+        if(is_swapped_out(page) && !page->any_marked)
+        {
+            id |= ENTRIES_PAGE_SIZE - 1;
+            continue;
+        }
+
+        Entry_s * const entry = peek_entry_at(list, id);
+        if(installed != NULL)
+        {
+            entry->installed = entry == installed;
+        }
+        else
+        {
+            entry->installed = entry->in_shuffle;
+            entry->in_shuffle = false;
+        }
+    }
+    platform_mutex_unlock(&list->info_lock);
+}
+
+int list_get_shuffle(Entry_List_s * list, Entry_s * shuffle, int max)
+{
+    int count = 0;
+    platform_mutex_lock(&list->info_lock);
+    for(int id = 0; id < list->entries_count; id++)
+    {
+        const Entry_Page_s * const page = &list->entries[id >> ENTRIES_PAGE_SHIFT];
+        if(is_swapped_out(page) && !page->any_marked)
+        {
+            id |= ENTRIES_PAGE_SIZE - 1;
+            continue;
+        }
 
-    return memcmp(entry_a->name, entry_b->name, 0x40 * sizeof(u16));
+        const Entry_s * const entry = peek_entry_at(list, id);
+        if(!entry->in_shuffle)
+            continue;
+
+        if(count < max)
+            shuffle[count] = *entry;
+        count++;
+    }
+    platform_mutex_unlock(&list->info_lock);
+    return count;
 }
-static int compare_entries_by_author(const void * a, const void * b)
+
+int list_next_pending(Entry_List_s * list, int id)
 {
-    const Entry_s * const entry_a = (const Entry_s *)a;
-    const Entry_s * const entry_b = (const Entry_s *)b;
-    const int base = compare_entries_base(entry_a, entry_b);
-    if(base)
-        return base;
+    const int count = list->entries_count;
+    if(id >= count)
+        id = 0;
+
+    for(int seen = 0; seen < count;)
+    {
+        const Entry_Page_s * const page = &list->entries[id >> ENTRIES_PAGE_SHIFT];
+        if(is_swapped_out(page) && !page->any_pending)
+        {
+            const int skipped = min(ENTRIES_PAGE_SIZE - (id & (ENTRIES_PAGE_SIZE - 1)), count - id);
+            seen += skipped;
+            id += skipped;
+        }
+        else
+        {
+            if(peek_entry_at(list, id)->info_pending)
+                return id;
+            seen++;
+            id++;
+        }
+
+        if(id >= count)
+            id = 0;
+    }
+
+    return -1;
+}
+
+static int find_position(const Entry_List_s * list, int id)
+{
+    if(list->order == NULL)
+        return id;
+
+    int position = 0;
+    while(position < list->entries_count - 1 && list->order[position] != (u32)id)
+        position++;
+    return position;
+}
+
+// moves the entry with id to where the current sort puts it, the others being in order already. Returns its position
+static int move_to_sorted_position(Entry_List_s * list, int id)
+{
+    // without a sort, it stays where it was found
+    if(list->current_sort <= SORT_NONE || list->current_sort >= SORT_AMOUNT || !make_order(list))
+        return find_position(list, id);
+
+    const int last = list->entries_count - 1;
+    const int index = find_position(list, id);
+    memmove(&list->order[index], &list->order[index + 1], (last - index) * sizeof(u32));
+
+    // the pages read back for the comparisons stay until the next list_trim
+    Sort_Key_s moved_key, key;
+    make_sort_key(get_entry_at(list, id), list->current_sort, &moved_key, NULL);
+    int low = 0, high = last;
+    while(low < high)
+    {
+        const int middle = low + (high - low) / 2;
+        make_sort_key(get_entry_at(list, list->order[middle]), list->current_sort, &key, NULL);
+        if(compare_keys(&moved_key, &key) < 0)
+            high = middle;
+        else
+            low = middle + 1;
+    }
 
-    return memcmp(entry_a->author, entry_b->author, 0x40 * sizeof(u16));
+    memmove(&list->order[low + 1], &list->order[low], (last - low) * sizeof(u32));
+    list->order[low] = id;
+
+    // everything in between shifted by one
+    for(int i = 0; i < list->view_count; i++)
+    {
+        int position = list->view[i];
+        if(position == index)
+        {
+            position = low;
+        }
+        else
+        {
+            if(position > index)
+                position--;
+            if(position >= low)
+                position++;
+        }
+        list->view[i] = position;
+    }
+    if(list->view != NULL)
+        qsort(list->view, list->view_count, sizeof(int), compare_view_indexes);
+
+    return low;
 }
-static int compare_entries_by_filename(const void * a, const void * b)
+
+ssize_t list_insert_zip(Entry_List_s * list, const u16 * name, u64 size)
 {
-    const Entry_s * const entry_a = (const Entry_s *)a;
-    const Entry_s * const entry_b = (const Entry_s *)b;
-    const int base = compare_entries_base(entry_a, entry_b);
-    if(base)
-        return base;
+    if(list->entries == NULL)
+        return -1;
+
+    const size_t name_len = strulen(name, 0x105);
+    const int count = list_get_count(list);
+    const int selected_id = list->selected_entry < count ? list_get_id(list, list->selected_entry) : -1;
+
+    platform_mutex_lock(&list->info_lock);
+
+    // a zip that was overwritten is already there, only what's in it changed
+    int id = -1;
+    for(int i = 0; i < list->entries_count && id < 0; i++)
+    {
+        const u16 * path = list->paths[i];
+        if(strulen(path, name_len + 1) == name_len && !memcmp(path, name, name_len * sizeof(u16)) && get_entry_at(list, i)->folder == list->loading_path)
+            id = i;
+    }
+
+    if(id < 0)
+    {
+        id = list_add_entry(list);
+        if(id < 0)
+        {
+            platform_mutex_unlock(&list->info_lock);
+            return -1;
+        }
+
+        Entry_s * const new_entry = get_entry_at(list, id);
+        memset(new_entry, 0, sizeof(Entry_s));
+        new_entry->id = id;
+        new_entry->path = arena_add(&list->strings, name, name_len);
+        new_entry->folder = list->loading_path;
+        new_entry->is_zip = true;
+        list->paths[id] = new_entry->path;
+    }
+
+    Entry_s * const entry = get_entry_at(list, id);
+    icon_cache_forget(entry);
+    icon_atlas_forget(&list->icon_atlas, entry);
+    entry->file_size = size;
+    u16 path[0x106] = {0};
+    entry_get_path(entry, path);
+    platform_file_get_mtime(PLATFORM_ARCHIVE_SD, path, &entry->mtime);
+
+    char * info_buffer = NULL;
+    u32 info_size = load_pooled_data("/info.smdh", entry, &info_buffer);
+    parse_smdh(info_size == sizeof(Icon_s) ? (Icon_s *)info_buffer : NULL, entry, entry->path, list_entry_strings(list, entry));
+    entry->info_pending = false;
+    pool_free(info_buffer);
+
+    const int position = move_to_sorted_position(list, id);
+    list->info_generation++;
+
+    const int new_count = list_get_count(list);
+    for(int i = 0; i < new_count && selected_id >= 0; i++)
+    {
+        if(list_get_id(list, i) == selected_id)
+        {
+            list->selected_entry = i;
+            list->previous_selected = i;
+            break;
+        }
+    }
+    if(list->selected_entry >= list->scroll + list->entries_loaded)
+        list->scroll = list->selected_entry - list->entries_loaded + 1;
+    list->previous_scroll = list->scroll;
 
-    return memcmp(entry_a->path, entry_b->path, 0x106 * sizeof(u16));
+    // otherwise, the info thread saves it once it's done
+    if(!list->info_loading)
+        entries_index_save(list);
+
+    platform_mutex_unlock(&list->info_lock);
+    return position;
 }
 
-static void sort_list(Entry_List_s * list, sort_comparator compare_entries)
+void free_sort_orders(Entry_List_s * list)
 {
-    if(list->entries != NULL && list->entries != NULL)
-        qsort(list->entries, list->entries_count, sizeof(Entry_s), compare_entries); //alphabet sort
+    for(int i = 0; i < SORT_AMOUNT; i++)
+    {
+        free(list->sort_orders[i]);
+        list->sort_orders[i] = NULL;
+    }
 }
 
 void sort_by_name(Entry_List_s * list)
 {
-    sort_list(list, compare_entries_by_name);
+    sort_list(list, SORT_NAME);
     list->current_sort = SORT_NAME;
 }
 void sort_by_author(Entry_List_s * list)
 {
-    sort_list(list, compare_entries_by_author);
+    sort_list(list, SORT_AUTHOR);
     list->current_sort = SORT_AUTHOR;
 }
 void sort_by_filename(Entry_List_s * list)
 {
-    sort_list(list, compare_entries_by_filename);
+    sort_list(list, SORT_PATH);
     list->current_sort = SORT_PATH;
 }
 
-#define LOADING_DIR_ENTRIES_COUNT 16
-static FS_DirectoryEntry loading_dir_entries[LOADING_DIR_ENTRIES_COUNT];
-Result load_entries(const char * loading_path, Entry_List_s * list, const InstallType loading_screen)
+void resort_list(Entry_List_s * list)
 {
-    Handle dir_handle;
-    Result res = FSUSER_OpenDirectory(&dir_handle, ArchiveSD, fsMakePath(PATH_ASCII, loading_path));
-    if(R_FAILED(res))
+    const int count = list_get_count(list);
+    if(list->entries == NULL || list->selected_entry >= count)
+        return;
+
+    // the entries don't move, only their ids do
+    const int selected_id = list_get_id(list, list->selected_entry);
+    const int selected_row = list->selected_entry - list->scroll;
+
+    switch(list->current_sort)
     {
-        DEBUG("Failed to open folder: %s\n", loading_path);
-        return res;
+        case SORT_NAME:
+            sort_by_name(list);
+            break;
+        case SORT_AUTHOR:
+            sort_by_author(list);
+            break;
+        case SORT_PATH:
+            sort_by_filename(list);
+            break;
+        default:
+            list->info_parsed = 0;
+            return;
+    }
+
+    for(int i = 0; i < count; i++)
+    {
+        if(list_get_id(list, i) == selected_id)
+        {
+            list->selected_entry = i;
+            break;
+        }
+    }
+
+    list->scroll = list->selected_entry - selected_row;
+    if(list->scroll > count - list->entries_loaded)
+        list->scroll = count - list->entries_loaded;
+    if(list->scroll < 0)
+        list->scroll = 0;
+    list->previous_scroll = list->scroll;
+    list->previous_selected = list->selected_entry;
+}
+
+// the folders are read in batches that grow while they keep coming back full,
+// and each entry is handed to workers to get its modification time, which is a trip to the SD,
+// while the next batch is being read. A folder without an info.smdh that only holds folders and zips
+// is a category: the workers hand it back, and its entries get added to the list like the others
+#define LOADING_DIR_ENTRIES_MIN 16
+#define LOADING_DIR_ENTRIES_MAX 64
+#define LOADING_CATEGORY_DIR_ENTRIES 8
+#define LOADING_QUEUE_SIZE 256
+#define LOADING_WORKERS_MAX 4
+#define LOADING_WORKER_STACK_SIZE 0x4000
+static Platform_Dir_Entry_s loading_dir_entries[LOADING_DIR_ENTRIES_MAX];
+
+typedef struct {
+    Entry_s * entries[LOADING_QUEUE_SIZE];
+    u32 head, tail; // taken from the head, added at the tail
+    int busy; // workers with an entry taken
+    bool done;
+
+    int * categories; // ids of the ones found and not listed yet
+    int categories_count;
+    int categories_capacity;
+
+    Platform_Mutex lock;
+    Platform_Event not_empty;
+    Platform_Event not_full;
+    Platform_Event progress; // an entry is done
+} Loading_Queue_s;
+
+static bool is_category(const Entry_s * entry)
+{
+    u16 path[0x106] = {0};
+    entry_get_path(entry, path);
+    Platform_Dir dir_handle;
+    if(R_FAILED(platform_dir_open(&dir_handle, PLATFORM_ARCHIVE_SD, path)))
+        return false;
+
+    Platform_Dir_Entry_s dir_entries[LOADING_CATEGORY_DIR_ENTRIES];
+    bool any_entry = false, only_entries = true;
+    u32 entries_read = 0;
+    while(only_entries && R_SUCCEEDED(platform_dir_read(dir_handle, dir_entries, LOADING_CATEGORY_DIR_ENTRIES, &entries_read)) && entries_read != 0)
+    {
+        for(u32 i = 0; i < entries_read; i++)
+        {
+            const Platform_Dir_Entry_s * const dir_entry = &dir_entries[i];
+            // what computers leave around doesn't count
+            if(dir_entry->is_hidden || dir_entry->name[0] == '.')
+                continue;
+
+            if(dir_entry->is_directory || !strcmp(dir_entry->short_ext, "ZIP"))
+                any_entry = true;
+            else
+                only_entries = false;
+        }
+    }
+
+    platform_dir_close(dir_handle);
+    return any_entry && only_entries;
+}
+
+static void probe_entry(Loading_Queue_s * queue, Entry_s * entry)
+{
+    u16 path[0x106] = {0};
+    entry_get_path(entry, path);
+    if(!entry->is_zip)
+        struacat(path, "/info.smdh");
+    const Result res = platform_file_get_mtime(PLATFORM_ARCHIVE_SD, path, &entry->mtime);
+    if(R_SUCCEEDED(res) || entry->is_zip || !is_category(entry))
+        return;
+
+    platform_mutex_lock(&queue->lock);
+    if(queue->categories_count == queue->categories_capacity)
+    {
+        const int next_capacity = max(queue->categories_capacity * 2, 8);
+        int * const new_categories = realloc(queue->categories, next_capacity * sizeof(int));
+        if(new_categories != NULL)
+        {
+            queue->categories = new_categories;
+            queue->categories_capacity = next_capacity;
+        }
+    }
+    // otherwise, it stays an entry
+    if(queue->categories_count < queue->categories_capacity)
+    {
+        entry->is_category = true;
+        queue->categories[queue->categories_count++] = entry->id;
+    }
+    platform_mutex_unlock(&queue->lock);
+}
+
+static void loading_worker(void * void_arg)
+{
+    Loading_Queue_s * queue = (Loading_Queue_s *)void_arg;
+
+    platform_mutex_lock(&queue->lock);
+    while(queue->head != queue->tail || !queue->done)
+    {
+        if(queue->head == queue->tail)
+        {
+            platform_mutex_unlock(&queue->lock);
+            platform_event_wait(&queue->not_empty);
+            platform_mutex_lock(&queue->lock);
+            continue;
+        }
+
+        Entry_s * const entry = queue->entries[queue->head++ % LOADING_QUEUE_SIZE];
+        queue->busy++;
+        // a signal only wakes one worker, which passes it on if there's more to do
+        if(queue->head != queue->tail)
+            platform_event_signal(&queue->not_empty);
+        platform_mutex_unlock(&queue->lock);
+        platform_event_signal(&queue->not_full);
+
+        probe_entry(queue, entry);
+
+        platform_mutex_lock(&queue->lock);
+        queue->busy--;
+        platform_event_signal(&queue->progress);
+    }
+    platform_mutex_unlock(&queue->lock);
+
+    // so the next worker sees it's done too
+    platform_event_signal(&queue->not_empty);
+}
+
+static void loading_queue_push(Loading_Queue_s * queue, Entry_s * entry)
+{
+    platform_mutex_lock(&queue->lock);
+    while(queue->tail - queue->head == LOADING_QUEUE_SIZE)
+    {
+        platform_mutex_unlock(&queue->lock);
+        platform_event_wait(&queue->not_full);
+        platform_mutex_lock(&queue->lock);
     }
+    queue->entries[queue->tail++ % LOADING_QUEUE_SIZE] = entry;
+    platform_mutex_unlock(&queue->lock);
+    platform_event_signal(&queue->not_empty);
+}
 
-    list_init_capacity(list, LOADING_DIR_ENTRIES_COUNT);
+// waits until every entry the workers were given is done
+static void loading_queue_wait_idle(Loading_Queue_s * queue)
+{
+    platform_mutex_lock(&queue->lock);
+    while(queue->head != queue->tail || queue->busy != 0)
+    {
+        platform_mutex_unlock(&queue->lock);
+        platform_event_wait(&queue->progress);
+        platform_mutex_lock(&queue->lock);
+    }
+    platform_mutex_unlock(&queue->lock);
+}
 
-    u32 entries_read = LOADING_DIR_ENTRIES_COUNT;
-    while(entries_read == LOADING_DIR_ENTRIES_COUNT)
+// waits until a category was found, or every entry is done and there are none left (-1)
+static int loading_queue_next_category(Loading_Queue_s * queue)
+{
+    platform_mutex_lock(&queue->lock);
+    while(queue->categories_count == 0 && (queue->head != queue->tail || queue->busy != 0))
     {
-        res = FSDIR_Read(dir_handle, &entries_read, LOADING_DIR_ENTRIES_COUNT, loading_dir_entries);
-        if(R_FAILED(res))
+        platform_mutex_unlock(&queue->lock);
+        platform_event_wait(&queue->progress);
+        platform_mutex_lock(&queue->lock);
+    }
+    const int category = queue->categories_count != 0 ? queue->categories[--queue->categories_count] : -1;
+    platform_mutex_unlock(&queue->lock);
+    return category;
+}
+
+// adds the folders and zips in root/prefix to the list, with their paths relative to root.
+// Returns false if the list ran out of memory
+static bool load_folder_entries(Platform_Dir dir_handle, const char * root, const u16 * prefix, Entry_List_s * list, Loading_Queue_s * queue, bool use_workers)
+{
+    const size_t root_len = strlen(root);
+    const size_t prefix_len = strulen(prefix, 0x106);
+    u16 relative_path[0x106] = {0};
+    memcpy(relative_path, prefix, prefix_len * sizeof(u16));
+    if(prefix_len != 0)
+        relative_path[prefix_len] = '/';
+    const size_t name_start = prefix_len != 0 ? prefix_len + 1 : 0;
+
+    u32 batch_size = LOADING_DIR_ENTRIES_MIN;
+    bool more_entries = true;
+    while(more_entries)
+    {
+        u32 entries_read = 0;
+        if(R_FAILED(platform_dir_read(dir_handle, loading_dir_entries, batch_size, &entries_read)))
             break;
 
         for(u32 i = 0; i < entries_read; ++i)
         {
-            const FS_DirectoryEntry * const dir_entry = &loading_dir_entries[i];
-            const bool is_zip = !strcmp(dir_entry->shortExt, "ZIP");
-            if(!(dir_entry->attributes & FS_ATTRIBUTE_DIRECTORY) && !is_zip)
+            const Platform_Dir_Entry_s * const dir_entry = &loading_dir_entries[i];
+            const bool is_zip = !strcmp(dir_entry->short_ext, "ZIP");
+            if(!dir_entry->is_directory && !is_zip)
                 continue;
 
+            const size_t name_len = strulen(dir_entry->name, 0x106);
+            if(root_len + name_start + name_len >= 0x106)
+            {
+                DEBUG("Path too long in %s, skipping\n", root);
+                continue;
+            }
+
             const ssize_t new_entry_index = list_add_entry(list);
             if(new_entry_index < 0)
             {
                 // out of memory: still allow use of currently loaded entries.
-                // Many things might die, depending on the heap layout after
-                entries_read = 0;
-                break;
+                // Only a page was asked for, so there's likely some room left for the rest
+                return false;
+            }
+
+            // the workers hold on to the entries they were given, so they're done with them before any page is swapped out
+            if((new_entry_index & (ENTRIES_PAGE_SIZE - 1)) == 0 && list->resident_pages > ENTRIES_RESIDENT_PAGES)
+            {
+                if(use_workers)
+                    loading_queue_wait_idle(queue);
+                trim_pages(list);
             }
 
-            Entry_s * const current_entry = &list->entries[new_entry_index];
+            memcpy(relative_path + name_start, dir_entry->name, name_len * sizeof(u16));
+            Entry_s * const current_entry = get_entry_at(list, new_entry_index);
             memset(current_entry, 0, sizeof(Entry_s));
-            struacat(current_entry->path, loading_path);
-            strucat(current_entry->path, dir_entry->name);
+            current_entry->id = new_entry_index;
+            current_entry->path = arena_add(&list->strings, relative_path, name_start + name_len);
+            current_entry->folder = root;
+            list->paths[new_entry_index] = current_entry->path;
             current_entry->is_zip = is_zip;
+            if(is_zip)
+                current_entry->file_size = dir_entry->size;
+
+            if(use_workers)
+                loading_queue_push(queue, current_entry);
+            else
+                probe_entry(queue, current_entry);
+        }
+
+        more_entries = entries_read == batch_size;
+        if(more_entries)
+            batch_size = min(batch_size * 2, LOADING_DIR_ENTRIES_MAX);
+    }
+
+    return true;
+}
+
+Result load_entries(const char * const * roots, int roots_count, Entry_List_s * list, const InstallType loading_screen)
+{
+    // the entries are saved in the first one
+    const char * loading_path = roots[0];
+    u16 path[0x106] = {0};
+    struacat(path, loading_path);
+    Platform_Dir dir_handle;
+    Result res = platform_dir_open(&dir_handle, PLATFORM_ARCHIVE_SD, path);
+    if(R_FAILED(res))
+    {
+        DEBUG("Failed to open folder: %s\n", loading_path);
+        return res;
+    }
+
+    list_init_capacity(list, LOADING_DIR_ENTRIES_MIN);
+
+    Loading_Queue_s queue = {0};
+    platform_mutex_init(&queue.lock);
+    platform_event_init(&queue.not_empty, false);
+    platform_event_init(&queue.not_full, false);
+    platform_event_init(&queue.progress, false);
+
+    // the pages never move, so the workers can be given the entries themselves while more get added,
+    // as long as none gets swapped out under them.
+    // Without any, the entries are done here
+    Platform_Thread workers[LOADING_WORKERS_MAX];
+    int workers_count = 0;
+    const int cores = min(platform_core_count(), LOADING_WORKERS_MAX);
+    for(int i = 0; i < cores; i++)
+    {
+        workers[workers_count] = platform_thread_create(loading_worker, &queue, LOADING_WORKER_STACK_SIZE, 0x2F, platform_core_id(i));
+        if(workers[workers_count] != NULL)
+            workers_count++;
+    }
+
+    bool has_memory = load_folder_entries(dir_handle, loading_path, (const u16 *)u"", list, &queue, workers_count != 0);
+    platform_dir_close(dir_handle);
+
+    for(int i = 1; i < roots_count && has_memory; i++)
+    {
+        bool seen = false;
+        for(int j = 0; j < i && !seen; j++)
+            seen = !strcmp(roots[i], roots[j]);
+        if(seen)
+            continue;
+
+        path[0] = 0;
+        struacat(path, roots[i]);
+        if(R_FAILED(platform_dir_open(&dir_handle, PLATFORM_ARCHIVE_SD, path)))
+        {
+            DEBUG("Failed to open folder: %s\n", roots[i]);
+            continue;
         }
+        has_memory = load_folder_entries(dir_handle, roots[i], (const u16 *)u"", list, &queue, workers_count != 0);
+        platform_dir_close(dir_handle);
     }
 
-    FSDIR_Close(dir_handle);
+    // the categories found while the entries are being looked at are listed in turn
+    int category;
+    while(has_memory && (category = loading_queue_next_category(&queue)) >= 0)
+    {
+        // its page can be swapped out while the folder is read, its folder and path stay
+        const Entry_s * const category_entry = get_entry_at(list, category);
+        const char * const category_folder = category_entry->folder;
+        const u16 * const category_path = category_entry->path;
+        entry_get_path(category_entry, path);
+        if(R_FAILED(platform_dir_open(&dir_handle, PLATFORM_ARCHIVE_SD, path)))
+            continue;
+        has_memory = load_folder_entries(dir_handle, category_folder, category_path, list, &queue, workers_count != 0);
+        platform_dir_close(dir_handle);
+    }
+
+    platform_mutex_lock(&queue.lock);
+    queue.done = true;
+    platform_mutex_unlock(&queue.lock);
+    platform_event_signal(&queue.not_empty);
+    for(int i = 0; i < workers_count; i++)
+        platform_thread_join(workers[i]);
+    free(queue.categories);
+
+    // the categories themselves aren't entries. Only the pages being gone through have to stay
+    int kept = 0;
+    for(int i = 0; i < list->entries_count; i++)
+    {
+        if((i & (ENTRIES_PAGE_SIZE - 1)) == 0)
+            trim_pages(list);
+
+        const Entry_s * const current_entry = get_entry_at(list, i);
+        if(current_entry->is_category)
+            continue;
+
+        Entry_s * const kept_entry = get_entry_at(list, kept);
+        if(kept_entry != current_entry)
+            *kept_entry = *current_entry;
+        kept_entry->id = kept;
+        list->paths[kept] = kept_entry->path;
+        kept++;
+    }
+    list->entries_count = kept;
 
     list->loading_path = loading_path;
+    list->roots = roots;
+    list->roots_count = roots_count;
+    platform_mutex_init(&list->info_lock);
     const int loading_bar_ticks = list->entries_count / 10;
 
-    for(int i = 0, j = 0; i < list->entries_count; ++i)
+    // only the entries that are new or changed since the last launch have to get their info.smdh read,
+    // which is left to the icon loading for the visible ones, and to the info thread for the rest.
+    // Every root has its own index, they're all gone through at once so the entries are too
+    Entries_Index_s indexes[roots_count];
+    u32 root_entries[roots_count];
+    for(int r = 0; r < roots_count; r++)
     {
+        entries_index_load(&indexes[r], roots[r]);
+        root_entries[r] = 0;
+    }
+
+    bool any_pending = false;
+    int j = 0;
+    for(int i = 0; i < list->entries_count; ++i)
+    {
+        if((i & (ENTRIES_PAGE_SIZE - 1)) == 0)
+            trim_pages(list);
+
         // replaces (i % loading_bar_ticks) == 0
         if(++j >= loading_bar_ticks)
         {
             j = 0;
             draw_loading_bar(i, list->entries_count, loading_screen);
         }
-        Entry_s * const current_entry = &list->entries[i];
-        char * buf = NULL;
-        u32 buflen = load_data("/info.smdh", current_entry, &buf);
-        parse_smdh(buflen == sizeof(Icon_s) ? (Icon_s *)buf : NULL, current_entry, current_entry->path + strlen(loading_path));
-        free(buf);
+
+        Entry_s * const current_entry = get_entry_at(list, i);
+        int r = 0;
+        while(r < roots_count && current_entry->folder != roots[r])
+            r++;
+        if(r == roots_count)
+            continue;
+
+        root_entries[r]++;
+        if(entries_index_fill(&indexes[r], current_entry, list_entry_strings(list, current_entry)))
+            continue;
+
+        current_entry->name = current_entry->path;
+        current_entry->desc = (const u16 *)u"";
+        current_entry->author = (const u16 *)u"";
+        current_entry->info_pending = true;
+        any_pending = true;
+    }
+
+    bool index_outdated = false;
+    for(int r = 0; r < roots_count; r++)
+    {
+        if(indexes[r].records_count != root_entries[r])
+            index_outdated = true;
+        entries_index_free(&indexes[r]);
     }
 
+    // otherwise, the info thread saves it once it's done
+    if(index_outdated && !any_pending)
+        entries_index_save(list);
+    trim_pages(list);
+
     return res;
 }
 
 void list_init_capacity(Entry_List_s * list, const int init_capacity)
 {
-    list->entries = malloc(init_capacity * sizeof(Entry_s));
-    list->entries_capacity = init_capacity;
+    const int pages = (init_capacity + ENTRIES_PAGE_SIZE - 1) >> ENTRIES_PAGE_SHIFT;
+    list->entries = calloc(max(pages, 1), sizeof(Entry_Page_s));
+    list->pages_capacity = list->entries != NULL ? max(pages, 1) : 0;
+    list->entries_capacity = 0;
+    platform_mutex_init(&list->pages_lock);
 }
 
-#define LIST_CAPACITY_THRESHOLD 512
 ssize_t list_add_entry(Entry_List_s * list)
 {
     if(list->entries_count == list->entries_capacity)
     {
-        int next_capacity = list->entries_capacity;
-        // expand by doubling until we hit LIST_CAPACITY_THRESHOLD
-        // then simply increment by that, to have less extra space leftover
-        if(next_capacity < LIST_CAPACITY_THRESHOLD)
+        const int page = list->entries_capacity >> ENTRIES_PAGE_SHIFT;
+        if(page == list->pages_capacity)
         {
-            next_capacity *= 2;
+            // only the pages move, not the entries in them
+            const int next_capacity = max(list->pages_capacity * 2, 1);
+            Entry_Page_s * const new_pages = realloc(list->entries, next_capacity * sizeof(Entry_Page_s));
+            if(new_pages == NULL)
+            {
+                return -1;
+            }
+
+            list->entries = new_pages;
+            list->pages_capacity = next_capacity;
         }
-        else
+
+        // the paths and the order have room for every entry the pages have
+        const int next_capacity = list->entries_capacity + ENTRIES_PAGE_SIZE;
+        const u16 ** const new_paths = realloc(list->paths, next_capacity * sizeof(u16 *));
+        if(new_paths == NULL)
         {
-            next_capacity += LIST_CAPACITY_THRESHOLD;
+            return -1;
         }
+        list->paths = new_paths;
 
-        Entry_s * const new_list = realloc(list->entries, next_capacity * sizeof(Entry_s));
-        if(new_list == NULL)
+        if(list->order != NULL)
+        {
+            u32 * const new_order = realloc(list->order, next_capacity * sizeof(u32));
+            if(new_order == NULL)
+            {
+                return -1;
+            }
+            list->order = new_order;
+        }
+
+        Entry_s * const new_page = malloc(ENTRIES_PAGE_SIZE * sizeof(Entry_s));
+        if(new_page == NULL)
         {
             return -1;
         }
 
-        list->entries = new_list;
+        platform_mutex_lock(&list->pages_lock);
+        memset(&list->entries[page], 0, sizeof(Entry_Page_s));
+        list->entries[page].entries = new_page;
+        list->entries[page].last_used = list->pages_clock;
+        list->resident_pages++;
+        platform_mutex_unlock(&list->pages_lock);
         list->entries_capacity = next_capacity;
     }
 
+    // new entries go last until they're sorted
+    if(list->order != NULL)
+        list->order[list->entries_count] = list->entries_count;
+    list->paths[list->entries_count] = NULL;
     return list->entries_count++;
 }
+
+void list_free_entries(Entry_List_s * list)
+{
+    if(list->entries != NULL)
+    {
+        for(int i = 0; i < (list->entries_capacity >> ENTRIES_PAGE_SHIFT); i++)
+        {
+            free(list->entries[i].entries);
+            arena_free(&list->entries[i].strings);
+        }
+        free(list->entries);
+    }
+
+    if(list->swap_opened)
+    {
+        platform_file_close(list->swap_file);
+        u16 path[0x80];
+        get_swap_path(path, list->mode);
+        platform_file_delete(PLATFORM_ARCHIVE_SD, path);
+    }
+
+    free(list->records);
+    free(list->order);
+    free(list->paths);
+    list->entries = NULL;
+    list->entries_count = 0;
+    list->entries_capacity = 0;
+    list->pages_capacity = 0;
+    list->resident_pages = 0;
+    list->swap_opened = false;
+    list->records = NULL;
+    list->order = NULL;
+    list->paths = NULL;
+}
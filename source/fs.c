@@ -31,69 +31,48 @@
 #include "unicode.h"
 #include "ui_strings.h"
 #include "remote.h"
+#include "zip.h"
 
 #include <archive.h>
 #include <archive_entry.h>
 
-FS_Archive ArchiveSD;
-FS_Archive ArchiveHomeExt;
-FS_Archive ArchiveThemeExt;
-FS_Archive ArchiveBadgeExt;
+#define ZERO_FILL_CHUNK_SIZE 0x10000
 
-Result createExtSaveData(u32 extdataID)
-{
-    u8 null_smdh[0x36C0] = {0};
-    Handle *handle = fsGetSessionHandle();
-
-    u32 *cmdbuf = getThreadCommandBuffer();
-
-    u32 directory_limit = 1000;
-    u32 file_limit = 1000;
+static IO_Stats_s io_stats;
 
-    cmdbuf[0] = 0x08300182;
-    cmdbuf[1] = MEDIATYPE_SD;
-    cmdbuf[2] = extdataID;
-    cmdbuf[3] = 0;
-    cmdbuf[4] = 0x36C0;
-    cmdbuf[5] = directory_limit;
-    cmdbuf[6] = file_limit;
-    cmdbuf[7] = (0x36C0 << 4) | 0xA;
-    cmdbuf[8] = (u32)&null_smdh;
-
-    Result ret = 0;
-    if ((ret = svcSendSyncRequest(*handle)))
-        return ret;
-
-    return cmdbuf[1];
+// main_paths and the paths built from them are ASCII
+static void make_ascii_path(u16 * out, const char * path)
+{
+    out[0] = 0;
+    struacat(out, path);
 }
 
 Result init_sd(void)
 {
     Result res;
-    if(R_FAILED(res = FSUSER_OpenArchive(&ArchiveSD, ARCHIVE_SDMC, fsMakePath(PATH_EMPTY, "")))) return res;
+    if(R_FAILED(res = platform_archive_open(PLATFORM_ARCHIVE_SD, 0))) return res;
     load_config();
 
-    FSUSER_CreateDirectory(ArchiveSD, fsMakePath(PATH_ASCII, "/3ds"), FS_ATTRIBUTE_DIRECTORY);
-    FSUSER_CreateDirectory(ArchiveSD, fsMakePath(PATH_ASCII, "/3ds/"  APP_TITLE), FS_ATTRIBUTE_DIRECTORY);
-    FSUSER_CreateDirectory(ArchiveSD, fsMakePath(PATH_ASCII, "/3ds/"  APP_TITLE  "/cache"), FS_ATTRIBUTE_DIRECTORY);
-    FSUSER_CreateDirectory(ArchiveSD, fsMakePath(PATH_ASCII, "/3ds/" APP_TITLE "/BadgeBackups"), FS_ATTRIBUTE_DIRECTORY);
+    platform_dir_create(PLATFORM_ARCHIVE_SD, u"/3ds");
+    platform_dir_create(PLATFORM_ARCHIVE_SD, u"/3ds/"  APP_TITLE);
+    platform_dir_create(PLATFORM_ARCHIVE_SD, u"/3ds/"  APP_TITLE  "/cache");
+    platform_dir_create(PLATFORM_ARCHIVE_SD, u"/3ds/" APP_TITLE "/BadgeBackups");
 
     return 0;
 }
 
 Result open_archives(void)
 {
-    romfsInit();
-    u8 regionCode;
+    u8 regionCode = 0;
     u32 archive1;
     u32 archive2;
 
     Result res = 0;
 
-    FS_Path home;
-    FS_Path theme;
-
+#ifdef __3DS__
+    romfsInit();
     CFGU_SecureInfoGetRegion(&regionCode);
+#endif
     switch(regionCode)
     {
         case 0:
@@ -117,48 +96,36 @@ Result open_archives(void)
             archive2 = 0x00;
     }
 
-    FSUSER_CreateDirectory(ArchiveSD, fsMakePath(PATH_ASCII, main_paths[REMOTE_MODE_THEMES]), FS_ATTRIBUTE_DIRECTORY);
-    FSUSER_CreateDirectory(ArchiveSD, fsMakePath(PATH_ASCII, main_paths[REMOTE_MODE_SPLASHES]), FS_ATTRIBUTE_DIRECTORY);
-    FSUSER_CreateDirectory(ArchiveSD, fsMakePath(PATH_ASCII, main_paths[REMOTE_MODE_BADGES]), FS_ATTRIBUTE_DIRECTORY);
-
-    u32 homeMenuPath[3] = {MEDIATYPE_SD, archive2, 0};
-    home.type = PATH_BINARY;
-    home.size = 0xC;
-    home.data = homeMenuPath;
-    if(R_FAILED(res = FSUSER_OpenArchive(&ArchiveHomeExt, ARCHIVE_EXTDATA, home))) return res;
+    u16 path[0x106];
+    for(int i = 0; i < REMOTE_MODE_AMOUNT; i++)
+    {
+        make_ascii_path(path, main_paths[i]);
+        platform_dir_create(PLATFORM_ARCHIVE_SD, path);
+    }
 
-    u32 themePath[3] = {MEDIATYPE_SD, archive1, 0};
-    theme.type = PATH_BINARY;
-    theme.size = 0xC;
-    theme.data = themePath;
-    if(R_FAILED(res = FSUSER_OpenArchive(&ArchiveThemeExt, ARCHIVE_EXTDATA, theme))) return res;
+    if(R_FAILED(res = platform_archive_open(PLATFORM_ARCHIVE_HOME_EXT, archive2))) return res;
+    if(R_FAILED(res = platform_archive_open(PLATFORM_ARCHIVE_THEME_EXT, archive1))) return res;
 
-    Handle test_handle;
-    if(R_FAILED(res = FSUSER_OpenFile(&test_handle, ArchiveThemeExt, fsMakePath(PATH_ASCII, "/ThemeManage.bin"), FS_OPEN_READ, 0))) return res;
-    FSFILE_Close(test_handle);
+    Platform_File test_handle;
+    if(R_FAILED(res = platform_file_open(&test_handle, PLATFORM_ARCHIVE_THEME_EXT, u"/ThemeManage.bin", PLATFORM_OPEN_READ))) return res;
+    platform_file_close(test_handle);
 
     return 0;
 }
 
 Result open_badge_extdata()
 {
-    Handle test_handle;
-    FS_Path badge;
+    Platform_File test_handle;
 
     Result res = 0;
 
-    u32 badgePath[3] = {MEDIATYPE_SD, 0x000014d1, 0};
-    badge.type = PATH_BINARY;
-    badge.size = 0xC;
-
-    badge.data = badgePath;
-    if(R_FAILED(res = FSUSER_OpenArchive(&ArchiveBadgeExt, ARCHIVE_EXTDATA, badge)))
+    if(R_FAILED(res = platform_archive_open(PLATFORM_ARCHIVE_BADGE_EXT, 0x000014d1)))
     {
-        if (R_SUMMARY(res) == RS_NOTFOUND) 
+        if (platform_not_found(res))
         {
             DEBUG("Extdata not found - creating\n");
-            createExtSaveData(0x000014d1);
-            FSUSER_OpenArchive(&ArchiveBadgeExt, ARCHIVE_EXTDATA, badge);
+            platform_archive_create(PLATFORM_ARCHIVE_BADGE_EXT, 0x000014d1);
+            platform_archive_open(PLATFORM_ARCHIVE_BADGE_EXT, 0x000014d1);
         } else
         {
             DEBUG("Unknown extdata error\n");
@@ -166,46 +133,63 @@ Result open_badge_extdata()
         }
     }
 
-    if (R_FAILED(res = FSUSER_OpenFile(&test_handle, ArchiveBadgeExt, fsMakePath(PATH_ASCII, "/BadgeData.dat"), FS_OPEN_READ, 0)))
+    if (R_FAILED(res = platform_file_open(&test_handle, PLATFORM_ARCHIVE_BADGE_EXT, u"/BadgeData.dat", PLATFORM_OPEN_READ)))
     {
-        if (R_SUMMARY(res) == RS_NOTFOUND)
+        if (platform_not_found(res))
         {
-            FSUSER_CreateFile(ArchiveBadgeExt, fsMakePath(PATH_ASCII, "/BadgeData.dat"), 0, BADGE_DATA_SIZE);
-            FSUSER_OpenFile(&test_handle, ArchiveBadgeExt, fsMakePath(PATH_ASCII, "/BadgeData.dat"), FS_OPEN_WRITE, 0);
-            FSFILE_Flush(test_handle);
+            platform_file_create(PLATFORM_ARCHIVE_BADGE_EXT, u"/BadgeData.dat", BADGE_DATA_SIZE);
+            if (R_SUCCEEDED(platform_file_open(&test_handle, PLATFORM_ARCHIVE_BADGE_EXT, u"/BadgeData.dat", PLATFORM_OPEN_WRITE)))
+            {
+                platform_file_flush(test_handle);
+                platform_file_close(test_handle);
+            }
         }
-        DEBUG("Error 0x%08ld opening BadgeData.dat, retrying\n", res);
+        DEBUG("Error 0x%08lx opening BadgeData.dat, retrying\n", res);
+    }
+    else
+    {
+        platform_file_close(test_handle);
     }
-    FSFILE_Close(test_handle);
 
-    if(R_FAILED(res = FSUSER_OpenFile(&test_handle, ArchiveBadgeExt, fsMakePath(PATH_ASCII, "/BadgeMngFile.dat"), FS_OPEN_READ, 0)))
+    if(R_FAILED(res = platform_file_open(&test_handle, PLATFORM_ARCHIVE_BADGE_EXT, u"/BadgeMngFile.dat", PLATFORM_OPEN_READ)))
     {
-        DEBUG("Error 0x%08ld opening BadgeMngFile.dat, retrying\n", res);
-        if (R_SUMMARY(res) == RS_NOTFOUND)
+        DEBUG("Error 0x%08lx opening BadgeMngFile.dat, retrying\n", res);
+        if (platform_not_found(res))
         {
-            remake_file(fsMakePath(PATH_ASCII, "/BadgeMngFile.dat"), ArchiveBadgeExt, BADGE_MNG_SIZE);
+            write_file(u"/BadgeMngFile.dat", PLATFORM_ARCHIVE_BADGE_EXT, NULL, 0, BADGE_MNG_SIZE);
         }
     }
-    FSFILE_Close(test_handle);
+    else
+    {
+        platform_file_close(test_handle);
+    }
 
     char tp_path[0x106] = {0};
     sprintf(tp_path, "%sThemePlaza Badges", main_paths[REMOTE_MODE_BADGES]);
-    FSUSER_CreateDirectory(ArchiveSD, fsMakePath(PATH_ASCII, tp_path), FS_ATTRIBUTE_DIRECTORY);
-    strcat(tp_path, "/_seticon.png");
+    u16 path[0x106];
+    make_ascii_path(path, tp_path);
+    platform_dir_create(PLATFORM_ARCHIVE_SD, path);
+    struacat(path, "/_seticon.png");
 
-    if(R_FAILED(res = FSUSER_OpenFile(&test_handle, ArchiveSD, fsMakePath(PATH_ASCII, tp_path), FS_OPEN_READ, 0)))
+    if(R_FAILED(res = platform_file_open(&test_handle, PLATFORM_ARCHIVE_SD, path, PLATFORM_OPEN_READ)))
     {
         FILE *fp = fopen("romfs:/tp_set.png", "rb");
-        fseek(fp, 0L, SEEK_END);
-        ssize_t size = ftell(fp);
-        char *icon_buf = malloc(size);
-        fseek(fp, 0L, SEEK_SET);
-        fread(icon_buf, 1, size, fp);
-        fclose(fp);
-        remake_file(fsMakePath(PATH_ASCII, tp_path), ArchiveSD, size);
-        buf_to_file(size, fsMakePath(PATH_ASCII, tp_path), ArchiveSD, icon_buf);
+        if (fp != NULL)
+        {
+            fseek(fp, 0L, SEEK_END);
+            ssize_t size = ftell(fp);
+            char *icon_buf = malloc(size);
+            fseek(fp, 0L, SEEK_SET);
+            fread(icon_buf, 1, size, fp);
+            fclose(fp);
+            write_file(path, PLATFORM_ARCHIVE_SD, icon_buf, size, size);
+            free(icon_buf);
+        }
         DEBUG("res: 0x%08lx\n", res);
-        free(icon_buf);
+    }
+    else
+    {
+        platform_file_close(test_handle);
     }
 
     return 0;
@@ -215,48 +199,70 @@ Result close_archives(void)
 {
     Result res;
 
-    if(R_FAILED(res = FSUSER_CloseArchive(ArchiveSD))) return res;
-    if(R_FAILED(res = FSUSER_CloseArchive(ArchiveHomeExt))) return res;
-    if(R_FAILED(res = FSUSER_CloseArchive(ArchiveThemeExt))) return res;
-    if(R_FAILED(res = FSUSER_CloseArchive(ArchiveBadgeExt))) return res;
+    DEBUG("io: 0x%llx bytes read, 0x%llx written, 0x%llx zero-filled\n", io_stats.read, io_stats.written, io_stats.zeroed);
+
+    if(R_FAILED(res = platform_archive_close(PLATFORM_ARCHIVE_SD))) return res;
+    if(R_FAILED(res = platform_archive_close(PLATFORM_ARCHIVE_HOME_EXT))) return res;
+    if(R_FAILED(res = platform_archive_close(PLATFORM_ARCHIVE_THEME_EXT))) return res;
+    if(R_FAILED(res = platform_archive_close(PLATFORM_ARCHIVE_BADGE_EXT))) return res;
 
     return 0;
 }
 
 Result load_parental_controls(Parental_Restrictions_s *restrictions)
 {
+#ifdef __3DS__
     char parental_data[0xC0] = {0};
     Result res;
 
     if (R_FAILED(res = CFGU_GetConfigInfoBlk2(0xC0, 0x000C0000, &parental_data))) return res;
     memcpy(restrictions, parental_data, 4);
+#else
+    memset(restrictions, 0, sizeof(Parental_Restrictions_s));
+#endif
 
     return 0;
 }
 
-u32 file_to_buf(FS_Path path, FS_Archive archive, char ** buf)
+// false unless all size bytes could be read
+static bool read_all(Platform_File handle, u64 offset, char * buf, u32 size)
+{
+    u32 read = 0;
+    return R_SUCCEEDED(platform_file_read(handle, offset, buf, size, &read)) && read == size;
+}
+
+u32 file_to_buf(const u16 * path, PlatformArchive archive, char ** buf)
 {
-    Handle file;
+    Platform_File file;
     Result res = 0;
-    if (R_FAILED(res = FSUSER_OpenFile(&file, archive, path, FS_OPEN_READ, 0)))
+    if (R_FAILED(res = platform_file_open(&file, archive, path, PLATFORM_OPEN_READ)))
     {
         DEBUG("file_to_buf failed - 0x%08lx\n", res);
         return 0;
     }
 
-    u64 size;
-    FSFILE_GetSize(file, &size);
+    u64 size = 0;
+    platform_file_get_size(file, &size);
     if(size != 0)
     {
-        *buf = calloc(1, size);
+        *buf = malloc(size);
         if (*buf == NULL)
         {
             DEBUG("Error allocating buffer - out of memory??\n");
+            platform_file_close(file);
+            return 0;
+        }
+        if (!read_all(file, 0, *buf, size))
+        {
+            DEBUG("file_to_buf failed to read the file\n");
+            free(*buf);
+            *buf = NULL;
+            platform_file_close(file);
             return 0;
         }
-        FSFILE_Read(file, NULL, 0, *buf, size);
+        __atomic_add_fetch(&io_stats.read, size, __ATOMIC_RELAXED);
     }
-    FSFILE_Close(file);
+    platform_file_close(file);
     return (u32)size;
 }
 
@@ -286,7 +292,7 @@ s16 for_each_file_zip(u16 *zip_path, u32 (*zip_iter_callback)(char *filebuf, u64
     while (archive_read_next_header(a, &entry) == ARCHIVE_OK)
     {
         file_size = archive_entry_size(entry);
-        char *buf = calloc(file_size, sizeof(char));
+        char *buf = malloc(file_size);
         archive_read_data(a, buf, file_size);
         zip_iter_callback(buf, file_size, archive_entry_pathname(entry), userdata);
         free(buf);
@@ -296,35 +302,72 @@ s16 for_each_file_zip(u16 *zip_path, u32 (*zip_iter_callback)(char *filebuf, u64
     return 0;
 }
 
-static u32 zip_to_buf(struct archive * a, const char * file_name, char ** buf)
+// advances the archive to file_name, returns its size (0 if it isn't there)
+static u64 zip_find_file(struct archive * a, const char * file_name)
 {
     struct archive_entry * entry;
 
-    bool found = false;
-    u64 file_size = 0;
-
-    while(!found && archive_read_next_header(a, &entry) == ARCHIVE_OK)
+    while(archive_read_next_header(a, &entry) == ARCHIVE_OK)
     {
-        found = !strcasecmp(archive_entry_pathname(entry), file_name);
+        if(!strcasecmp(archive_entry_pathname(entry), file_name))
+            return archive_entry_size(entry);
     }
 
-    if(found)
+    return 0;
+}
+
+// reads every file of file_names in one pass over the archive.
+// bufs can be NULL to only get the sizes
+static u32 zip_to_bufs(struct archive * a, const char ** file_names, char ** bufs, u32 * sizes, int count)
+{
+    struct archive_entry * entry;
+    bool done[count];
+    int done_count = 0;
+    u32 found = 0;
+
+    for(int i = 0; i < count; i++)
     {
-        file_size = archive_entry_size(entry);
-        *buf = calloc(file_size, sizeof(char));
-        archive_read_data(a, *buf, file_size);
+        done[i] = false;
+        sizes[i] = 0;
+        if(bufs != NULL)
+            bufs[i] = NULL;
     }
-    else
+
+    while(done_count < count && archive_read_next_header(a, &entry) == ARCHIVE_OK)
     {
-        DEBUG("Couldn't find file in zip\n");
+        const char * pathname = archive_entry_pathname(entry);
+        for(int i = 0; i < count; i++)
+        {
+            if(done[i] || strcasecmp(pathname, file_names[i]))
+                continue;
+
+            done[i] = true;
+            done_count++;
+
+            u64 file_size = archive_entry_size(entry);
+            if(file_size != 0)
+            {
+                if(bufs != NULL)
+                {
+                    bufs[i] = malloc(file_size);
+                    archive_read_data(a, bufs[i], file_size);
+                }
+                sizes[i] = (u32)file_size;
+                found++;
+            }
+            break;
+        }
     }
 
+    if(found != (u32)count)
+        DEBUG("Couldn't find %lu of %d files in zip\n", count - found, count);
+
     archive_read_free(a);
 
-    return (u32)file_size;
+    return found;
 }
 
-u32 zip_memory_to_buf(const char * file_name, void * zip_memory, size_t zip_size, char ** buf)
+u32 zip_memory_to_bufs(const char ** file_names, void * zip_memory, size_t zip_size, char ** bufs, u32 * sizes, int count)
 {
     struct archive * a = archive_read_new();
     archive_read_support_format_zip(a);
@@ -333,13 +376,21 @@ u32 zip_memory_to_buf(const char * file_name, void * zip_memory, size_t zip_size
     if(r != ARCHIVE_OK)
     {
         DEBUG("Invalid zip being opened from memory\n");
+        archive_read_free(a);
         return 0;
     }
 
-    return zip_to_buf(a, file_name, buf);
+    return zip_to_bufs(a, file_names, bufs, sizes, count);
 }
 
-u32 zip_file_to_buf(const char * file_name, const u16 * zip_path, char ** buf)
+u32 zip_memory_to_buf(const char * file_name, void * zip_memory, size_t zip_size, char ** buf)
+{
+    u32 size = 0;
+    zip_memory_to_bufs(&file_name, zip_memory, zip_size, buf, &size, 1);
+    return size;
+}
+
+static struct archive * open_zip_file(const u16 * zip_path)
 {
     ssize_t len = strulen(zip_path, 0x106);
     char * path = calloc(len, sizeof(u16));
@@ -356,157 +407,250 @@ u32 zip_file_to_buf(const char * file_name, const u16 * zip_path, char ** buf)
         char path[0x128] = {0};
         utf16_to_utf8((u8 *) path, zip_path, 0x128);
         DEBUG("%s\n", path);
-        return 0;
+        archive_read_free(a);
+        return NULL;
     }
 
-    return zip_to_buf(a, file_name, buf);
+    return a;
 }
 
-Result buf_to_file(u32 size, FS_Path path, FS_Archive archive, char * buf)
+u32 zip_file_to_bufs(const char ** file_names, const u16 * zip_path, char ** bufs, u32 * sizes, int count)
 {
-    Handle handle;
-    Result res = 0;
-    if (R_FAILED(res = FSUSER_OpenFile(&handle, archive, path, FS_OPEN_WRITE, 0))) return res;
-    if (R_FAILED(res = FSFILE_Write(handle, NULL, 0, buf, size, FS_WRITE_FLUSH))) return res;
-    if (R_FAILED(res = FSFILE_Close(handle))) return res;
-    return 0;
+    if(zip_index_read(zip_path, file_names, bufs, sizes, count))
+    {
+        u32 found = 0;
+        for(int i = 0; i < count; i++)
+        {
+            if(sizes[i] != 0)
+                found++;
+        }
+        return found;
+    }
+
+    struct archive * a = open_zip_file(zip_path);
+    if(a == NULL)
+        return 0;
+
+    return zip_to_bufs(a, file_names, bufs, sizes, count);
+}
+
+u32 zip_file_to_buf(const char * file_name, const u16 * zip_path, char ** buf)
+{
+    u32 size = 0;
+    zip_file_to_bufs(&file_name, zip_path, buf, &size, 1);
+    return size;
 }
 
-u32 decompress_lz_file(FS_Path file_name, FS_Archive archive, char ** buf)
+bool stream_open_file(Data_Stream_s * stream, const u16 * path, PlatformArchive archive)
 {
-    Handle handle;
+    memset(stream, 0, sizeof(Data_Stream_s));
+    stream->type = DATA_STREAM_FILE;
+
     Result res = 0;
-    if (R_FAILED(res = FSUSER_OpenFile(&handle, archive, file_name, FS_OPEN_READ, 0))) {
-        DEBUG("%lu\n", res);
-        return 0;
+    if (R_FAILED(res = platform_file_open(&stream->handle, archive, path, PLATFORM_OPEN_READ)))
+    {
+        DEBUG("stream_open_file failed - 0x%08lx\n", res);
+        return false;
     }
-    u64 size;
-    FSFILE_GetSize(handle, &size);
-
-    char * temp_buf = NULL;
 
-    if(size != 0)
+    u64 size = 0;
+    platform_file_get_size(stream->handle, &size);
+    if (size == 0)
     {
-        temp_buf = calloc(1, size);
-        FSFILE_Read(handle, NULL, 0, temp_buf, size);
+        platform_file_close(stream->handle);
+        return false;
     }
-    FSFILE_Close(handle);
 
-    if (temp_buf[0] != 0x11) {
-        free(temp_buf);
-        return 0;
-    }
+    stream->size = (u32)size;
+    return true;
+}
 
-    u32 output_size = temp_buf[1] | ((temp_buf[2] << 8) & 0xFF00) | ((temp_buf[3] << 16) & 0xFF0000);
-    printf("%ld\n", output_size);
+static bool stream_open_zip_archive(Data_Stream_s * stream)
+{
+    stream->archive = open_zip_file(stream->zip_path);
+    if (stream->archive == NULL)
+        return false;
 
+    stream->size = (u32)zip_find_file(stream->archive, stream->file_name);
+    if (stream->size == 0)
+    {
+        DEBUG("Couldn't find file in zip\n");
+        archive_read_free(stream->archive);
+        stream->archive = NULL;
+        return false;
+    }
 
-    *buf = calloc(1, output_size);
+    return true;
+}
 
-    u32 pos = 4;
-    u32 cur_written = 0;
-    u8 counter = 0;
-    u8 mask = 0;
+bool stream_open_zip(Data_Stream_s * stream, const char * file_name, const u16 * zip_path)
+{
+    memset(stream, 0, sizeof(Data_Stream_s));
 
-    while (cur_written < output_size)
+    if (zip_index_open(&stream->zip_member, zip_path, file_name))
     {
-        if (counter == 0) // read mask
+        stream->type = DATA_STREAM_ZIP_INDEX;
+        stream->size = stream->zip_member.member.size;
+        if (stream->size == 0)
         {
-            mask = temp_buf[pos++];
-            counter++;
-            continue;
+            zip_index_close(&stream->zip_member);
+            return false;
         }
+        return true;
+    }
 
-        if ((mask >> (8 - counter)) & 0x01) // compressed block
-        {
-            int len = 0;
-            int disp = 0;
-            switch (temp_buf[pos] >> 4)
-            {
-                case 0:
-                    len  = temp_buf[pos++] << 4;
-                    len |= temp_buf[pos] >> 4;
-                    len += 0x11;
-                    break;
-
-                case 1:
-                    len  = (temp_buf[pos++] & 0x0F) << 12;
-                    len |=  temp_buf[pos++] << 4;
-                    len |=  temp_buf[pos] >> 4;
-                    len += 0x111;
-                    break;
-
-                default:
-                    len  = (temp_buf[pos] >> 4) + 1;
-            }
+    stream->type = DATA_STREAM_ZIP_ARCHIVE;
+    memcpy(stream->zip_path, zip_path, sizeof(stream->zip_path));
+    strncpy(stream->file_name, file_name, sizeof(stream->file_name) - 1);
+    return stream_open_zip_archive(stream);
+}
 
-            disp  = (temp_buf[pos++] & 0x0F) << 8;
-            disp |=  temp_buf[pos++];
+u32 stream_read(Data_Stream_s * stream, char * buf, u32 size)
+{
+    size = min(size, stream->size - stream->position);
 
-            for (int i = 0; i < len; ++i)
+    u32 read = 0;
+    switch (stream->type)
+    {
+        case DATA_STREAM_FILE:
+            if (R_FAILED(platform_file_read(stream->handle, stream->position, buf, size, &read)))
+                read = 0;
+            __atomic_add_fetch(&io_stats.read, read, __ATOMIC_RELAXED);
+            break;
+        case DATA_STREAM_ZIP_INDEX:
+            read = zip_member_read(&stream->zip_member, buf, size);
+            break;
+        case DATA_STREAM_ZIP_ARCHIVE:
+            // libarchive hands out the data a block at a time
+            while (read < size)
             {
-                *(*buf + cur_written + i) = *(*buf + cur_written - disp - 1 + i);
+                la_ssize_t block = archive_read_data(stream->archive, buf + read, size - read);
+                if (block <= 0)
+                    break;
+                read += block;
             }
+            break;
+    }
 
-            cur_written += len;
-        }
-        else // byte literal
-        {
-            *(*buf + cur_written) = temp_buf[pos++];
-            cur_written++;
-        }
-
-        if (++counter > 8) counter = 0;
+    stream->position += read;
+    return read;
+}
 
+bool stream_rewind(Data_Stream_s * stream)
+{
+    stream->position = 0;
+    switch (stream->type)
+    {
+        case DATA_STREAM_FILE:
+            return true;
+        case DATA_STREAM_ZIP_INDEX:
+            return zip_member_rewind(&stream->zip_member);
+        case DATA_STREAM_ZIP_ARCHIVE:
+            archive_read_free(stream->archive);
+            return stream_open_zip_archive(stream);
     }
 
+    return false;
+}
+
+void stream_close(Data_Stream_s * stream)
+{
+    switch (stream->type)
+    {
+        case DATA_STREAM_FILE:
+            platform_file_close(stream->handle);
+            break;
+        case DATA_STREAM_ZIP_INDEX:
+            zip_index_close(&stream->zip_member);
+            break;
+        case DATA_STREAM_ZIP_ARCHIVE:
+            if (stream->archive != NULL)
+                archive_read_free(stream->archive);
+            break;
+    }
 
-    free(temp_buf);
+    memset(stream, 0, sizeof(Data_Stream_s));
+}
 
-    return cur_written;
+Result buf_to_file(u32 size, const u16 * path, PlatformArchive archive, char * buf)
+{
+    Platform_File handle;
+    Result res = 0;
+    if (R_FAILED(res = platform_file_open(&handle, archive, path, PLATFORM_OPEN_WRITE))) return res;
+    if (R_SUCCEEDED(res = platform_file_write(handle, 0, buf, size, NULL)))
+        res = platform_file_flush(handle);
+    platform_file_close(handle);
+    if (R_FAILED(res)) return res;
+    __atomic_add_fetch(&io_stats.written, size, __ATOMIC_RELAXED);
+    return 0;
 }
 
-// This is an awful algorithm to "compress" LZ11 data.
-// We do this instead of actual LZ11 compression because of time -
-// LZ11 requires a lot of mem searching which is painfully slow on 3DS.
-// This process is nearly instant but means the resulting file is actually larger
-// than the input file. I don't think this is a problem as the only file we compress like this
-// is the theme data installed to extdata in some rare cases, which means only 1 file at most
-// is ever compressed like this. I don't think 400 KB is that big a sacrifice for probably
-// half a minute or so of time save - I may change my mind on this in the future, especially
-// if i figure out a dynamic programming algorithm which ends up being significantly
-// faster. Otherwise, I think this is probably a fine implementation.
+Result write_handle(Platform_File handle, u64 offset, const char * buf, u32 size)
+{
+    Result res = platform_file_write(handle, offset, buf, size, NULL);
+    if (R_SUCCEEDED(res))
+        __atomic_add_fetch(&io_stats.written, size, __ATOMIC_RELAXED);
+    return res;
+}
 
-u32 compress_lz_file_fast(FS_Path path, FS_Archive archive, char * in_buf, u32 size)
+void get_io_stats(IO_Stats_s * stats)
 {
-    char * output_buf = calloc(1, size * 2);
-    u32 output_size = 0;
-    u32 mask_pos = 0;
-    u32 bytes_processed = 0;
-    u8 counter = 0;
+    stats->read = __atomic_load_n(&io_stats.read, __ATOMIC_RELAXED);
+    stats->written = __atomic_load_n(&io_stats.written, __ATOMIC_RELAXED);
+    stats->zeroed = __atomic_load_n(&io_stats.zeroed, __ATOMIC_RELAXED);
+}
 
-    if (output_buf == NULL) return 0;
+typedef struct {
+    Platform_File handle;
+    u64 offset;
+} Handle_Reader_s;
 
-    // Set header data for the LZ11 file - 0x11 is version (LZ11), next 3 bytes are size
-    output_buf[0] = 0x11;
-    output_buf[3] = (size & 0xFF0000) >> 16;
-    output_buf[2] = (size & 0xFF00) >> 8;
-    output_buf[1] = (size & 0xFF);
+static u32 handle_read_callback(void * userdata, char * buf, u32 size)
+{
+    Handle_Reader_s * reader = (Handle_Reader_s *)userdata;
+    u32 read = 0;
+    if (R_FAILED(platform_file_read(reader->handle, reader->offset, buf, size, &read))) return 0;
+    reader->offset += read;
+    return read;
+}
 
-    output_size += 4;
+u32 decompress_lz_file(const u16 * file_name, PlatformArchive archive, char ** buf)
+{
+    Handle_Reader_s reader = {0};
+    Result res = 0;
+    if (R_FAILED(res = platform_file_open(&reader.handle, archive, file_name, PLATFORM_OPEN_READ))) {
+        DEBUG("%lu\n", res);
+        return 0;
+    }
 
-    while (bytes_processed < size)
+    u32 output_size = 0;
+    LZ11_Stream_s * stream = malloc(sizeof(LZ11_Stream_s));
+    if (stream != NULL && lz11_stream_open(stream, handle_read_callback, &reader))
     {
-        if (counter == 0)
+        *buf = malloc(stream->size);
+        if (*buf != NULL)
         {
-            mask_pos = output_size++;
-            output_buf[mask_pos] = 0;
+            output_size = lz11_stream_read(stream, *buf, stream->size);
+            if (stream->error || output_size != stream->size)
+            {
+                free(*buf);
+                *buf = NULL;
+                output_size = 0;
+            }
         }
+    }
 
-        output_buf[output_size++] = in_buf[bytes_processed++];
+    free(stream);
+    platform_file_close(reader.handle);
 
-        if (++counter == 8) counter = 0;
-    }
+    return output_size;
+}
+
+u32 compress_lz_file(const u16 * path, PlatformArchive archive, char * in_buf, u32 size, LZ11_Level level)
+{
+    char * output_buf = NULL;
+    u32 output_size = lz11_compress(in_buf, size, &output_buf, level);
+    if (output_size == 0) return 0;
 
     buf_to_file(output_size, path, archive, output_buf);
     free(output_buf);
@@ -514,43 +658,132 @@ u32 compress_lz_file_fast(FS_Path path, FS_Archive archive, char * in_buf, u32 s
     return output_size;
 }
 
-void remake_file(FS_Path path, FS_Archive archive, u32 size)
+u32 patch_lz_file(const u16 * path, PlatformArchive archive, u32 compressed_size, u32 offset, const char * patch, u32 patch_size)
 {
-    Handle handle;
-    if (R_SUCCEEDED(FSUSER_OpenFile(&handle, archive, path, FS_OPEN_READ, 0)))
+    Platform_File handle;
+    Result res = 0;
+    if (R_FAILED(res = platform_file_open(&handle, archive, path, PLATFORM_OPEN_READ | PLATFORM_OPEN_WRITE))) {
+        DEBUG("%lu\n", res);
+        return 0;
+    }
+
+    u64 file_size = 0;
+    platform_file_get_size(handle, &file_size);
+    if (compressed_size == 0 || compressed_size > file_size)
     {
-        FSFILE_Close(handle);
-        FSUSER_DeleteFile(archive, path);
+        platform_file_close(handle);
+        return 0;
     }
-    Result res = FSUSER_CreateFile(archive, path, 0, size);
-    DEBUG("Remake file res: 0x%08lx\n", res);
-    char * buf = calloc(size, 1);
-    if (buf == NULL)
+
+    // the start of the data is usually enough, all of it is needed if the flag groups have to be moved
+    u32 read_size = min(compressed_size, LZ11_PATCH_INPUT_SIZE(offset + patch_size));
+    char * in_buf = malloc(compressed_size);
+    char * out_buf = NULL;
+    u32 out_size = 0;
+    u32 replaced = 0;
+    bool patched = false;
+
+    if (in_buf != NULL && read_all(handle, 0, in_buf, read_size))
     {
-        DEBUG("out of memory - not overwriting file?\n");
-    } else {
-        buf_to_file(size, path, archive, buf);
-        free(buf);
+        patched = lz11_patch(in_buf, read_size, offset, patch, patch_size, &out_buf, &out_size, &replaced);
+        if (!patched && read_size != compressed_size && read_all(handle, read_size, in_buf + read_size, compressed_size - read_size))
+        {
+            read_size = compressed_size;
+            patched = lz11_patch(in_buf, read_size, offset, patch, patch_size, &out_buf, &out_size, &replaced);
+        }
+    }
+
+    u32 new_size = 0;
+    if (patched && out_size == replaced)
+    {
+        new_size = compressed_size;
+        if (out_size != 0)
+            write_handle(handle, 0, out_buf, out_size);
+    }
+    else if (patched && compressed_size - replaced + out_size <= file_size
+             && (read_size == compressed_size || read_all(handle, read_size, in_buf + read_size, compressed_size - read_size)))
+    {
+        // the new start has a different size, so the rest of the data moves along
+        new_size = compressed_size - replaced + out_size;
+        write_handle(handle, out_size, in_buf + replaced, compressed_size - replaced);
+        write_handle(handle, 0, out_buf, out_size);
     }
+
+    platform_file_flush(handle);
+
+    free(out_buf);
+    free(in_buf);
+    platform_file_close(handle);
+
+    return new_size;
 }
 
-Result zero_handle_memeasy(Handle handle)
+Result create_file(const u16 * path, PlatformArchive archive, u32 size)
 {
-    u64 size = 0;
-    u64 cur = 0;
-    FSFILE_GetSize(handle, &size);
-    char *zero_buf = calloc(1, 0x10000);
-    while (size > 0x10000)
+    Platform_File handle;
+    if (R_SUCCEEDED(platform_file_open(&handle, archive, path, PLATFORM_OPEN_READ)))
     {
-        FSFILE_Write(handle, NULL, cur, &zero_buf, 0x10000, 0);
-        cur += 0x10000;
-        size -= 0x10000;
+        platform_file_close(handle);
+        platform_file_delete(archive, path);
     }
-    FSFILE_Write(handle, NULL, cur, &zero_buf, size, 0);
-    free(zero_buf);
-    return 0;
+    Result res = platform_file_create(archive, path, size);
+    DEBUG("Create file res: 0x%08lx\n", res);
+    return res;
 }
 
+Result zero_fill_handle(Platform_File handle, u64 offset, u64 end)
+{
+    static const char zero_buf[ZERO_FILL_CHUNK_SIZE] = {0};
+    Result res = 0;
+    while (offset < end && R_SUCCEEDED(res))
+    {
+        const u32 size = min(end - offset, ZERO_FILL_CHUNK_SIZE);
+        res = platform_file_write(handle, offset, zero_buf, size, NULL);
+        __atomic_add_fetch(&io_stats.zeroed, size, __ATOMIC_RELAXED);
+        offset += size;
+    }
+    return res;
+}
+
+Result write_file(const u16 * path, PlatformArchive archive, const char * buf, u32 size, u32 file_size)
+{
+    Result res = create_file(path, archive, file_size);
+    if (R_FAILED(res)) return res;
+
+    Platform_File handle;
+    if (R_FAILED(res = platform_file_open(&handle, archive, path, PLATFORM_OPEN_WRITE))) return res;
+
+    if (buf != NULL && size != 0)
+        res = write_handle(handle, 0, buf, size);
+    if (R_SUCCEEDED(res))
+        res = zero_fill_handle(handle, buf != NULL ? size : 0, file_size);
+
+    platform_file_flush(handle);
+    platform_file_close(handle);
+    return res;
+}
+
+Result zero_handle_memeasy(Platform_File handle)
+{
+    u64 size = 0;
+    platform_file_get_size(handle, &size);
+    return zero_fill_handle(handle, 0, size);
+}
+
+static Saved_Zip_s saved_zips[SAVED_ZIPS_MAX];
+static int saved_zips_count = 0;
+
+int take_saved_zips(Saved_Zip_s * zips)
+{
+    const int count = saved_zips_count;
+    if(count > 0)
+        memcpy(zips, saved_zips, count * sizeof(Saved_Zip_s));
+    saved_zips_count = 0;
+    return count;
+}
+
+// the keyboard asks what to do with a zip that is already there, so saving needs the console
+#ifdef __3DS__
 static SwkbdCallbackResult fat32filter(void * user, const char ** ppMessage, const char * text, size_t textlen)
 {
     (void)textlen;
@@ -614,12 +847,11 @@ renamed:
 
     DEBUG("path: %s\n", path_to_file);
     u16 utf16path[0x106] = {0};
-    utf8_to_utf16(utf16path, (u8 *) path_to_file, 0x106);
-    FS_Path path = fsMakePath(PATH_UTF16, utf16path);
+    utf8_to_utf16(utf16path, (u8 *) path_to_file, 0x105);
 
     // check if file already exists, and if it does, prompt the user
     // to overwrite or change name (or exit)
-    Result res = FSUSER_CreateFile(ArchiveSD, path, 0, size);
+    Result res = platform_file_create(PLATFORM_ARCHIVE_SD, utf16path, size);
     if (R_FAILED(res))
     {
         if (res == (long)0xC82044BE)
@@ -673,6 +905,22 @@ renamed:
     }
 
     DEBUG("Saving to SD: %s\n", path_to_file);
-    remake_file(path, ArchiveSD, size);
-    buf_to_file(size, path, ArchiveSD, buf);
+    zip_index_forget(utf16path);
+    if(R_FAILED(write_file(utf16path, PLATFORM_ARCHIVE_SD, buf, size, size)))
+        return;
+
+    if(mode == REMOTE_MODE_BADGES || saved_zips_count < 0)
+        return;
+    if(saved_zips_count == SAVED_ZIPS_MAX)
+    {
+        saved_zips_count = -1;
+        return;
+    }
+
+    Saved_Zip_s * saved = &saved_zips[saved_zips_count++];
+    memset(saved, 0, sizeof(Saved_Zip_s));
+    saved->mode = mode;
+    saved->size = size;
+    utf8_to_utf16(saved->name, (u8 *)curr_filename, 0x105);
 }
+#endif
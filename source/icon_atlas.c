@@ -0,0 +1,350 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include "icon_atlas.h"
+#include "fs.h"
+#include "unicode.h"
+
+#define ICON_ATLAS_MAGIC 0x4E434941 // AICN
+#define ICON_ATLAS_VERSION 1
+#define NO_SLOT -1
+
+// followed by slots_count records, in the records file
+typedef struct {
+    u32 magic;
+    u32 version;
+    u32 slots_count;
+} Icon_Atlas_Header_s;
+
+static void get_atlas_path(u16 * out, EntryMode mode, const char * extension)
+{
+    char path[0x80];
+    sprintf(path, "/3ds/" APP_TITLE "/cache/icons_%d.%s", mode, extension);
+    out[0] = 0;
+    struacat(out, path);
+}
+
+// entries under different roots can have the same path
+static u32 hash_entry(const Entry_s * entry)
+{
+    u32 hash = 2166136261u;
+    for(const char * c = entry->folder; *c != '\0'; c++)
+        hash = (hash ^ (u8)*c) * 16777619u;
+    for(const u16 * c = entry->path; *c != 0; c++)
+        hash = (hash ^ *c) * 16777619u;
+    return hash;
+}
+
+static s32 get_slot(const Icon_Atlas_s * atlas, const Entry_s * entry)
+{
+    return entry->id < atlas->ids_capacity ? atlas->slot_of[entry->id] : NO_SLOT;
+}
+
+static bool load_records(Icon_Atlas_s * atlas)
+{
+    u16 path[0x80];
+    get_atlas_path(path, atlas->mode, "idx");
+    char * buf = NULL;
+    const u32 size = file_to_buf(path, PLATFORM_ARCHIVE_SD, &buf);
+
+    Icon_Atlas_Header_s header = {0};
+    if(size >= sizeof(header))
+        memcpy(&header, buf, sizeof(header));
+
+    u64 icons_size = 0;
+    platform_file_get_size(atlas->file, &icons_size);
+    if(header.magic != ICON_ATLAS_MAGIC || header.version != ICON_ATLAS_VERSION
+        || size < sizeof(header) + header.slots_count * sizeof(Icon_Atlas_Record_s)
+        || icons_size < (u64)header.slots_count * ICON_ATLAS_ICON_SIZE)
+    {
+        if(size != 0)
+            DEBUG("Ignoring outdated icon atlas %s\n", path);
+        header.slots_count = 0;
+    }
+
+    atlas->slots_capacity = max(header.slots_count, 16);
+    atlas->records = malloc(atlas->slots_capacity * sizeof(Icon_Atlas_Record_s));
+    atlas->free_slots = malloc(atlas->slots_capacity * sizeof(u32));
+    if(atlas->records == NULL || atlas->free_slots == NULL)
+    {
+        free(buf);
+        return false;
+    }
+
+    if(header.slots_count != 0)
+        memcpy(atlas->records, buf + sizeof(header), header.slots_count * sizeof(Icon_Atlas_Record_s));
+    atlas->slots_count = header.slots_count;
+    free(buf);
+    return true;
+}
+
+// every entry gets the slot whose record has its key, size and mtime, the slots nobody got can be reused
+static bool match_entries(Icon_Atlas_s * atlas, Entry_List_s * list)
+{
+    u32 table_size = 1;
+    while(table_size < atlas->slots_count * 2)
+        table_size <<= 1;
+    const u32 mask = table_size - 1;
+
+    u32 * const table = calloc(table_size, sizeof(u32)); // slot + 1, 0 for empty
+    bool * const claimed = calloc(max(atlas->slots_count, 1), sizeof(bool));
+    if(table == NULL || claimed == NULL)
+    {
+        free(table);
+        free(claimed);
+        return false;
+    }
+
+    for(u32 i = 0; i < atlas->slots_count; i++)
+    {
+        u32 bucket = atlas->records[i].key & mask;
+        while(table[bucket] != 0)
+            bucket = (bucket + 1) & mask;
+        table[bucket] = i + 1;
+    }
+
+    Entry_Walk_s walk;
+    list_walk_start(&walk, list);
+    for(int i = 0; i < list->entries_count && atlas->slots_count != 0; i++)
+    {
+        const Entry_s * const entry = list_walk_entry(&walk, i);
+        const u32 key = hash_entry(entry);
+        for(u32 bucket = key & mask; table[bucket] != 0; bucket = (bucket + 1) & mask)
+        {
+            const u32 slot = table[bucket] - 1;
+            const Icon_Atlas_Record_s * const record = &atlas->records[slot];
+            if(claimed[slot] || record->key != key || record->file_size != entry->file_size || record->mtime != entry->mtime)
+                continue;
+
+            claimed[slot] = true;
+            atlas->slot_of[entry->id] = slot;
+            break;
+        }
+    }
+    list_walk_end(&walk);
+
+    for(u32 i = 0; i < atlas->slots_count; i++)
+    {
+        if(!claimed[i])
+            atlas->free_slots[atlas->free_count++] = i;
+    }
+
+    free(table);
+    free(claimed);
+    return true;
+}
+
+void icon_atlas_open(Icon_Atlas_s * atlas, Entry_List_s * list)
+{
+    memset(atlas, 0, sizeof(Icon_Atlas_s));
+    platform_mutex_init(&atlas->lock);
+    atlas->mode = list->mode;
+
+    u16 path[0x80];
+    get_atlas_path(path, atlas->mode, "bin");
+
+    Result res = platform_file_open(&atlas->file, PLATFORM_ARCHIVE_SD, path, PLATFORM_OPEN_READ | PLATFORM_OPEN_WRITE);
+    if(R_FAILED(res))
+    {
+        platform_file_create(PLATFORM_ARCHIVE_SD, path, 0);
+        res = platform_file_open(&atlas->file, PLATFORM_ARCHIVE_SD, path, PLATFORM_OPEN_READ | PLATFORM_OPEN_WRITE);
+    }
+    if(R_FAILED(res))
+    {
+        DEBUG("Failed to open icon atlas %d: 0x%08lx\n", atlas->mode, res);
+        return;
+    }
+    atlas->opened = true;
+
+    atlas->ids_capacity = max(list->entries_count, 1);
+    atlas->slot_of = malloc(atlas->ids_capacity * sizeof(s32));
+    if(atlas->slot_of != NULL)
+    {
+        for(u32 i = 0; i < atlas->ids_capacity; i++)
+            atlas->slot_of[i] = NO_SLOT;
+    }
+
+    if(atlas->slot_of == NULL || !load_records(atlas) || !match_entries(atlas, list))
+    {
+        DEBUG("Not enough memory for the icon atlas\n");
+        atlas->dirty = false;
+        icon_atlas_close(atlas);
+    }
+}
+
+void icon_atlas_close(Icon_Atlas_s * atlas)
+{
+    if(atlas->opened)
+    {
+        platform_file_close(atlas->file);
+
+        // the icons are written as they come, the records only once they all are
+        const u32 size = sizeof(Icon_Atlas_Header_s) + atlas->slots_count * sizeof(Icon_Atlas_Record_s);
+        char * buf = atlas->dirty ? malloc(size) : NULL;
+        if(buf != NULL)
+        {
+            const Icon_Atlas_Header_s header = {
+                .magic = ICON_ATLAS_MAGIC,
+                .version = ICON_ATLAS_VERSION,
+                .slots_count = atlas->slots_count,
+            };
+            memcpy(buf, &header, sizeof(header));
+            memcpy(buf + sizeof(header), atlas->records, atlas->slots_count * sizeof(Icon_Atlas_Record_s));
+
+            u16 path[0x80];
+            get_atlas_path(path, atlas->mode, "idx");
+            write_file(path, PLATFORM_ARCHIVE_SD, buf, size, size);
+            free(buf);
+        }
+    }
+
+    free(atlas->records);
+    free(atlas->slot_of);
+    free(atlas->free_slots);
+    memset(atlas, 0, sizeof(Icon_Atlas_s));
+}
+
+int icon_atlas_read_run(Icon_Atlas_s * atlas, Entry_s * const * entries, int count, u16 * icons)
+{
+    if(!atlas->opened || count == 0)
+        return 0;
+
+    platform_mutex_lock(&atlas->lock);
+    const s32 first = get_slot(atlas, entries[0]);
+    int run = 0;
+    if(first != NO_SLOT)
+    {
+        run = 1;
+        while(run < count && get_slot(atlas, entries[run]) == first + run)
+            run++;
+
+        const u32 size = run * ICON_ATLAS_ICON_SIZE;
+        u32 read = 0;
+        if(R_FAILED(platform_file_read(atlas->file, (u64)first * ICON_ATLAS_ICON_SIZE, icons, size, &read)) || read != size)
+            run = 0;
+    }
+    platform_mutex_unlock(&atlas->lock);
+
+    return run;
+}
+
+static bool grow_ids(Icon_Atlas_s * atlas, u32 id)
+{
+    const u32 capacity = max(id + 1, atlas->ids_capacity * 2);
+    s32 * const slot_of = realloc(atlas->slot_of, capacity * sizeof(s32));
+    if(slot_of == NULL)
+        return false;
+
+    for(u32 i = atlas->ids_capacity; i < capacity; i++)
+        slot_of[i] = NO_SLOT;
+    atlas->slot_of = slot_of;
+    atlas->ids_capacity = capacity;
+    return true;
+}
+
+static bool grow_slots(Icon_Atlas_s * atlas)
+{
+    const u32 capacity = atlas->slots_capacity * 2;
+    Icon_Atlas_Record_s * const records = realloc(atlas->records, capacity * sizeof(Icon_Atlas_Record_s));
+    if(records == NULL)
+        return false;
+    atlas->records = records;
+
+    u32 * const free_slots = realloc(atlas->free_slots, capacity * sizeof(u32));
+    if(free_slots == NULL)
+        return false;
+    atlas->free_slots = free_slots;
+
+    atlas->slots_capacity = capacity;
+    return true;
+}
+
+void icon_atlas_store(Icon_Atlas_s * atlas, const Entry_s * entry, const u16 * big_icon)
+{
+    if(!atlas->opened)
+        return;
+
+    platform_mutex_lock(&atlas->lock);
+    if(entry->id >= atlas->ids_capacity && !grow_ids(atlas, entry->id))
+    {
+        platform_mutex_unlock(&atlas->lock);
+        return;
+    }
+
+    s32 slot = atlas->slot_of[entry->id];
+    if(slot == NO_SLOT)
+    {
+        if(atlas->free_count != 0)
+        {
+            slot = atlas->free_slots[--atlas->free_count];
+        }
+        else if(atlas->slots_count < atlas->slots_capacity || grow_slots(atlas))
+        {
+            slot = atlas->slots_count++;
+        }
+        else
+        {
+            platform_mutex_unlock(&atlas->lock);
+            return;
+        }
+    }
+
+    // the slot is for nobody until its icon is there
+    memset(&atlas->records[slot], 0, sizeof(Icon_Atlas_Record_s));
+    atlas->slot_of[entry->id] = NO_SLOT;
+    atlas->dirty = true;
+
+    u32 written = 0;
+    if(R_SUCCEEDED(platform_file_write(atlas->file, (u64)slot * ICON_ATLAS_ICON_SIZE, big_icon, ICON_ATLAS_ICON_SIZE, &written)) && written == ICON_ATLAS_ICON_SIZE)
+    {
+        atlas->records[slot].key = hash_entry(entry);
+        atlas->records[slot].file_size = entry->file_size;
+        atlas->records[slot].mtime = entry->mtime;
+        atlas->slot_of[entry->id] = slot;
+    }
+    else
+    {
+        atlas->free_slots[atlas->free_count++] = slot;
+    }
+    platform_mutex_unlock(&atlas->lock);
+}
+
+void icon_atlas_forget(Icon_Atlas_s * atlas, const Entry_s * entry)
+{
+    if(!atlas->opened)
+        return;
+
+    platform_mutex_lock(&atlas->lock);
+    const s32 slot = get_slot(atlas, entry);
+    if(slot != NO_SLOT)
+    {
+        memset(&atlas->records[slot], 0, sizeof(Icon_Atlas_Record_s));
+        atlas->free_slots[atlas->free_count++] = slot;
+        atlas->slot_of[entry->id] = NO_SLOT;
+        atlas->dirty = true;
+    }
+    platform_mutex_unlock(&atlas->lock);
+}
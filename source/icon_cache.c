@@ -0,0 +1,248 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include "icon_cache.h"
+#include "loading.h"
+
+#define NO_SLOT -1
+
+typedef struct {
+    const u16 * key; // path of the entry, which stays with it when the list is sorted. NULL for a slot that was forgotten, it goes first
+    int prev, next; // towards the most and least recently used
+    int chain; // next slot in the same bucket
+} Icon_Cache_Slot_s;
+
+static u16 * blocks;
+static Icon_Cache_Slot_s * slots;
+static int * buckets;
+static u32 buckets_mask;
+static int most_recent = NO_SLOT, least_recent = NO_SLOT;
+static Icon_Cache_Stats_s cache_stats;
+static Platform_Mutex cache_lock;
+
+static u32 hash_key(const u16 * key)
+{
+    return (((uintptr_t)key >> 1) * 2654435761u) & buckets_mask;
+}
+
+static int find_slot(const Entry_s * entry)
+{
+    int slot = buckets[hash_key(entry->path)];
+    while(slot != NO_SLOT && slots[slot].key != entry->path)
+        slot = slots[slot].chain;
+    return slot;
+}
+
+static void unlink_bucket(int slot)
+{
+    int * link = &buckets[hash_key(slots[slot].key)];
+    while(*link != slot)
+        link = &slots[*link].chain;
+    *link = slots[slot].chain;
+    slots[slot].key = NULL;
+}
+
+static void unlink_slot(int slot)
+{
+    Icon_Cache_Slot_s * const current = &slots[slot];
+    if(current->prev != NO_SLOT)
+        slots[current->prev].next = current->next;
+    else
+        most_recent = current->next;
+    if(current->next != NO_SLOT)
+        slots[current->next].prev = current->prev;
+    else
+        least_recent = current->prev;
+}
+
+static void push_most_recent(int slot)
+{
+    slots[slot].prev = NO_SLOT;
+    slots[slot].next = most_recent;
+    if(most_recent != NO_SLOT)
+        slots[most_recent].prev = slot;
+    most_recent = slot;
+    if(least_recent == NO_SLOT)
+        least_recent = slot;
+}
+
+static void push_least_recent(int slot)
+{
+    slots[slot].next = NO_SLOT;
+    slots[slot].prev = least_recent;
+    if(least_recent != NO_SLOT)
+        slots[least_recent].next = slot;
+    least_recent = slot;
+    if(most_recent == NO_SLOT)
+        most_recent = slot;
+}
+
+void icon_cache_init(u32 budget_kib)
+{
+    platform_mutex_init(&cache_lock);
+    memset(&cache_stats, 0, sizeof(Icon_Cache_Stats_s));
+
+    const u32 capacity = budget_kib * 1024 / ICON_CACHE_BLOCK_SIZE;
+    if(capacity == 0)
+        return;
+
+    // at least twice as many buckets as slots, so the chains stay short
+    u32 buckets_count = 1;
+    while(buckets_count < capacity * 2)
+        buckets_count <<= 1;
+
+    blocks = malloc(capacity * ICON_CACHE_BLOCK_SIZE);
+    slots = malloc(capacity * sizeof(Icon_Cache_Slot_s));
+    buckets = malloc(buckets_count * sizeof(int));
+    if(blocks == NULL || slots == NULL || buckets == NULL)
+    {
+        DEBUG("icon cache: not enough memory for %lu icons\n", capacity);
+        free(blocks);
+        free(slots);
+        free(buckets);
+        blocks = NULL;
+        slots = NULL;
+        buckets = NULL;
+        return;
+    }
+
+    buckets_mask = buckets_count - 1;
+    cache_stats.capacity = capacity;
+    icon_cache_clear();
+}
+
+void icon_cache_exit(void)
+{
+    platform_mutex_lock(&cache_lock);
+    DEBUG("icon cache: %lu hits, %lu misses, %lu evictions, %lu/%lu icons\n", cache_stats.hits, cache_stats.misses, cache_stats.evictions, cache_stats.used, cache_stats.capacity);
+    free(blocks);
+    free(slots);
+    free(buckets);
+    blocks = NULL;
+    slots = NULL;
+    buckets = NULL;
+    cache_stats.capacity = 0;
+    cache_stats.used = 0;
+    most_recent = NO_SLOT;
+    least_recent = NO_SLOT;
+    platform_mutex_unlock(&cache_lock);
+}
+
+void icon_cache_clear(void)
+{
+    platform_mutex_lock(&cache_lock);
+    for(u32 i = 0; i <= buckets_mask && buckets != NULL; i++)
+        buckets[i] = NO_SLOT;
+    cache_stats.used = 0;
+    most_recent = NO_SLOT;
+    least_recent = NO_SLOT;
+    platform_mutex_unlock(&cache_lock);
+}
+
+bool icon_cache_copy(const Entry_s * entry, C3D_Tex * texture, const Entry_Icon_s * icon)
+{
+    if(cache_stats.capacity == 0)
+        return false;
+
+    platform_mutex_lock(&cache_lock);
+    const int slot = find_slot(entry);
+    if(slot != NO_SLOT)
+    {
+        cache_stats.hits++;
+        unlink_slot(slot);
+        push_most_recent(slot);
+        copy_texture_data(texture, blocks + slot * (ICON_CACHE_BLOCK_SIZE / sizeof(u16)), icon);
+    }
+    else
+    {
+        cache_stats.misses++;
+    }
+    platform_mutex_unlock(&cache_lock);
+
+    return slot != NO_SLOT;
+}
+
+void icon_cache_add(const Entry_s * entry, const u16 * big_icon)
+{
+    if(cache_stats.capacity == 0)
+        return;
+
+    platform_mutex_lock(&cache_lock);
+    int slot = find_slot(entry);
+    if(slot != NO_SLOT)
+    {
+        unlink_slot(slot);
+    }
+    else
+    {
+        if(cache_stats.used < cache_stats.capacity)
+        {
+            slot = cache_stats.used++;
+        }
+        else
+        {
+            slot = least_recent;
+            unlink_slot(slot);
+            if(slots[slot].key != NULL)
+            {
+                unlink_bucket(slot);
+                cache_stats.evictions++;
+            }
+        }
+
+        const u32 bucket = hash_key(entry->path);
+        slots[slot].key = entry->path;
+        slots[slot].chain = buckets[bucket];
+        buckets[bucket] = slot;
+    }
+
+    memcpy(blocks + slot * (ICON_CACHE_BLOCK_SIZE / sizeof(u16)), big_icon, ICON_CACHE_BLOCK_SIZE);
+    push_most_recent(slot);
+    platform_mutex_unlock(&cache_lock);
+}
+
+void icon_cache_forget(const Entry_s * entry)
+{
+    if(cache_stats.capacity == 0)
+        return;
+
+    platform_mutex_lock(&cache_lock);
+    const int slot = find_slot(entry);
+    if(slot != NO_SLOT)
+    {
+        unlink_bucket(slot);
+        unlink_slot(slot);
+        push_least_recent(slot);
+    }
+    platform_mutex_unlock(&cache_lock);
+}
+
+void icon_cache_get_stats(Icon_Cache_Stats_s * stats)
+{
+    platform_mutex_lock(&cache_lock);
+    memcpy(stats, &cache_stats, sizeof(Icon_Cache_Stats_s));
+    platform_mutex_unlock(&cache_lock);
+}
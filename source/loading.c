@@ -31,7 +31,12 @@
 #include "draw.h"
 #include "conversion.h"
 #include "ui_strings.h"
+#include "pool.h"
+#include "entries_index.h"
+#include "icon_cache.h"
+#include "icon_atlas.h"
 
+#include <stddef.h>
 #include <png.h>
 
 void copy_texture_data(C3D_Tex * texture, const u16 * src, const Entry_Icon_s * current_icon)
@@ -45,53 +50,181 @@ void copy_texture_data(C3D_Tex * texture, const u16 * src, const Entry_Icon_s *
         src += 48 * 8;
         dest += texture->width * 8;
     }
+}
+
+void flush_texture_data(C3D_Tex * texture)
+{
     GSPGPU_InvalidateDataCache(texture->data, texture->size);
 }
 
-void parse_smdh(Icon_s * icon, Entry_s * entry, const u16 * fallback_name)
+// for entries whose info.smdh wasn't read yet
+static void fill_pending_entry(Entry_List_s * list, u32 id, const u16 * path, Icon_s * icon)
 {
-    if(icon == NULL)
+    platform_mutex_lock(&list->info_lock);
+    // path is the one the entry had, the list may have been loaded again since
+    Entry_s * const entry = id < (u32)list->entries_count ? get_entry_at(list, id) : NULL;
+    if(entry != NULL && entry->info_pending && entry->path == path)
     {
-        memcpy(entry->name, fallback_name, 0x80);
-        utf8_to_utf16(entry->desc, (u8 *)"No description", 0x100);
-        utf8_to_utf16(entry->author, (u8 *)"Unknown author", 0x80);
-        entry->placeholder_color = C2D_Color32(rand() % 255, rand() % 255, rand() % 255, 255);
-        return;
+        parse_smdh(icon, entry, entry->path, list_entry_strings(list, entry));
+        entry->info_pending = false;
+        list->info_parsed++;
+        list->info_generation++;
     }
-
-    memcpy(entry->name, icon->name, 0x40 * sizeof(u16));
-    memcpy(entry->desc, icon->desc, 0x80 * sizeof(u16));
-    memcpy(entry->author, icon->author, 0x40 * sizeof(u16));
-    entry->placeholder_color = 0;
+    platform_mutex_unlock(&list->info_lock);
 }
 
 static Icon_s * load_entry_icon(const Entry_s * entry)
 {
     char * info_buffer = NULL;
-    u32 size = load_data("/info.smdh", entry, &info_buffer);
+    u32 size = load_pooled_data("/info.smdh", entry, &info_buffer);
     if(size != sizeof(Icon_s))
     {
-        free(info_buffer);
+        pool_free(info_buffer);
         return NULL;
     }
 
     return (Icon_s *)info_buffer;
 }
 
+// from the atlas if it's there, otherwise from the smdh, which fills the info of the entry too if it was pending.
+// entry is a copy of the one in the list, see load_job_icon. Returns an icon from the pool, NULL if the entry has none
+static u16 * read_entry_icon(Entry_List_s * list, Entry_s * entry)
+{
+    u16 * const icon = pool_alloc(ICON_ATLAS_ICON_SIZE);
+    if(icon == NULL)
+        return NULL;
+
+    if(icon_atlas_read_run(&list->icon_atlas, &entry, 1, icon) == 1)
+    {
+        icon_cache_add(entry, icon);
+        return icon;
+    }
+
+    Icon_s * const smdh = load_entry_icon(entry);
+    if(entry->info_pending)
+        fill_pending_entry(list, entry->id, entry->path, smdh);
+    if(smdh == NULL)
+    {
+        pool_free(icon);
+        return NULL;
+    }
+
+    memcpy(icon, smdh->big_icon, ICON_ATLAS_ICON_SIZE);
+    pool_free(smdh);
+    icon_cache_add(entry, icon);
+    icon_atlas_store(&list->icon_atlas, entry, icon);
+    return icon;
+}
+
+static int get_ring_size(const Entry_List_s * list)
+{
+    return ICONS_OFFSET_AMOUNT * list->entries_loaded;
+}
+
+// the jobs given out for the cell are dropped when they come back
+static void cancel_icon(Entry_List_s * list, int slot)
+{
+    Icon_Cell_s * const cell = &list->icon_cells[slot];
+    if(cell->state == ICON_CELL_WANTED)
+        list->icons_wanted--;
+    cell->job = ++list->last_icon_job;
+    cell->state = ICON_CELL_EMPTY;
+}
+
+static void set_icon_loaded(Entry_List_s * list, int slot, Entry_s * entry)
+{
+    if(list->icon_cells == NULL)
+        return;
+
+    cancel_icon(list, slot);
+    Icon_Cell_s * const cell = &list->icon_cells[slot];
+    cell->id = entry->id;
+    cell->state = ICON_CELL_LOADED;
+}
+
+static void push_icon_job(Entry_List_s * list, int slot)
+{
+    Icon_Cell_s * const cell = &list->icon_cells[slot];
+    const Icon_Job_s job = {
+        .list = list,
+        .id = cell->id,
+        .job = cell->job,
+        .slot = slot,
+    };
+
+    if(spsc_queue_push(&list->icon_loader->jobs, &job))
+    {
+        if(cell->state == ICON_CELL_WANTED)
+            list->icons_wanted--;
+        cell->state = ICON_CELL_QUEUED;
+        platform_event_signal(&list->icon_loader->wake);
+    }
+    else if(cell->state != ICON_CELL_WANTED)
+    {
+        cell->state = ICON_CELL_WANTED;
+        list->icons_wanted++;
+    }
+}
+
+// the cell is for entry from now on: it gets its icon right away if it's in the cache, otherwise once the icon thread read it
+static void want_icon(Entry_List_s * list, int slot, Entry_s * entry)
+{
+    cancel_icon(list, slot);
+    Icon_Cell_s * const cell = &list->icon_cells[slot];
+    cell->id = entry->id;
+
+    if(icon_cache_copy(entry, &list->icons_texture, &list->icons_info[slot]))
+    {
+        cell->state = ICON_CELL_LOADED;
+        list->icons_to_flush = true;
+    }
+    else
+    {
+        push_icon_job(list, slot);
+    }
+}
+
+static void reset_icon_cells(Entry_List_s * list)
+{
+    if(list->icon_cells == NULL)
+        return;
+
+    for(int i = 0; i < get_ring_size(list) + list->icons_spare; i++)
+        cancel_icon(list, i);
+    for(int i = 0; i < list->icons_spare; i++)
+        list->prefetch_slots[i].position = -1;
+}
+
+// on the main thread, when it has to wait for the icon anyway
+static void load_icon(Entry_List_s * list, Entry_s * entry, int slot)
+{
+    if(!icon_cache_copy(entry, &list->icons_texture, &list->icons_info[slot]))
+    {
+        u16 * const icon = read_entry_icon(list, entry);
+        if(icon != NULL)
+            copy_texture_data(&list->icons_texture, icon, &list->icons_info[slot]);
+        pool_free(icon);
+    }
+    set_icon_loaded(list, slot, entry);
+}
+
 void load_icons_first(Entry_List_s * list, bool silent)
 {
     if(list == NULL || list->entries == NULL) return;
 
-    if(!silent)
-        draw_install(INSTALL_LOADING_ICONS);
+    const int count = list_get_count(list);
+
+    // everything is loaded again, in order
+    list->icons_head = 0;
+    reset_icon_cells(list);
 
     int starti = 0, endi = 0;
 
-    if(list->entries_count <= list->entries_loaded * ICONS_OFFSET_AMOUNT)
+    if(count <= list->entries_loaded * ICONS_OFFSET_AMOUNT)
     {
         DEBUG("small load\n");
         // if the list is one that doesnt need swapping, load everything at once
-        endi = list->entries_count;
+        endi = count;
     }
     else
     {
@@ -101,60 +234,89 @@ void load_icons_first(Entry_List_s * list, bool silent)
         endi = starti + list->entries_loaded * ICONS_OFFSET_AMOUNT;
     }
 
+    const int total = endi - starti;
+    Entry_s ** const entries = malloc(max(total, 1) * sizeof(Entry_s *));
+    if(entries == NULL)
+        return;
+
     for(int entry_i = starti, icon_i = 0; entry_i < endi; ++entry_i, ++icon_i)
     {
-        if(!silent)
-            draw_loading_bar(icon_i, endi-starti, INSTALL_LOADING_ICONS);
-
         int offset = entry_i;
         if(offset < 0)
-            offset += list->entries_count;
-        if(offset >= list->entries_count)
-            offset -= list->entries_count;
+            offset += count;
+        if(offset >= count)
+            offset -= count;
 
-        Entry_s * const current_entry = &list->entries[offset];
-        Icon_s * const smdh = load_entry_icon(current_entry);
-        if(smdh != NULL)
+        entries[icon_i] = list_get_entry(list, offset);
+    }
+
+    // nothing to wait for, the icon thread gets them, the visible ones first
+    if(silent && list->icon_loader != NULL && count > list->entries_loaded * ICONS_OFFSET_AMOUNT)
+    {
+        for(int i = 0; i < total; i++)
+        {
+            const int icon_i = (i + list->entries_loaded * ICONS_VISIBLE) % total;
+            want_icon(list, icon_i, entries[icon_i]);
+        }
+        free(entries);
+
+        if(list->icons_to_flush)
         {
-            if(current_entry->placeholder_color == 0)
-                parse_smdh(smdh, current_entry, current_entry->path + strlen(list->loading_path));
-            copy_texture_data(&list->icons_texture, smdh->big_icon, &list->icons_info[icon_i]);
-            free(smdh);
+            flush_texture_data(&list->icons_texture);
+            list->icons_to_flush = false;
         }
+        return;
     }
-}
 
-static void reverse(Entry_Icon_s a[], int sz) {
-    int i, j;
-    Entry_Icon_s tmp;
-    for (i = 0, j = sz; i < j; i++, j--) {
-        memcpy(&tmp, &a[i], sizeof(Entry_Icon_s));
-        memcpy(&a[i], &a[j], sizeof(Entry_Icon_s));
-        memcpy(&a[j], &tmp, sizeof(Entry_Icon_s));
+    if(!silent)
+        draw_install(INSTALL_LOADING_ICONS);
+
+    // the icons that were in consecutive slots of the atlas last time are read together
+    u16 * const atlas_icons = pool_alloc(max(total, 1) * ICON_ATLAS_ICON_SIZE);
+    for(int icon_i = 0; icon_i < total;)
+    {
+        if(!silent)
+            draw_loading_bar(icon_i, total, INSTALL_LOADING_ICONS);
+
+        int read = 0;
+        if(atlas_icons != NULL)
+            read = icon_atlas_read_run(&list->icon_atlas, &entries[icon_i], total - icon_i, atlas_icons);
+
+        for(int i = 0; i < read; i++)
+        {
+            const u16 * const atlas_icon = atlas_icons + i * (ICON_ATLAS_ICON_SIZE / sizeof(u16));
+            copy_texture_data(&list->icons_texture, atlas_icon, &list->icons_info[icon_i + i]);
+            icon_cache_add(entries[icon_i + i], atlas_icon);
+            set_icon_loaded(list, icon_i + i, entries[icon_i + i]);
+        }
+
+        if(read == 0)
+        {
+            load_icon(list, entries[icon_i], icon_i);
+            read = 1;
+        }
+        icon_i += read;
     }
-}
+    pool_free(atlas_icons);
+    free(entries);
 
-static void rotate(Entry_Icon_s array[], int size, int amt) {
-    if (amt < 0)
-        amt = size + amt;
-    reverse(array, size-amt-1);
-    reverse(array+size-amt, amt-1);
-    reverse(array, size-1);
+    flush_texture_data(&list->icons_texture);
 }
 
 void handle_scrolling(Entry_List_s * list)
 {
     // Scroll the menu up or down if the selected theme is out of its bounds
     //----------------------------------------------------------------
-    if(list->entries_count > list->entries_loaded)
+    const int count = list_get_count(list);
+    if(count > list->entries_loaded)
     {
         int change = 0;
 
-        if(list->entries_count > list->entries_loaded * 2 && list->previous_scroll < list->entries_loaded && list->selected_entry >= list->entries_count - list->entries_loaded)
+        if(count > list->entries_loaded * 2 && list->previous_scroll < list->entries_loaded && list->selected_entry >= count - list->entries_loaded)
         {
-            list->scroll = list->entries_count - list->entries_loaded;
+            list->scroll = count - list->entries_loaded;
         }
-        else if(list->entries_count > list->entries_loaded * 2 && list->selected_entry < list->entries_loaded && list->previous_selected >= list->entries_count - list->entries_loaded)
+        else if(count > list->entries_loaded * 2 && list->selected_entry < list->entries_loaded && list->previous_selected >= count - list->entries_loaded)
         {
             list->scroll = 0;
         }
@@ -183,8 +345,8 @@ void handle_scrolling(Entry_List_s * list)
 
         if(list->scroll < 0)
             list->scroll = 0;
-        else if(list->scroll > list->entries_count - list->entries_loaded)
-            list->scroll = list->entries_count - list->entries_loaded;
+        else if(list->scroll > count - list->entries_loaded)
+            list->scroll = count - list->entries_loaded;
 
         if(!change)
             list->previous_selected = list->selected_entry;
@@ -194,23 +356,129 @@ void handle_scrolling(Entry_List_s * list)
     //----------------------------------------------------------------
 }
 
-static bool load_icons(Entry_List_s * current_list, Handle mutex)
+#define SIGN(x) (x > 0 ? 1 : ((x < 0) ? -1 : 0))
+
+// icons are loaded ahead for as far as the scrolling goes in this long
+#define PREFETCH_AHEAD_US 500000
+
+static void clear_prefetch(Entry_List_s * list)
 {
-    if(current_list == NULL || current_list->entries == NULL)
-        return false;
+    const int ring = get_ring_size(list);
+    for(int i = 0; i < list->icons_spare; i++)
+    {
+        list->prefetch_slots[i].position = -1;
+        cancel_icon(list, ring + i);
+    }
+}
 
-    handle_scrolling(current_list);
+static void update_scroll_rate(Entry_List_s * list, int delta)
+{
+    const u64 now = platform_ticks();
+    const u64 elapsed_us = max(platform_ticks_to_us(now - list->last_scroll_tick), 1);
+    list->last_scroll_tick = now;
+    const float rate = abs(delta) * 1e6f / elapsed_us;
 
-    if(current_list->entries_count <= current_list->entries_loaded * ICONS_OFFSET_AMOUNT || current_list->previous_scroll == current_list->scroll)
-        return false; // return if the list is one that doesnt need swapping, or if nothing changed
+    // going the other way, what was loaded ahead is behind now
+    if(SIGN(delta) != list->scroll_direction)
+    {
+        list->scroll_direction = SIGN(delta);
+        list->scroll_rate = rate;
+        clear_prefetch(list);
+    }
+    // after a pause, only the new speed matters
+    else if(elapsed_us > 1000000)
+    {
+        list->scroll_rate = rate;
+    }
+    else
+    {
+        list->scroll_rate = (list->scroll_rate + rate) / 2;
+    }
+}
 
-    #define SIGN(x) (x > 0 ? 1 : ((x < 0) ? -1 : 0))
+// an icon that was loaded ahead only has to be swapped into the ring
+static bool take_prefetched_icon(Entry_List_s * list, int position, int id, int slot)
+{
+    const int ring = get_ring_size(list);
+    for(int i = 0; i < list->icons_spare; i++)
+    {
+        Icon_Prefetch_Slot_s * const prefetched = &list->prefetch_slots[i];
+        if(prefetched->position != position || prefetched->id != id || list->icon_cells[ring + i].state != ICON_CELL_LOADED)
+            continue;
+
+        cancel_icon(list, slot);
+
+        const Entry_Icon_s icon = list->icons_info[slot];
+        list->icons_info[slot] = list->icons_info[ring + i];
+        list->icons_info[ring + i] = icon;
+
+        const Icon_Cell_s cell = list->icon_cells[slot];
+        list->icon_cells[slot] = list->icon_cells[ring + i];
+        list->icon_cells[ring + i] = cell;
+
+        prefetched->position = -1;
+        return true;
+    }
+    return false;
+}
 
-    int delta = current_list->scroll - current_list->previous_scroll;
-    if(abs(delta) >= current_list->entries_count - current_list->entries_loaded * (ICONS_OFFSET_AMOUNT-1))
-        delta = -SIGN(delta) * (current_list->entries_count - abs(delta));
+// picks the icons past the ring in the direction of the scrolling, as many as it goes through in PREFETCH_AHEAD_US
+static void plan_prefetch(Entry_List_s * list, int count)
+{
+    const int ring = get_ring_size(list);
+    const int ahead = min((int)(list->scroll_rate * PREFETCH_AHEAD_US / 1e6f), min(list->icons_spare, count - ring));
+    const int ring_start = list->scroll - list->entries_loaded * ICONS_VISIBLE;
+    const int first = list->scroll_direction > 0 ? ring_start + ring : ring_start - 1;
+
+    for(int i = 0; i < list->icons_spare; i++)
+    {
+        Icon_Prefetch_Slot_s * const prefetched = &list->prefetch_slots[i];
+        if(prefetched->position < 0)
+            continue;
+
+        // the distance past the ring, in the direction of the scrolling
+        int distance = (prefetched->position - first) * list->scroll_direction;
+        if(distance < 0)
+            distance += count;
+        if(distance >= ahead)
+        {
+            prefetched->position = -1;
+            cancel_icon(list, ring + i);
+        }
+    }
 
-    int starti = current_list->scroll;
+    for(int k = 0, free_slot = 0; k < ahead; k++)
+    {
+        int position = (first + k * list->scroll_direction) % count;
+        if(position < 0)
+            position += count;
+
+        bool planned = false;
+        for(int i = 0; i < list->icons_spare && !planned; i++)
+            planned = list->prefetch_slots[i].position == position;
+        if(planned)
+            continue;
+
+        while(free_slot < list->icons_spare && list->prefetch_slots[free_slot].position >= 0)
+            free_slot++;
+        if(free_slot == list->icons_spare)
+            break;
+
+        Icon_Prefetch_Slot_s * const prefetched = &list->prefetch_slots[free_slot];
+        prefetched->position = position;
+        prefetched->id = list_get_id(list, position);
+        want_icon(list, ring + free_slot, get_entry_at(list, prefetched->id));
+    }
+}
+
+// the icons that scrolled out of the ring become the ones that scrolled in
+static void move_icons(Entry_List_s * list, int count)
+{
+    int delta = list->scroll - list->previous_scroll;
+    if(abs(delta) >= count - list->entries_loaded * (ICONS_OFFSET_AMOUNT-1))
+        delta = -SIGN(delta) * (count - abs(delta));
+
+    int starti = list->scroll;
     int endi = starti + abs(delta);
 
     if(delta < 0)
@@ -219,93 +487,272 @@ static bool load_icons(Entry_List_s * current_list, Handle mutex)
         starti += abs(delta) - 1;
     }
 
-    int ctr = 0;
-    Entry_s ** const entries = calloc(abs(delta), sizeof(Entry_s *));
-    int * const indexes = calloc(abs(delta), sizeof(int));
-    bool released = false;
+    // the others stay where they are
+    const int slots = get_ring_size(list);
+    list->icons_head = ((list->icons_head + delta) % slots + slots) % slots;
 
-    Entry_Icon_s * const icons = current_list->icons_info;
-
-    for(int i = starti; i != endi; i++, ctr++)
+    for(int i = starti; i != endi; i++)
     {
         int index = 0;
         int offset = i;
 
-        rotate(icons, ICONS_OFFSET_AMOUNT * current_list->entries_loaded, -SIGN(delta));
-
         if(delta > 0)
         {
-            index = current_list->entries_loaded * ICONS_OFFSET_AMOUNT - delta + i - starti;
-            offset += current_list->entries_loaded * ICONS_UNDER - delta;
+            index = list->entries_loaded * ICONS_OFFSET_AMOUNT - delta + i - starti;
+            offset += list->entries_loaded * ICONS_UNDER - delta;
         }
         else
         {
             index = 0 - delta - 1 + i - starti;
-            offset -= current_list->entries_loaded * ICONS_VISIBLE;
+            offset -= list->entries_loaded * ICONS_VISIBLE;
             i -= 2; //i-- twice to counter the i++, needed only for this case
         }
 
         if(offset < 0)
-            offset += current_list->entries_count;
-        if(offset >= current_list->entries_count)
-            offset -= current_list->entries_count;
+            offset += count;
+        if(offset >= count)
+            offset -= count;
+
+        Entry_s * const entry = list_get_entry(list, offset);
+        const int slot = get_icon_slot(list, index);
+        if(!take_prefetched_icon(list, offset, entry->id, slot))
+            want_icon(list, slot, entry);
+    }
+
+    if(list->icons_spare != 0)
+    {
+        update_scroll_rate(list, delta);
+        plan_prefetch(list, count);
+    }
 
-        entries[ctr] = &current_list->entries[offset];
-        indexes[ctr] = index;
+    list->previous_scroll = list->scroll;
+}
+
+// the cells the job queue had no room for, the visible ones first
+static void push_wanted_icons(Entry_List_s * list)
+{
+    const int ring = get_ring_size(list);
+    for(int i = 0; i < ring + list->icons_spare && list->icons_wanted != 0; i++)
+    {
+        const int slot = i < ring ? get_icon_slot(list, (i + list->entries_loaded * ICONS_VISIBLE) % ring) : i;
+        if(list->icon_cells[slot].state != ICON_CELL_WANTED)
+            continue;
+
+        push_icon_job(list, slot);
+        if(list->icon_cells[slot].state == ICON_CELL_WANTED)
+            break;
     }
+}
 
-    #undef SIGN
+#define ICON_JOBS_MAX 128
 
-    if(abs(delta) <= current_list->entries_loaded)
+bool icon_loader_init(Icon_Loader_s * loader)
+{
+    platform_event_init(&loader->wake, false);
+    platform_event_init(&loader->drained, false);
+    if(!spsc_queue_init(&loader->jobs, ICON_JOBS_MAX, sizeof(Icon_Job_s)) || !spsc_queue_init(&loader->done, ICON_JOBS_MAX, sizeof(Icon_Job_s)))
     {
-        svcReleaseMutex(mutex);
-        released = true;
+        spsc_queue_free(&loader->jobs);
+        spsc_queue_free(&loader->done);
+        return false;
     }
+    return true;
+}
+
+void icon_loader_clear(Icon_Loader_s * loader)
+{
+    Icon_Job_s job;
+    while(spsc_queue_pop(&loader->jobs, &job));
+    while(spsc_queue_pop(&loader->done, &job))
+        pool_free(job.icon);
+}
+
+void icon_loader_free(Icon_Loader_s * loader)
+{
+    icon_loader_clear(loader);
+    spsc_queue_free(&loader->jobs);
+    spsc_queue_free(&loader->done);
+}
+
+void finish_icon_jobs(Icon_Loader_s * loader)
+{
+    Entry_List_s * to_flush = NULL;
+    bool popped = false;
+    Icon_Job_s job;
+    while(spsc_queue_pop(&loader->done, &job))
+    {
+        popped = true;
+        Entry_List_s * const list = job.list;
+        Icon_Cell_s * const cell = &list->icon_cells[job.slot];
+        if(cell->job == job.job && cell->state == ICON_CELL_QUEUED)
+        {
+            if(job.icon != NULL)
+            {
+                copy_texture_data(&list->icons_texture, job.icon, &list->icons_info[job.slot]);
+                if(to_flush != NULL && to_flush != list)
+                    flush_texture_data(&to_flush->icons_texture);
+                to_flush = list;
+            }
+            cell->state = ICON_CELL_LOADED;
+        }
+        pool_free(job.icon);
+    }
+
+    if(to_flush != NULL)
+        flush_texture_data(&to_flush->icons_texture);
+
+    // the icon thread may be waiting for room to hand back a job
+    if(popped)
+        platform_event_signal(&loader->drained);
+}
 
-    svcSleepThread(1e7);
-    starti = 0;
-    endi = abs(delta);
-    for(int i = starti; i < endi; i++)
+void update_icons(Entry_List_s * list)
+{
+    if(list == NULL || list->entries == NULL || list->icon_loader == NULL)
+        return;
+
+    const int count = list_get_count(list);
+    handle_scrolling(list);
+
+    // nothing to do for a list that doesnt need swapping, or if nothing changed
+    if(count > get_ring_size(list) && list->previous_scroll != list->scroll)
+        move_icons(list, count);
+
+    push_wanted_icons(list);
+    if(list->icons_to_flush)
     {
-        Entry_s * const current_entry = entries[i];
-        const int index = indexes[i];
-        const Entry_Icon_s * const current_icon = &icons[index];
+        flush_texture_data(&list->icons_texture);
+        list->icons_to_flush = false;
+    }
+}
 
-        Icon_s * const smdh = load_entry_icon(current_entry);
-        if(smdh != NULL)
+// the page of the entry can be swapped out while its icon is read, so the icon is read for a copy of it
+static u16 * load_job_icon(const Icon_Job_s * job)
+{
+    Entry_List_s * const list = job->list;
+    Entry_s entry;
+    platform_mutex_lock(&list->info_lock);
+    const bool gone = job->id >= (u32)list->entries_count;
+    if(!gone)
+        entry = *get_entry_at(list, job->id);
+    platform_mutex_unlock(&list->info_lock);
+
+    if(gone)
+        return NULL;
+    return read_entry_icon(list, &entry);
+}
+
+void load_icons_thread(void * void_arg)
+{
+    Thread_Arg_s * arg = (Thread_Arg_s *)void_arg;
+    Icon_Loader_s * const loader = (Icon_Loader_s *)arg->thread_arg;
+    Icon_Job_s job;
+    while(arg->run_thread)
+    {
+        if(!spsc_queue_pop(&loader->jobs, &job))
         {
-            if(current_entry->placeholder_color == 0)
-                parse_smdh(smdh, current_entry, current_entry->path + strlen(current_list->loading_path));
-            copy_texture_data(&current_list->icons_texture, smdh->big_icon, current_icon);
-            free(smdh);
+            platform_event_wait(&loader->wake);
+            continue;
         }
 
-        if(!released && i > endi/2)
+        // the cell was given to another entry since
+        if(job.list->icon_cells[job.slot].job != job.job)
+            continue;
+
+        job.icon = load_job_icon(&job);
+
+        // the main thread empties it every frame
+        while(!spsc_queue_push(&loader->done, &job))
         {
-            svcReleaseMutex(mutex);
-            released = true;
+            if(!arg->run_thread)
+            {
+                pool_free(job.icon);
+                return;
+            }
+            platform_event_wait(&loader->drained);
         }
     }
+}
 
-    free(entries);
-    free(indexes);
+// only the name, description and author: the icons come later, for the entries that get on screen
+static bool load_entry_info(const Entry_s * entry, Icon_s * icon)
+{
+    Data_Stream_s stream;
+    if(!open_data_stream("/info.smdh", entry, &stream))
+        return false;
 
-    current_list->previous_scroll = current_list->scroll;
+    const u32 info_size = offsetof(Icon_s, _padding2);
+    bool success = stream.size == sizeof(Icon_s);
+    u32 done = 0, read = 0;
+    while(success && done < info_size && (read = stream_read(&stream, (char *)icon + done, info_size - done)) != 0)
+        done += read;
 
-    return released;
+    stream_close(&stream);
+    return success && done == info_size;
 }
 
-void load_icons_thread(void * void_arg)
+// goes through the entries that weren't in the index, in the order they were found in
+void load_info_thread(void * void_arg)
 {
     Thread_Arg_s * arg = (Thread_Arg_s *)void_arg;
-    Handle mutex = *(Handle *)arg->thread_arg[1];
-    do {
-        svcWaitSynchronization(mutex, U64_MAX);
-        Entry_List_s * const current_list = *(Entry_List_s ** volatile)arg->thread_arg[0];
-        const bool released = load_icons(current_list, mutex);
-        if(!released)
-            svcReleaseMutex(mutex);
-    } while(arg->run_thread);
+    Entry_List_s * list = (Entry_List_s *)arg->thread_arg;
+    if(list == NULL || list->entries == NULL)
+    {
+        if(list != NULL)
+            list->info_loading = false;
+        return;
+    }
+
+    Icon_s * icon = pool_alloc(sizeof(Icon_s));
+    if(icon == NULL)
+    {
+        list->info_loading = false;
+        return;
+    }
+
+    bool parsed_any = false;
+    int next = 0;
+    Entry_s entry;
+
+    while(arg->run_thread)
+    {
+        platform_mutex_lock(&list->info_lock);
+        // the entries don't move, but the search goes around once for the ones added behind it
+        const int found = list_next_pending(list, next);
+        if(found >= 0)
+            memcpy(&entry, get_entry_at(list, found), sizeof(Entry_s));
+        platform_mutex_unlock(&list->info_lock);
+
+        if(found < 0)
+            break;
+
+        const bool success = load_entry_info(&entry, icon);
+
+        platform_mutex_lock(&list->info_lock);
+        // its page may have been swapped out in the meantime
+        Entry_s * const current_entry = get_entry_at(list, found);
+        if(current_entry->info_pending && current_entry->path == entry.path)
+        {
+            parse_smdh(success ? icon : NULL, current_entry, current_entry->path, list_entry_strings(list, current_entry));
+            current_entry->info_pending = false;
+            list->info_parsed++;
+            list->info_generation++;
+            parsed_any = true;
+        }
+        next = found + 1;
+        platform_mutex_unlock(&list->info_lock);
+    }
+
+    pool_free(icon);
+
+    if(parsed_any && arg->run_thread)
+    {
+        platform_mutex_lock(&list->info_lock);
+        entries_index_save(list);
+        platform_mutex_unlock(&list->info_lock);
+    }
+
+    list->info_loading = false;
 }
 
 bool load_preview_from_buffer(char * row_pointers, u32 size, C2D_Image * preview_image, int * preview_offset, int height)
@@ -351,9 +798,11 @@ bool load_preview(const Entry_List_s * list, C2D_Image * preview_image, int * pr
 {
     if(list->entries == NULL) return false;
 
-    const Entry_s * entry = &list->entries[list->selected_entry];
+    const Entry_s * entry = list_get_entry(list, list->selected_entry);
 
-    if(!memcmp(&previous_path_preview, &entry->path, 0x106 * sizeof(u16))) return true;
+    u16 entry_path[0x106] = {0};
+    entry_get_path(entry, entry_path);
+    if(!memcmp(&previous_path_preview, &entry_path, 0x106 * sizeof(u16))) return true;
 
     char * preview_buffer = NULL;
     u32 size = load_data("/preview.png", entry, &preview_buffer);
@@ -368,7 +817,11 @@ bool load_preview(const Entry_List_s * list, C2D_Image * preview_image, int * pr
     }
     else
     {
-        free(preview_buffer);
+        // a splash preview is assembled from the splashes themselves, read in one go
+        const char * splash_files[2] = { "/splash.bin", "/splashbottom.bin" };
+        char * splash_bufs[2] = {NULL};
+        u32 splash_sizes[2] = {0};
+        load_data_multi(splash_files, entry, splash_bufs, splash_sizes, 2);
 
         const int top_size =  TOP_SCREEN_WIDTH * SCREEN_HEIGHT * SCREEN_COLOR_DEPTH;
         const int out_size = top_size * 2;
@@ -378,7 +831,8 @@ bool load_preview(const Entry_List_s * list, C2D_Image * preview_image, int * pr
         bool found_splash = false;
 
         // try to assembly a preview from the splash screens
-        size = load_data("/splash.bin", entry, &preview_buffer);
+        preview_buffer = splash_bufs[0];
+        size = splash_sizes[0];
         if (size)
         {
             found_splash = true;
@@ -388,7 +842,8 @@ bool load_preview(const Entry_List_s * list, C2D_Image * preview_image, int * pr
             free(preview_buffer);
         }
 
-        size = load_data("/splashbottom.bin", entry, &preview_buffer);
+        preview_buffer = splash_bufs[1];
+        size = splash_sizes[1];
         if (size)
         {
             found_splash = true;
@@ -426,7 +881,7 @@ bool load_preview(const Entry_List_s * list, C2D_Image * preview_image, int * pr
     if(ret)
     {
         // mark the new preview as loaded for optimisation
-        memcpy(&previous_path_preview, &entry->path, 0x106 * sizeof(u16));
+        memcpy(&previous_path_preview, &entry_path, 0x106 * sizeof(u16));
     }
 
     return ret;
@@ -459,8 +914,7 @@ Result load_audio(const Entry_s * entry, audio_s * audio)
 
 Result load_audio_ogg(const Entry_s * entry, audio_ogg_s * audio) 
 {
-    audio->filesize = load_data("/bgm.ogg", entry, &audio->filebuf);
-    if (audio->filesize == 0) {
+    if (!open_data_stream("/bgm.ogg", entry, &audio->stream)) {
         free(audio);
         DEBUG("<load_audio> File not found!\n");
         return MAKERESULT(RL_FATAL, RS_NOTFOUND, RM_APPLICATION, RD_NOT_FOUND);
@@ -471,43 +925,34 @@ Result load_audio_ogg(const Entry_s * entry, audio_ogg_s * audio)
     ndspChnSetInterp(0, NDSP_INTERP_LINEAR); 
     ndspChnSetMix(0, audio->mix); // See mix comment above
 
-    FILE * file = fmemopen(audio->filebuf, audio->filesize, "rb");
-    DEBUG("<load_audio> Filesize: %ld\n", audio->filesize);
-    if(file != NULL) 
+    // the file is decoded as it's read, instead of being loaded whole first
+    DEBUG("<load_audio> Filesize: %ld\n", audio->stream.size);
+    int e = ogg_open_stream(audio);
+    if (e < 0) 
     {
-        int e = ov_open(file, &audio->vf, NULL, 0);
-        if (e < 0) 
-        {
-            DEBUG("<load_audio> Vorbis: %d\n", e);
-            free(audio->filebuf);
-            free(audio);
-            fclose(file);
-            return MAKERESULT(RL_FATAL, RS_INVALIDARG, RM_APPLICATION, RD_NO_DATA);
-        }
-
-        vorbis_info * vi = ov_info(&audio->vf, -1);
-        ndspChnSetRate(0, vi->rate);// Set sample rate to what's read from the ogg file
-        if (vi->channels == 2) {
-            DEBUG("<load_audio> Using stereo\n");
-            ndspChnSetFormat(0, NDSP_FORMAT_STEREO_PCM16); // 2 channels == Stereo
-        } else {
-            DEBUG("<load_audio> Invalid number of channels\n");
-            free(audio->filebuf);
-            free(audio);
-            fclose(file);
-            return MAKERESULT(RL_FATAL, RS_INVALIDARG, RM_APPLICATION, RD_NO_DATA);
-        }
+        DEBUG("<load_audio> Vorbis: %d\n", e);
+        stream_close(&audio->stream);
+        free(audio);
+        return MAKERESULT(RL_FATAL, RS_INVALIDARG, RM_APPLICATION, RD_NO_DATA);
+    }
 
-        audio->wave_buf[0].nsamples = audio->wave_buf[1].nsamples = vi->rate / 4; // 4 bytes per sample, samples = rate (bytes) / 4
-        audio->wave_buf[0].status = audio->wave_buf[1].status = NDSP_WBUF_DONE; // Used in play to stop from writing to current buffer
-        audio->wave_buf[0].data_vaddr = linearAlloc(BUF_TO_READ); // Most vorbis packets should only be 4 KB at most (?) Possibly dangerous assumption
-        audio->wave_buf[1].data_vaddr = linearAlloc(BUF_TO_READ);
-        DEBUG("<load_audio> Success!\n");
-        return MAKERESULT(RL_SUCCESS, RS_SUCCESS, RM_APPLICATION, RD_SUCCESS);
+    vorbis_info * vi = ov_info(&audio->vf, -1);
+    ndspChnSetRate(0, vi->rate);// Set sample rate to what's read from the ogg file
+    if (vi->channels == 2) {
+        DEBUG("<load_audio> Using stereo\n");
+        ndspChnSetFormat(0, NDSP_FORMAT_STEREO_PCM16); // 2 channels == Stereo
     } else {
-        free(audio->filebuf);
+        DEBUG("<load_audio> Invalid number of channels\n");
+        ov_clear(&audio->vf);
+        stream_close(&audio->stream);
         free(audio);
-        DEBUG("<load_audio> fmemopen failed!\n");
-        return MAKERESULT(RL_FATAL, RS_NOTFOUND, RM_APPLICATION, RD_NOT_FOUND);
+        return MAKERESULT(RL_FATAL, RS_INVALIDARG, RM_APPLICATION, RD_NO_DATA);
     }
+
+    audio->wave_buf[0].nsamples = audio->wave_buf[1].nsamples = vi->rate / 4; // 4 bytes per sample, samples = rate (bytes) / 4
+    audio->wave_buf[0].status = audio->wave_buf[1].status = NDSP_WBUF_DONE; // Used in play to stop from writing to current buffer
+    audio->wave_buf[0].data_vaddr = linearAlloc(BUF_TO_READ); // Most vorbis packets should only be 4 KB at most (?) Possibly dangerous assumption
+    audio->wave_buf[1].data_vaddr = linearAlloc(BUF_TO_READ);
+    DEBUG("<load_audio> Success!\n");
+    return MAKERESULT(RL_SUCCESS, RS_SUCCESS, RM_APPLICATION, RD_SUCCESS);
 }
\ No newline at end of file
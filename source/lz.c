@@ -0,0 +1,872 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include "lz.h"
+
+// LZ11 streams are a 4 byte header (magic + 24 bit decompressed size) followed
+// by groups of up to 8 tokens, each group preceded by a flag byte (MSB first)
+// telling whether the token is a literal byte (0) or a back-reference (1).
+// A back-reference is 2, 3 or 4 bytes long depending on the length it encodes,
+// and always ends with a 12 bit displacement (distance - 1).
+
+#define LZ11_HASH_BITS 13
+#define LZ11_HASH_SIZE (1 << LZ11_HASH_BITS)
+#define LZ11_NO_POS (-1)
+
+typedef struct {
+    u32 max_chain; // how many previous positions are compared per search
+    u32 nice_length; // stop searching once a match at least this long is found
+    bool lazy; // check if starting a match one byte later gives a longer one
+} LZ11_Level_Params_s;
+
+static const LZ11_Level_Params_s level_params[LZ11_LEVEL_AMOUNT] = {
+    [LZ11_LEVEL_FAST] = { 8, 32, false },
+    [LZ11_LEVEL_LAZY] = { 64, 256, true },
+    [LZ11_LEVEL_MAX] = { LZ11_WINDOW_SIZE, LZ11_MAX_MATCH, true },
+};
+
+typedef struct {
+    const u8 * in;
+    u32 size;
+    u32 inserted; // every position below this one has been added to the hash chains
+    s32 head[LZ11_HASH_SIZE];
+    s32 prev[LZ11_WINDOW_SIZE];
+} LZ11_Matcher_s;
+
+typedef struct {
+    u8 * out;
+    u32 pos;
+    u32 flag_pos;
+    u8 flag_bit; // flag bit of the next token, 0 when a new flag byte is needed
+} LZ11_Writer_s;
+
+static inline u32 lz11_hash(const u8 * p)
+{
+    return (((p[0] << 16) | (p[1] << 8) | p[2]) * 2654435761U) >> (32 - LZ11_HASH_BITS);
+}
+
+static void lz11_insert_until(LZ11_Matcher_s * m, u32 pos)
+{
+    // the last 2 positions can't start a match, so they don't need to be hashed
+    const u32 limit = m->size >= LZ11_MIN_MATCH ? m->size - LZ11_MIN_MATCH + 1 : 0;
+    const u32 end = pos < limit ? pos : limit;
+
+    for(; m->inserted < end; m->inserted++)
+    {
+        const u32 hash = lz11_hash(m->in + m->inserted);
+        m->prev[m->inserted & (LZ11_WINDOW_SIZE - 1)] = m->head[hash];
+        m->head[hash] = m->inserted;
+    }
+}
+
+static u32 lz11_find_match(LZ11_Matcher_s * m, u32 pos, const LZ11_Level_Params_s * params, u32 * match_disp)
+{
+    if(pos + LZ11_MIN_MATCH > m->size)
+        return 0;
+
+    lz11_insert_until(m, pos);
+
+    const u8 * const current = m->in + pos;
+    const u32 max_len = min(LZ11_MAX_MATCH, m->size - pos);
+    u32 best_len = LZ11_MIN_MATCH - 1;
+    u32 chain = params->max_chain;
+
+    s32 candidate = m->head[lz11_hash(current)];
+    while(candidate != LZ11_NO_POS && pos - candidate <= LZ11_WINDOW_SIZE && chain--)
+    {
+        const u8 * const match = m->in + candidate;
+        // checking the byte that would make this match the longest first rejects most candidates early
+        if(match[best_len] == current[best_len] && match[0] == current[0] && match[1] == current[1])
+        {
+            u32 len = 2;
+            while(len < max_len && match[len] == current[len])
+                len++;
+
+            if(len > best_len)
+            {
+                best_len = len;
+                *match_disp = pos - candidate - 1;
+                if(len >= params->nice_length || len == max_len)
+                    break;
+            }
+        }
+
+        const s32 next = m->prev[candidate & (LZ11_WINDOW_SIZE - 1)];
+        if(next >= candidate) // the slot was reused by a more recent position, the chain ends here
+            break;
+        candidate = next;
+    }
+
+    return best_len >= LZ11_MIN_MATCH ? best_len : 0;
+}
+
+static inline void lz11_start_token(LZ11_Writer_s * w, bool is_match)
+{
+    if(w->flag_bit == 0)
+    {
+        w->flag_pos = w->pos++;
+        w->out[w->flag_pos] = 0;
+        w->flag_bit = 0x80;
+    }
+
+    if(is_match)
+        w->out[w->flag_pos] |= w->flag_bit;
+    w->flag_bit >>= 1;
+}
+
+static void lz11_put_literal(LZ11_Writer_s * w, u8 byte)
+{
+    lz11_start_token(w, false);
+    w->out[w->pos++] = byte;
+}
+
+static void lz11_put_match(LZ11_Writer_s * w, u32 len, u32 disp)
+{
+    lz11_start_token(w, true);
+
+    if(len <= 0x10)
+    {
+        w->out[w->pos++] = ((len - 1) << 4) | (disp >> 8);
+    }
+    else if(len <= 0x110)
+    {
+        len -= 0x11;
+        w->out[w->pos++] = len >> 4;
+        w->out[w->pos++] = ((len & 0x0F) << 4) | (disp >> 8);
+    }
+    else
+    {
+        len -= 0x111;
+        w->out[w->pos++] = 0x10 | (len >> 12);
+        w->out[w->pos++] = (len >> 4) & 0xFF;
+        w->out[w->pos++] = ((len & 0x0F) << 4) | (disp >> 8);
+    }
+
+    w->out[w->pos++] = disp & 0xFF;
+}
+
+// finds the tokens making up m->in, handing them to emit in order (len 0 for a literal)
+static inline void lz11_parse(LZ11_Matcher_s * m, const LZ11_Level_Params_s * params, void (*emit)(void * userdata, u32 pos, u32 len, u32 disp), void * userdata)
+{
+    u32 pos = 0;
+    u32 disp = 0;
+    u32 len = lz11_find_match(m, pos, params, &disp);
+    while(pos < m->size)
+    {
+        if(len != 0 && params->lazy && len < params->nice_length)
+        {
+            u32 next_disp = 0;
+            const u32 next_len = lz11_find_match(m, pos + 1, params, &next_disp);
+            if(next_len > len)
+            {
+                emit(userdata, pos++, 0, 0);
+                len = next_len;
+                disp = next_disp;
+                continue;
+            }
+        }
+
+        if(len != 0)
+        {
+            emit(userdata, pos, len, disp);
+            pos += len;
+        }
+        else
+        {
+            emit(userdata, pos++, 0, 0);
+        }
+
+        len = lz11_find_match(m, pos, params, &disp);
+    }
+}
+
+static LZ11_Matcher_s * lz11_matcher_new(const char * in_buf, u32 size)
+{
+    LZ11_Matcher_s * m = malloc(sizeof(LZ11_Matcher_s));
+    if(m == NULL)
+        return NULL;
+
+    m->in = (const u8 *)in_buf;
+    m->size = size;
+    m->inserted = 0;
+    memset(m->head, 0xFF, sizeof(m->head));
+    return m;
+}
+
+static void lz11_write_header(u8 * out, u32 size)
+{
+    out[0] = LZ11_MAGIC;
+    out[1] = size & 0xFF;
+    out[2] = (size >> 8) & 0xFF;
+    out[3] = (size >> 16) & 0xFF;
+}
+
+typedef struct {
+    LZ11_Writer_s w;
+    const u8 * in;
+} LZ11_Compress_State_s;
+
+static void lz11_emit_to_writer(void * userdata, u32 pos, u32 len, u32 disp)
+{
+    LZ11_Compress_State_s * state = (LZ11_Compress_State_s *)userdata;
+    if(len != 0)
+        lz11_put_match(&state->w, len, disp);
+    else
+        lz11_put_literal(&state->w, state->in[pos]);
+}
+
+u32 lz11_compress(const char * in_buf, u32 size, char ** out_buf, LZ11_Level level)
+{
+    if(size > LZ11_MAX_SIZE || level >= LZ11_LEVEL_AMOUNT)
+        return 0;
+
+    // a back-reference is never bigger than the literals it replaces,
+    // so the worst case is all literals plus their flag bytes
+    u8 * out = malloc(LZ11_HEADER_SIZE + size + (size + 7) / 8);
+    LZ11_Matcher_s * m = lz11_matcher_new(in_buf, size);
+    if(out == NULL || m == NULL)
+    {
+        DEBUG("Error allocating LZ11 buffers - out of memory??\n");
+        free(out);
+        free(m);
+        return 0;
+    }
+
+    lz11_write_header(out, size);
+
+    LZ11_Compress_State_s state = {0};
+    state.w.out = out;
+    state.w.pos = LZ11_HEADER_SIZE;
+    state.in = m->in;
+
+    lz11_parse(m, &level_params[level], lz11_emit_to_writer, &state);
+
+    free(m);
+
+    *out_buf = (char *)out;
+    return state.w.pos;
+}
+
+typedef struct {
+    u32 pos; // decompressed position of the first byte the token produces
+    u32 len; // 1 for literals
+    u32 disp;
+    bool is_match;
+} LZ11_Token_s;
+
+// Reads tokens from compressed data without producing their output
+typedef struct {
+    const u8 * in;
+    u32 in_size;
+    u32 size; // decompressed size, from the header
+    u32 pos; // position of the next compressed byte
+    u32 out_pos; // decompressed position of the next token
+    u32 index; // amount of tokens read so far
+    u8 flags;
+} LZ11_Walker_s;
+
+// false if the token is cut off by the end of the input, or is corrupt
+static bool lz11_walk_token(LZ11_Walker_s * w, LZ11_Token_s * token, u32 * token_offset)
+{
+    if((w->index & 7) == 0)
+    {
+        if(w->pos >= w->in_size)
+            return false;
+        w->flags = w->in[w->pos++];
+    }
+
+    *token_offset = w->pos;
+    token->pos = w->out_pos;
+    token->is_match = (w->flags << (w->index & 7)) & 0x80;
+
+    if(w->pos >= w->in_size)
+        return false;
+
+    if(!token->is_match)
+    {
+        token->len = 1;
+        token->disp = 0;
+        w->pos++;
+    }
+    else
+    {
+        const u8 * const p = w->in + w->pos;
+        u32 token_size = 0;
+        switch(p[0] >> 4)
+        {
+            case 0:
+                token_size = 3;
+                break;
+            case 1:
+                token_size = 4;
+                break;
+            default:
+                token_size = 2;
+                break;
+        }
+
+        if(w->pos + token_size > w->in_size)
+            return false;
+
+        switch(token_size)
+        {
+            case 3:
+                token->len = ((p[0] << 4) | (p[1] >> 4)) + 0x11;
+                break;
+            case 4:
+                token->len = (((p[0] & 0x0F) << 12) | (p[1] << 4) | (p[2] >> 4)) + 0x111;
+                break;
+            default:
+                token->len = (p[0] >> 4) + 1;
+                break;
+        }
+
+        token->disp = ((p[token_size - 2] & 0x0F) << 8) | p[token_size - 1];
+        w->pos += token_size;
+
+        if(token->disp >= token->pos)
+            return false;
+    }
+
+    if(token->len > w->size - w->out_pos)
+        return false;
+
+    w->out_pos += token->len;
+    w->index++;
+    return true;
+}
+
+static inline bool lz11_ranges_overlap(u32 a_start, u32 a_len, u32 b_start, u32 b_len)
+{
+    return a_start < b_start + b_len && b_start < a_start + a_len;
+}
+
+typedef struct {
+    LZ11_Token_s * tokens;
+    u32 count;
+} LZ11_Token_List_s;
+
+static void lz11_emit_to_list(void * userdata, u32 pos, u32 len, u32 disp)
+{
+    LZ11_Token_List_s * list = (LZ11_Token_List_s *)userdata;
+    list->tokens[list->count++] = (LZ11_Token_s){
+        .pos = pos,
+        .len = len != 0 ? len : 1,
+        .disp = disp,
+        .is_match = len != 0,
+    };
+}
+
+// adds tokens to the list by splitting back-references, without changing what it decodes to
+static bool lz11_add_tokens(LZ11_Token_List_s * list, u32 needed)
+{
+    for(u32 i = list->count; needed != 0 && i-- > 0;)
+    {
+        LZ11_Token_s * const token = &list->tokens[i];
+        if(!token->is_match)
+            continue;
+
+        if(token->len > LZ11_MIN_MATCH)
+        {
+            // the first byte becomes a literal, the rest is still a match at the same distance
+            memmove(token + 1, token, (list->count - i) * sizeof(LZ11_Token_s));
+            list->count++;
+            token->len = 1;
+            token->is_match = false;
+            token[1].pos++;
+            token[1].len--;
+            needed--;
+            i += 2; // look at the shortened match again
+        }
+        else if(needed >= LZ11_MIN_MATCH - 1)
+        {
+            memmove(token + LZ11_MIN_MATCH, token + 1, (list->count - i - 1) * sizeof(LZ11_Token_s));
+            list->count += LZ11_MIN_MATCH - 1;
+            for(u32 j = 0; j < LZ11_MIN_MATCH; j++)
+                token[j] = (LZ11_Token_s){ .pos = token->pos + j, .len = 1 };
+            needed -= LZ11_MIN_MATCH - 1;
+        }
+    }
+
+    return needed == 0;
+}
+
+bool lz11_patch(const char * in_buf, u32 in_size, u32 offset, const char * patch, u32 patch_size, char ** out_buf, u32 * out_size, u32 * replaced)
+{
+    *out_buf = NULL;
+    *out_size = 0;
+    *replaced = 0;
+
+    const u8 * const in = (const u8 *)in_buf;
+    if(in_size < LZ11_HEADER_SIZE || in[0] != LZ11_MAGIC || patch_size == 0)
+        return false;
+
+    LZ11_Walker_s walker = {0};
+    walker.in = in;
+    walker.in_size = in_size;
+    walker.size = in[1] | (in[2] << 8) | (in[3] << 16);
+    walker.pos = LZ11_HEADER_SIZE;
+
+    if(offset > walker.size || patch_size > walker.size - offset)
+        return false;
+
+    // a later token can only reference the patched bytes if it starts less than a window after them
+    const u32 patch_end = offset + patch_size;
+    const u32 scan_end = min(walker.size, patch_end + LZ11_WINDOW_SIZE);
+    u8 * decoded = malloc(min(walker.size, scan_end + LZ11_MAX_MATCH));
+    if(decoded == NULL)
+        return false;
+
+    // everything up to the last token touching the patched bytes is encoded again,
+    // everything after it is kept as it is
+    LZ11_Walker_s cut = walker;
+    bool only_literals = true;
+    u32 last_literal_offset = 0;
+    while(walker.out_pos < scan_end)
+    {
+        LZ11_Token_s token;
+        u32 token_offset = 0;
+        if(!lz11_walk_token(&walker, &token, &token_offset))
+        {
+            free(decoded);
+            return false;
+        }
+
+        if(token.is_match)
+        {
+            for(u32 i = 0; i < token.len; i++)
+                decoded[token.pos + i] = decoded[token.pos - token.disp - 1 + i];
+        }
+        else
+        {
+            decoded[token.pos] = in[token_offset];
+        }
+
+        const bool writes_patch = lz11_ranges_overlap(token.pos, token.len, offset, patch_size);
+        const bool reads_patch = token.is_match && lz11_ranges_overlap(token.pos - token.disp - 1, token.len, offset, patch_size);
+        if(writes_patch || reads_patch)
+        {
+            cut = walker;
+            if(token.is_match)
+                only_literals = false;
+            else
+                last_literal_offset = token_offset;
+        }
+    }
+
+    if(!memcmp(decoded + offset, patch, patch_size))
+    {
+        free(decoded);
+        return true;
+    }
+
+    u8 * out = NULL;
+    if(only_literals)
+    {
+        // every patched byte is its own literal: change them where they are
+        *replaced = last_literal_offset + 1;
+        out = malloc(*replaced);
+        if(out != NULL)
+        {
+            memcpy(out, in, *replaced);
+            walker.pos = LZ11_HEADER_SIZE;
+            walker.out_pos = 0;
+            walker.index = 0;
+            while(walker.out_pos < patch_end)
+            {
+                LZ11_Token_s token;
+                u32 token_offset = 0;
+                lz11_walk_token(&walker, &token, &token_offset);
+                if(token.pos >= offset)
+                    out[token_offset] = patch[token.pos - offset];
+            }
+            *out_size = *replaced;
+        }
+
+        free(decoded);
+        *out_buf = (char *)out;
+        return out != NULL;
+    }
+
+    memcpy(decoded + offset, patch, patch_size);
+
+    // the tokens after the cut sharing its flag byte have to be moved under a new one,
+    // from the next flag byte on the original groups line up again
+    const u32 prefix_size = cut.out_pos;
+    const u32 prefix_tokens = cut.index;
+    LZ11_Walker_s group_end = cut;
+    while((group_end.index & 7) != 0 && group_end.out_pos < group_end.size)
+    {
+        LZ11_Token_s token;
+        u32 token_offset = 0;
+        if(!lz11_walk_token(&group_end, &token, &token_offset))
+        {
+            free(decoded);
+            return false;
+        }
+    }
+    const bool at_end = group_end.out_pos == group_end.size;
+
+    LZ11_Token_List_s list = {0};
+    list.tokens = malloc(prefix_size * sizeof(LZ11_Token_s));
+    LZ11_Matcher_s * m = lz11_matcher_new((const char *)decoded, prefix_size);
+    const u32 rest_size = in_size - cut.pos;
+    out = malloc(LZ11_HEADER_SIZE + prefix_size + prefix_size / 8 + 1 + rest_size + rest_size / 8 + 1);
+    bool success = list.tokens != NULL && m != NULL && out != NULL;
+
+    if(success)
+    {
+        LZ11_Writer_s w = {0};
+        w.out = out;
+        w.pos = LZ11_HEADER_SIZE;
+        memcpy(out, in, LZ11_HEADER_SIZE);
+
+        lz11_parse(m, &level_params[LZ11_LEVEL_MAX], lz11_emit_to_list, &list);
+
+        // past the end of the data there is nothing left to line up with.
+        // If splitting matches can't line the groups up, every remaining token gets a new flag byte,
+        // which needs in_buf to hold all of the compressed data
+        const bool regroup_all = !at_end && !lz11_add_tokens(&list, (prefix_tokens - list.count) & 7);
+
+        for(u32 i = 0; i < list.count; i++)
+        {
+            const LZ11_Token_s * const token = &list.tokens[i];
+            if(token->is_match)
+                lz11_put_match(&w, token->len, token->disp);
+            else
+                lz11_put_literal(&w, decoded[token->pos]);
+        }
+
+        walker = cut;
+        while(walker.out_pos < walker.size && ((walker.index & 7) != 0 || regroup_all))
+        {
+            LZ11_Token_s token;
+            u32 token_offset = 0;
+            if(!lz11_walk_token(&walker, &token, &token_offset))
+            {
+                success = false;
+                break;
+            }
+
+            lz11_start_token(&w, token.is_match);
+            memcpy(out + w.pos, in + token_offset, walker.pos - token_offset);
+            w.pos += walker.pos - token_offset;
+        }
+
+        *out_size = w.pos;
+        *replaced = walker.pos;
+    }
+
+    if(success)
+    {
+        *out_buf = (char *)out;
+    }
+    else
+    {
+        free(out);
+        *out_size = 0;
+        *replaced = 0;
+    }
+
+    free(m);
+    free(list.tokens);
+    free(decoded);
+    return success;
+}
+
+// a flag byte and 8 of the biggest back-references
+#define LZ11_MAX_GROUP_SIZE (1 + 8 * 4)
+
+// makes sure a whole flag group can be read from stream->in without refilling, unless the input ends first
+static void lz11_stream_refill(LZ11_Stream_s * stream)
+{
+    u32 left = stream->in_len - stream->in_pos;
+    if(left >= LZ11_MAX_GROUP_SIZE || stream->in_eof)
+        return;
+
+    memmove(stream->in, stream->in + stream->in_pos, left);
+    stream->in_pos = 0;
+    while(left < LZ11_MAX_GROUP_SIZE)
+    {
+        const u32 read = stream->read(stream->userdata, (char *)stream->in + left, LZ11_STREAM_CHUNK_SIZE - left);
+        if(read == 0)
+        {
+            stream->in_eof = true;
+            break;
+        }
+        left += read;
+    }
+    stream->in_len = left;
+}
+
+// copies len bytes from dist bytes before out, where out - dist isn't before the start of the buffer
+static inline void lz11_copy_back(u8 * out, u32 len, u32 dist)
+{
+    const u8 * src = out - dist;
+    if(len < 16)
+    {
+        // most matches, shorter than what a call to memcpy is worth
+        while(len--)
+            *out++ = *src++;
+    }
+    else if(dist >= len)
+    {
+        memcpy(out, src, len);
+    }
+    else if(dist == 1)
+    {
+        memset(out, *src, len);
+    }
+    else if(dist >= sizeof(u32))
+    {
+        // a word never overlaps the one it's copied from
+        for(; len >= sizeof(u32); len -= sizeof(u32), out += sizeof(u32), src += sizeof(u32))
+            memcpy(out, src, sizeof(u32));
+        while(len--)
+            *out++ = *src++;
+    }
+    else
+    {
+        while(len--)
+            *out++ = *src++;
+    }
+}
+
+// same, but the start of the match can be in the history of the previous calls
+static void lz11_stream_copy(const LZ11_Stream_s * stream, const u8 * out_start, u8 * out, u32 len, u32 dist)
+{
+    const u32 produced = out - out_start;
+    if(dist > produced)
+    {
+        u32 from_history = min(len, dist - produced);
+        u32 pos = (stream->written + produced - dist) & (LZ11_WINDOW_SIZE - 1);
+        len -= from_history;
+        while(from_history != 0)
+        {
+            const u32 part = min(from_history, LZ11_WINDOW_SIZE - pos);
+            memcpy(out, stream->history + pos, part);
+            out += part;
+            from_history -= part;
+            pos = 0;
+        }
+    }
+
+    if(len != 0)
+        lz11_copy_back(out, len, dist);
+}
+
+// keeps the end of what was just produced for the back-references of the next calls
+static void lz11_stream_save_history(LZ11_Stream_s * stream, const u8 * out_start, u32 produced)
+{
+    const u32 keep = min(produced, LZ11_WINDOW_SIZE);
+    const u8 * const src = out_start + produced - keep;
+    const u32 pos = (stream->written + produced - keep) & (LZ11_WINDOW_SIZE - 1);
+    const u32 first = min(keep, LZ11_WINDOW_SIZE - pos);
+    memcpy(stream->history + pos, src, first);
+    memcpy(stream->history, src + first, keep - first);
+}
+
+bool lz11_stream_open(LZ11_Stream_s * stream, lz11_read_callback read_callback, void * userdata)
+{
+    stream->read = read_callback;
+    stream->userdata = userdata;
+    stream->in_pos = 0;
+    stream->in_len = 0;
+    stream->in_eof = false;
+    stream->size = 0;
+    stream->written = 0;
+    stream->flags = 0;
+    stream->flags_left = 0;
+    stream->match_len = 0;
+    stream->match_disp = 0;
+    stream->error = false;
+
+    lz11_stream_refill(stream);
+    if(stream->in_len < LZ11_HEADER_SIZE)
+        return false;
+
+    const u8 * const header = stream->in;
+    if(header[0] != LZ11_MAGIC)
+    {
+        DEBUG("Not LZ11 data (magic 0x%02x)\n", header[0]);
+        return false;
+    }
+
+    stream->size = header[1] | (header[2] << 8) | (header[3] << 16);
+    stream->in_pos = LZ11_HEADER_SIZE;
+    return true;
+}
+
+u32 lz11_stream_read(LZ11_Stream_s * stream, char * buf, u32 size)
+{
+    u8 * const out_start = (u8 *)buf;
+    u8 * out = out_start;
+    u8 * const out_end = out + min(size, stream->size - stream->written);
+
+    // a back-reference cut off by the end of the previous call
+    if(stream->match_len != 0 && out < out_end)
+    {
+        const u32 len = min(stream->match_len, (u32)(out_end - out));
+        lz11_stream_copy(stream, out_start, out, len, stream->match_disp + 1);
+        out += len;
+        stream->match_len -= len;
+    }
+
+    while(out < out_end && !stream->error)
+    {
+        if(stream->flags_left == 0)
+        {
+            lz11_stream_refill(stream);
+            if(stream->in_pos == stream->in_len)
+                goto truncated;
+            stream->flags = stream->in[stream->in_pos++];
+            stream->flags_left = 8;
+        }
+
+        // the whole group is in the input buffer, unless the input ends in it
+        const u8 * p = stream->in + stream->in_pos;
+        const u8 * const in_end = stream->in + stream->in_len;
+        u8 flags = stream->flags;
+        u8 flags_left = stream->flags_left;
+
+        // a group of only literals, all of noise and much of pictures
+        if(flags == 0 && flags_left == 8 && in_end - p >= 8 && out_end - out >= 8)
+        {
+            memcpy(out, p, 8);
+            out += 8;
+            p += 8;
+            flags_left = 0;
+        }
+
+        for(; flags_left != 0 && out < out_end; flags_left--, flags <<= 1)
+        {
+            if(p == in_end)
+            {
+                stream->in_pos = p - stream->in;
+                goto truncated;
+            }
+
+            if(!(flags & 0x80))
+            {
+                *out++ = *p++;
+                continue;
+            }
+
+            u32 len = 0;
+            u32 token_size = 0;
+            switch(p[0] >> 4)
+            {
+                case 0:
+                    token_size = 3;
+                    break;
+                case 1:
+                    token_size = 4;
+                    break;
+                default:
+                    token_size = 2;
+                    break;
+            }
+
+            if((u32)(in_end - p) < token_size)
+            {
+                stream->in_pos = p - stream->in;
+                goto truncated;
+            }
+
+            switch(token_size)
+            {
+                case 3:
+                    len = ((p[0] << 4) | (p[1] >> 4)) + 0x11;
+                    break;
+                case 4:
+                    len = (((p[0] & 0x0F) << 12) | (p[1] << 4) | (p[2] >> 4)) + 0x111;
+                    break;
+                default:
+                    len = (p[0] >> 4) + 1;
+                    break;
+            }
+
+            const u32 disp = ((p[token_size - 2] & 0x0F) << 8) | p[token_size - 1];
+            const u32 position = stream->written + (out - out_start);
+            if(disp >= position || len > stream->size - position)
+            {
+                DEBUG("Corrupt LZ11 back-reference at 0x%lx\n", position);
+                stream->error = true;
+                break;
+            }
+            p += token_size;
+
+            const u32 copy = min(len, (u32)(out_end - out));
+            if(disp < (u32)(out - out_start))
+                lz11_copy_back(out, copy, disp + 1);
+            else
+                lz11_stream_copy(stream, out_start, out, copy, disp + 1);
+            out += copy;
+            stream->match_len = len - copy;
+            stream->match_disp = disp;
+        }
+
+        stream->in_pos = p - stream->in;
+        stream->flags = flags;
+        stream->flags_left = flags_left;
+    }
+
+    goto done;
+
+truncated:
+    DEBUG("LZ11 data ended early at 0x%lx out of 0x%lx\n", stream->written + (u32)(out - out_start), stream->size);
+    stream->error = true;
+
+done:
+    lz11_stream_save_history(stream, out_start, out - out_start);
+    stream->written += out - out_start;
+    return out - out_start;
+}
+
+u32 lz11_decompress_stream(lz11_read_callback read_callback, void * read_userdata, lz11_write_callback write_callback, void * write_userdata)
+{
+    LZ11_Stream_s * stream = malloc(sizeof(LZ11_Stream_s));
+    char * chunk = malloc(LZ11_STREAM_CHUNK_SIZE);
+    u32 total = 0;
+
+    if(stream != NULL && chunk != NULL && lz11_stream_open(stream, read_callback, read_userdata))
+    {
+        u32 read = 0;
+        while((read = lz11_stream_read(stream, chunk, LZ11_STREAM_CHUNK_SIZE)) != 0)
+        {
+            total += read;
+            if(!write_callback(write_userdata, chunk, read))
+                break;
+        }
+
+        if(stream->error)
+            total = 0;
+    }
+
+    free(chunk);
+    free(stream);
+    return total;
+}
@@ -34,6 +34,12 @@
 #include "remote.h"
 #include "ui_strings.h"
 #include "badges.h"
+#include "zip.h"
+#include "pool.h"
+#include "search_index.h"
+#include "duplicates.h"
+#include "icon_cache.h"
+#include "icon_atlas.h"
 #include <time.h>
 
 bool quit = false;
@@ -46,12 +52,23 @@ u64 time_home_pressed = 0;
 
 static Thread iconLoadingThread = {0};
 static Thread_Arg_s iconLoadingThread_arg = {0};
-static Handle update_icons_mutex;
-static bool released = false;
+static Icon_Loader_s icon_loader;
 
 static Thread install_check_threads[MODE_AMOUNT] = {0};
 static Thread_Arg_s install_check_threads_arg[MODE_AMOUNT] = {0};
 
+static Thread info_threads[MODE_AMOUNT] = {0};
+static Thread_Arg_s info_threads_arg[MODE_AMOUNT] = {0};
+static Search_Index_s search_indexes[MODE_AMOUNT] = {0};
+
+static Thread duplicates_threads[MODE_AMOUNT] = {0};
+static Thread_Arg_s duplicates_threads_arg[MODE_AMOUNT] = {0};
+static Duplicates_s duplicates[MODE_AMOUNT] = {0};
+// main_paths, then the extra paths from the config
+static const char * list_roots[MODE_AMOUNT][1 + EXTRA_PATHS_MAX];
+// the list is sorted again after this many entries got their info, or when the info thread is done
+#define INFO_RESORT_BATCH 64
+
 static Entry_List_s lists[MODE_AMOUNT] = {0};
 
 Language_s language = {0};
@@ -91,6 +108,9 @@ static void init_services(void)
     APT_SetAppCpuTimeLimit(30);
     httpcInit(0);
     init_sd();
+    zip_index_init();
+    pool_init();
+    icon_cache_init(config.icon_cache_size);
     archive_result = open_archives();
     badge_archive_result = open_badge_extdata();
     if(envIsHomebrew())
@@ -104,6 +124,9 @@ static void init_services(void)
 static void exit_services(void)
 {
     close_archives();
+    zip_index_exit();
+    icon_cache_exit();
+    pool_exit();
     cfguExit();
     ptmuExit();
     if (old_time_limit != UINT32_MAX) APT_SetAppCpuTimeLimit(old_time_limit);
@@ -129,10 +152,53 @@ static void stop_install_check(void)
     }
 }
 
+static void stop_duplicates_threads(void)
+{
+    for(int i = 0; i < MODE_AMOUNT; i++)
+    {
+        duplicates_threads_arg[i].run_thread = false;
+    }
+    for(int i = 0; i < MODE_AMOUNT; i++)
+    {
+        if(duplicates_threads[i] == NULL)
+            continue;
+
+        threadJoin(duplicates_threads[i], U64_MAX);
+        threadFree(duplicates_threads[i]);
+        duplicates_threads[i] = NULL;
+    }
+}
+
+static void stop_info_threads(void)
+{
+    for(int i = 0; i < MODE_AMOUNT; i++)
+    {
+        info_threads_arg[i].run_thread = false;
+    }
+    for(int i = 0; i < MODE_AMOUNT; i++)
+    {
+        if(info_threads[i] == NULL)
+            continue;
+
+        threadJoin(info_threads[i], U64_MAX);
+        threadFree(info_threads[i]);
+        info_threads[i] = NULL;
+    }
+}
+
+// lets the install check of a list finish, keeping what it found
+static void wait_install_check(int mode)
+{
+    if(install_check_threads[mode] == NULL)
+        return;
+
+    threadJoin(install_check_threads[mode], U64_MAX);
+    threadFree(install_check_threads[mode]);
+    install_check_threads[mode] = NULL;
+}
+
 static inline void wait_scroll(void)
 {
-    released = true;
-    svcReleaseMutex(update_icons_mutex);
     svcSleepThread(FASTSCROLL_WAIT);
 }
 
@@ -142,26 +208,39 @@ static void exit_thread(void)
     {
         DEBUG("exiting thread\n");
         iconLoadingThread_arg.run_thread = false;
-        svcReleaseMutex(update_icons_mutex);
-        svcWaitSynchronization(update_icons_mutex, U64_MAX);
+        platform_event_signal(&icon_loader.wake);
+        platform_event_signal(&icon_loader.drained);
         threadJoin(iconLoadingThread, U64_MAX);
         threadFree(iconLoadingThread);
         iconLoadingThread = NULL;
     }
+    icon_loader_clear(&icon_loader);
 }
 
 void free_lists(void)
 {
+    // the icon thread works on the lists without waiting for the main thread, so it has to be gone first
+    exit_thread();
     stop_install_check();
+    stop_duplicates_threads();
+    stop_info_threads();
     for(int i = 0; i < MODE_AMOUNT; i++)
     {
         Entry_List_s * const current_list = &lists[i];
         C3D_TexDelete(&current_list->icons_texture);
         free(current_list->icons_info);
-        free(current_list->entries);
+        free(current_list->prefetch_slots);
+        free(current_list->icon_cells);
+        icon_atlas_close(&current_list->icon_atlas);
+        list_free_entries(current_list);
+        arena_free(&current_list->strings);
+        free_sort_orders(current_list);
+        list_clear_view(current_list);
+        search_index_free(&search_indexes[i]);
+        duplicates_free(&duplicates[i]);
         memset(current_list, 0, sizeof(Entry_List_s));
     }
-    exit_thread();
+    icon_cache_clear();
 }
 
 void exit_function(bool power_pressed)
@@ -171,7 +250,7 @@ void exit_function(bool power_pressed)
         stop_audio(&audio);
     }
     free_lists();
-    svcCloseHandle(update_icons_mutex);
+    icon_loader_free(&icon_loader);
     exit_screens();
     exit_services();
 
@@ -234,17 +313,18 @@ static void load_lists(Entry_List_s * lists)
         // A texture must have power of 2 dimensions (not necessarily the same)
         // so, get the power of two greater than or equal to:
         // - the size of the largest length (row or column) of icons for the width
-        // - the size of all of those lengths to fit the total for the height
+        // - the size of all of those lengths to fit the total for the height, with the ones loaded ahead under them
+        const int rows = y_component * (ICONS_OFFSET_AMOUNT + ICONS_PREFETCH_PAGES);
         C3D_TexInit(&current_list->icons_texture,
             next_or_equal_power_of_2(x_component * current_list->entry_size),
-            next_or_equal_power_of_2(y_component * current_list->entry_size * ICONS_OFFSET_AMOUNT),
+            next_or_equal_power_of_2(rows * current_list->entry_size),
             GPU_RGB565);
         C3D_TexSetFilter(&current_list->icons_texture, GPU_NEAREST, GPU_NEAREST);
 
         const float inv_width = 1.0f / current_list->icons_texture.width;
         const float inv_height = 1.0f / current_list->icons_texture.height;
-        current_list->icons_info = (Entry_Icon_s *)calloc(x_component * y_component * ICONS_OFFSET_AMOUNT, sizeof(Entry_Icon_s));
-        for(int j = 0; j < y_component * ICONS_OFFSET_AMOUNT; ++j)
+        current_list->icons_info = (Entry_Icon_s *)calloc(x_component * rows, sizeof(Entry_Icon_s));
+        for(int j = 0; j < rows; ++j)
         {
             const int index = j * x_component;
             for(int h = 0; h < x_component; ++h)
@@ -261,16 +341,49 @@ static void load_lists(Entry_List_s * lists)
             }
         }
 
-        Result res = load_entries(main_paths[i], current_list, loading_screen);
+        // the slots after the ring, for the icons loaded ahead of the scrolling
+        current_list->icons_spare = x_component * y_component * ICONS_PREFETCH_PAGES;
+        current_list->prefetch_slots = calloc(current_list->icons_spare, sizeof(Icon_Prefetch_Slot_s));
+        if(current_list->prefetch_slots == NULL)
+            current_list->icons_spare = 0;
+        current_list->icon_cells = calloc(x_component * rows, sizeof(Icon_Cell_s));
+        for(int j = 0; j < current_list->icons_spare; ++j)
+            current_list->prefetch_slots[j].position = -1;
+
+        list_roots[i][0] = main_paths[i];
+        for(int j = 0; j < config.extra_paths_count[i]; j++)
+            list_roots[i][1 + j] = config.extra_paths[i][j];
+
+        Result res = load_entries(list_roots[i], 1 + config.extra_paths_count[i], current_list, loading_screen);
         if(R_SUCCEEDED(res))
         {
-            if(current_list->entries_count > current_list->entries_loaded * ICONS_OFFSET_AMOUNT)
+            if(current_list->entries_count > current_list->entries_loaded * ICONS_OFFSET_AMOUNT && current_list->icon_cells != NULL)
+            {
                 iconLoadingThread_arg.run_thread = true;
+                current_list->icon_loader = &icon_loader;
+            }
 
             DEBUG("total: %i\n", current_list->entries_count);
 
             sort_by_name(current_list);
+            icon_atlas_open(&current_list->icon_atlas, current_list);
             load_icons_first(current_list, false);
+            search_index_build(&search_indexes[i], current_list);
+
+            // the visible entries got their info with their icons, the rest is filled in the background
+            Thread_Arg_s * info_arg = &info_threads_arg[i];
+            info_arg->run_thread = true;
+            info_arg->thread_arg = (void **)current_list;
+            current_list->info_loading = true;
+            info_threads[i] = threadCreate(load_info_thread, info_arg, __stacksize__, 0x3f, -2, false);
+            if(info_threads[i] == NULL)
+                current_list->info_loading = false;
+
+            Thread_Arg_s * duplicates_arg = &duplicates_threads_arg[i];
+            duplicates[i].list = current_list;
+            duplicates_arg->run_thread = true;
+            duplicates_arg->thread_arg = (void **)&duplicates[i];
+            duplicates_threads[i] = threadCreate(find_duplicates_thread, duplicates_arg, __stacksize__, 0x3f, -2, false);
 
             void (*install_check_function)(void *) = NULL;
             if(i == MODE_THEMES)
@@ -317,7 +430,8 @@ static void jump_menu(Entry_List_s * list)
 
     SwkbdState swkbd;
 
-    sprintf(numbuf, "%i", list->entries_count);
+    int count = list_get_count(list);
+    sprintf(numbuf, "%i", count);
     int max_chars = strlen(numbuf);
     swkbdInit(&swkbd, SWKBD_TYPE_NUMPAD, 2, max_chars);
 
@@ -330,7 +444,7 @@ static void jump_menu(Entry_List_s * list)
     swkbdSetButton(&swkbd, SWKBD_BUTTON_LEFT, language.main.cancel, false);
     swkbdSetButton(&swkbd, SWKBD_BUTTON_RIGHT, language.main.jump, true);
     swkbdSetValidation(&swkbd, SWKBD_NOTEMPTY_NOTBLANK, 0, max_chars);
-    swkbdSetFilterCallback(&swkbd, jump_menu_callback, &list->entries_count);
+    swkbdSetFilterCallback(&swkbd, jump_menu_callback, &count);
 
     memset(numbuf, 0, sizeof(numbuf));
     SwkbdButton button = swkbdInputText(&swkbd, numbuf, sizeof(numbuf));
@@ -341,22 +455,140 @@ static void jump_menu(Entry_List_s * list)
     }
 }
 
+// adds the zips that were just downloaded to their list, only loading everything again when that can't be done
+static void add_saved_zips(Entry_List_s * lists)
+{
+    Saved_Zip_s zips[SAVED_ZIPS_MAX];
+    const int count = take_saved_zips(zips);
+    if(count < 0)
+    {
+        load_lists(lists);
+        return;
+    }
+
+    bool changed[MODE_AMOUNT] = {false};
+    for(int i = 0; i < count; i++)
+    {
+        const Saved_Zip_s * const zip = &zips[i];
+        if(zip->mode >= (RemoteMode)MODE_AMOUNT)
+            continue;
+
+        Entry_List_s * const list = &lists[zip->mode];
+        // the icon thread only runs if a list has more entries than it keeps icons for
+        const bool needs_icon_thread = list->entries_count + 1 > list->entries_loaded * ICONS_OFFSET_AMOUNT;
+        if(list->entries == NULL || (needs_icon_thread && list->icon_loader == NULL))
+        {
+            load_lists(lists);
+            return;
+        }
+
+        wait_install_check(zip->mode);
+        if(list_insert_zip(list, zip->name, zip->size) < 0)
+        {
+            load_lists(lists);
+            return;
+        }
+        changed[zip->mode] = true;
+    }
+
+    for(int i = 0; i < MODE_AMOUNT; i++)
+    {
+        if(changed[i])
+            load_icons_first(&lists[i], true);
+    }
+}
+
+static void search_menu(Entry_List_s * list, Search_Index_s * index)
+{
+    if(list == NULL || list->entries == NULL) return;
+
+    char search[0x101] = {0};
+
+    SwkbdState swkbd;
+
+    swkbdInit(&swkbd, SWKBD_TYPE_NORMAL, 2, sizeof(search) - 1);
+    swkbdSetHintText(&swkbd, language.main.search_q);
+
+    swkbdSetButton(&swkbd, SWKBD_BUTTON_LEFT, language.main.cancel, false);
+    swkbdSetButton(&swkbd, SWKBD_BUTTON_RIGHT, language.main.search, true);
+    swkbdSetValidation(&swkbd, SWKBD_ANYTHING, 0, 0);
+
+    SwkbdButton button = swkbdInputText(&swkbd, search, sizeof(search));
+    if(button == SWKBD_BUTTON_CONFIRM)
+    {
+        const u64 start = platform_ticks();
+        const int matches = search_index_filter(index, list, search);
+        DEBUG("search \"%s\": %i matches in %llu us\n", search, matches, platform_ticks_to_us(platform_ticks() - start));
+        if(matches == 0)
+        {
+            throw_error(language.main.no_matches, ERROR_LEVEL_WARNING);
+            return;
+        }
+
+        list->selected_entry = 0;
+        list->previous_selected = 0;
+        list->scroll = 0;
+        list->previous_scroll = 0;
+        load_icons_first(list, false);
+    }
+}
+
+static void duplicates_menu(Entry_List_s * list, Duplicates_s * list_duplicates)
+{
+    if(list == NULL || list->entries == NULL) return;
+
+    if(!list_duplicates->done)
+    {
+        throw_error(language.main.duplicates_busy, ERROR_LEVEL_WARNING);
+        return;
+    }
+    if(!duplicates_show(list_duplicates, list))
+    {
+        throw_error(language.main.no_duplicates, ERROR_LEVEL_WARNING);
+        return;
+    }
+
+    list->selected_entry = 0;
+    list->previous_selected = 0;
+    list->scroll = 0;
+    list->previous_scroll = 0;
+    load_icons_first(list, false);
+
+    // the copies stay shown if neither is picked
+    if(draw_confirm(language.main.delete_duplicates_confirm, list, DRAW_MODE_LIST))
+    {
+        draw_install(INSTALL_ENTRY_DELETE);
+        duplicates_delete_copies(list_duplicates, list);
+        load_lists(lists);
+    }
+    else if(draw_confirm(language.main.hide_duplicates_confirm, list, DRAW_MODE_LIST))
+    {
+        duplicates_hide_copies(list_duplicates, list);
+        list->selected_entry = 0;
+        list->previous_selected = 0;
+        list->scroll = 0;
+        list->previous_scroll = 0;
+        load_icons_first(list, false);
+    }
+}
+
 static void change_selected(Entry_List_s * list, int change_value)
 {
-    if(abs(change_value) >= list->entries_count) return;
+    const int count = list_get_count(list);
+    if(abs(change_value) >= count) return;
 
     int newval = list->selected_entry + change_value;
 
     if(newval < 0)
-        newval += list->entries_count;
-    newval %= list->entries_count;
+        newval += count;
+    newval %= count;
 
     list->selected_entry = newval;
 }
 
 static void toggle_shuffle(Entry_List_s * list)
 {
-    Entry_s * current_entry = &list->entries[list->selected_entry];
+    Entry_s * current_entry = list_get_entry(list, list->selected_entry);
     if(current_entry->in_shuffle)
     {
         if(current_entry->no_bgm_shuffle)
@@ -385,14 +617,11 @@ int main(void)
     language = init_strings(lang);
     init_screens();
 
-    svcCreateMutex(&update_icons_mutex, true);
+    if(!icon_loader_init(&icon_loader))
+        DEBUG("Not enough memory for the icon queues\n");
 
-    static Entry_List_s * current_list = NULL;
-    void * iconLoadingThread_args_void[] = {
-        &current_list,
-        &update_icons_mutex,
-    };
-    iconLoadingThread_arg.thread_arg = iconLoadingThread_args_void;
+    Entry_List_s * current_list = NULL;
+    iconLoadingThread_arg.thread_arg = (void **)&icon_loader;
     iconLoadingThread_arg.run_thread = false;
 
     #ifndef CITRA_MODE
@@ -457,25 +686,21 @@ int main(void)
             draw_preview(preview, preview_offset, 1.0f);
         }
         else {
-            if(!iconLoadingThread_arg.run_thread)
+            // the icons that are loaded show up in whichever frame they're done
+            if(iconLoadingThread_arg.run_thread)
+                finish_icon_jobs(&icon_loader);
+
+            if(current_list->icon_loader == NULL)
             {
                 handle_scrolling(current_list);
                 current_list->previous_scroll = current_list->scroll;
             }
             else
             {
-                if(!released)
-                {
-                    svcReleaseMutex(update_icons_mutex);
-                    released = true;
-                }
-                svcWaitSynchronization(update_icons_mutex, U64_MAX);
+                update_icons(current_list);
             }
 
             draw_interface(current_list, instructions, draw_mode);
-
-            svcSleepThread(1e7);
-            released = false;
         }
 
         if (home_displayed)
@@ -487,6 +712,16 @@ int main(void)
 
         end_frame();
 
+        if(!preview_mode && (current_list->info_parsed >= INFO_RESORT_BATCH || (current_list->info_parsed != 0 && !current_list->info_loading)))
+        {
+            resort_list(current_list);
+            load_icons_first(current_list, true);
+        }
+
+        // only the pages of entries around the scrolling stay in memory
+        for(int i = 0; i < MODE_AMOUNT; i++)
+            list_trim(&lists[i]);
+
         if(kDown & KEY_START) quit = true;
 
         if(current_list->entries_count == 0)
@@ -547,7 +782,7 @@ int main(void)
                     {
                         if(init_qr())
                         {
-                            load_lists(lists);
+                            add_saved_zips(lists);
                         }
                     }
                     else
@@ -579,7 +814,7 @@ int main(void)
                         if(current_mode == MODE_THEMES && dspfirm)
                         {
                             audio = calloc(1, sizeof(audio_s));
-                            Result r = load_audio(&current_list->entries[current_list->selected_entry], audio);
+                            Result r = load_audio(list_get_entry(current_list, current_list->selected_entry), audio);
                             if (R_SUCCEEDED(r)) play_audio(audio);
                             else audio = NULL;
                         }
@@ -607,7 +842,7 @@ int main(void)
         }
 
         int selected_entry = current_list->selected_entry;
-        Entry_s * current_entry = &current_list->entries[selected_entry];
+        Entry_s * current_entry = list_get_entry(current_list, selected_entry);
 
         if(preview_mode || current_list->entries == NULL)
             goto touch;
@@ -661,15 +896,7 @@ int main(void)
                 draw_install(INSTALL_BGM);
                 if(R_SUCCEEDED(bgm_install(current_entry)))
                 {
-                    for(int i = 0; i < current_list->entries_count; i++)
-                    {
-            #define BETWEEN(min, x, max) (min < x && x < max)
-                        Entry_s * theme = &current_list->entries[i];
-                        if(theme == current_entry)
-                            theme->installed = true;
-                        else
-                            theme->installed = false;
-                    }
+                    list_mark_installed(current_list, current_entry);
                     installed_themes = true;
                 }
             }
@@ -682,15 +909,7 @@ int main(void)
                 draw_install(INSTALL_SINGLE);
                 if(R_SUCCEEDED(theme_install(current_entry)))
                 {
-                    for(int i = 0; i < current_list->entries_count; i++)
-
-                    {
-                        Entry_s * theme = &current_list->entries[i];
-                        if(theme == current_entry)
-                            theme->installed = true;
-                        else
-                            theme->installed = false;
-                    }
+                    list_mark_installed(current_list, current_entry);
                     installed_themes = true;
                 }
             }
@@ -703,14 +922,7 @@ int main(void)
                 draw_install(INSTALL_NO_BGM);
                 if(R_SUCCEEDED(no_bgm_install(current_entry)))
                 {
-                    for(int i = 0; i < current_list->entries_count; i++)
-                    {
-                        Entry_s * theme = &current_list->entries[i];
-                        if(theme == current_entry)
-                            theme->installed = true;
-                        else
-                            theme->installed = false;
-                    }
+                    list_mark_installed(current_list, current_entry);
                     installed_themes = true;
                 }
             }
@@ -735,16 +947,7 @@ int main(void)
                     if(R_FAILED(res)) DEBUG("shuffle install result: %lx\n", res);
                     else
                     {
-                        for(int i = 0; i < current_list->entries_count; i++)
-                        {
-                            Entry_s * theme = &current_list->entries[i];
-                            if(theme->in_shuffle)
-                            {
-                                theme->in_shuffle = false;
-                                theme->installed = true;
-                            }
-                            else theme->installed = false;
-                        }
+                        list_mark_installed(current_list, NULL);
                         current_list->shuffle_count = 0;
                         installed_themes = true;
                     }
@@ -811,7 +1014,7 @@ int main(void)
                     if(themeplaza_browser((RemoteMode) current_mode))
                     {
                         current_mode = MODE_THEMES;
-                        load_lists(lists);
+                        add_saved_zips(lists);
                     }
                     extra_mode = false;
                     draw_mode = DRAW_MODE_LIST;
@@ -880,6 +1083,13 @@ int main(void)
                     draw_mode = DRAW_MODE_LIST;
                     extra_index = 1;
                 }
+                else if(kDown & KEY_DRIGHT)
+                {
+                    search_menu(current_list, &search_indexes[current_mode]);
+                    extra_mode = false;
+                    draw_mode = DRAW_MODE_LIST;
+                    extra_index = 1;
+                }
                 else if (kDown & KEY_B)
                 {
                     extra_index = 1;
@@ -916,6 +1126,13 @@ int main(void)
                     draw_mode = DRAW_MODE_LIST;
                     extra_index = 1;
                 }
+                else if(kDown & KEY_DRIGHT)
+                {
+                    duplicates_menu(current_list, &duplicates[current_mode]);
+                    extra_mode = false;
+                    draw_mode = DRAW_MODE_LIST;
+                    extra_index = 1;
+                }
                 else if(kDown & KEY_B)
                 {
                     extra_index = 1;
@@ -937,14 +1154,7 @@ int main(void)
                 case MODE_SPLASHES:
                     draw_install(INSTALL_SPLASH);
                     splash_install(current_entry);
-                    for(int i = 0; i < current_list->entries_count; i++)
-                    {
-                        Entry_s * splash = &current_list->entries[i];
-                        if(splash == current_entry)
-                            splash->installed = true;
-                        else
-                            splash->installed = false;
-                    }
+                    list_mark_installed(current_list, current_entry);
                     break;
                 default:
                     break;
@@ -1064,14 +1274,7 @@ int main(void)
                         {
                             draw_install(INSTALL_SPLASH);
                             splash_install(current_entry);
-                            for(int i = 0; i < current_list->entries_count; i++)
-                            {
-                                Entry_s * splash = &current_list->entries[i];
-                                if(splash == current_entry)
-                                    splash->installed = true;
-                                else
-                                    splash->installed = false;
-                            }
+                            list_mark_installed(current_list, current_entry);
                         }
                     }
                     else if(BETWEEN(320-96, x, 320-72))
@@ -1097,7 +1300,7 @@ int main(void)
                     {
                         change_selected(current_list, -current_list->entries_per_screen_v);
                     }
-                    else if(current_list->entries != NULL && BETWEEN(arrowStartX + 16, x, arrowEndX + 16) && current_list->scroll < current_list->entries_count - current_list->entries_per_screen_v)
+                    else if(current_list->entries != NULL && BETWEEN(arrowStartX + 16, x, arrowEndX + 16) && current_list->scroll < list_get_count(current_list) - current_list->entries_per_screen_v)
                     {
                         change_selected(current_list, current_list->entries_per_screen_v);
                     }
@@ -1115,7 +1318,7 @@ int main(void)
                     {
                         u16 miny = 24 + current_list->entry_size * i;
                         u16 maxy = miny + current_list->entry_size;
-                        if(BETWEEN(miny, y, maxy) && current_list->scroll + i < current_list->entries_count)
+                        if(BETWEEN(miny, y, maxy) && current_list->scroll + i < list_get_count(current_list))
                         {
                             current_list->selected_entry = current_list->scroll + i;
                             break;
@@ -54,6 +54,21 @@ u8 read8(char *music_buf, size_t *cursor)
     return ret;
 }
 
+#ifdef __3DS__
+static size_t ogg_stream_read(void * ptr, size_t size, size_t nmemb, void * datasource)
+{
+    return stream_read((Data_Stream_s *)datasource, ptr, size * nmemb) / size;
+}
+
+int ogg_open_stream(audio_ogg_s * audio)
+{
+    // no seek callback: the file is only ever read front to back
+    ov_callbacks callbacks = {
+        .read_func = ogg_stream_read,
+    };
+    return ov_open_callbacks(&audio->stream, &audio->vf, NULL, 0, callbacks);
+}
+
 Result update_audio_ogg(audio_ogg_s * audio) 
 {
     u32 size = audio->wave_buf[audio->buf_pos].nsamples * 4 - audio->data_read;
@@ -70,7 +85,9 @@ Result update_audio_ogg(audio_ogg_s * audio)
             ov_clear(&audio->vf);
             if (read == 0) // EoF
             { 
-                ov_open(fmemopen(audio->filebuf, audio->filesize, "rb"), &audio->vf, NULL, 0); // Reopen file. Don't need to reinit channel stuff since it's all the same as before
+                // Reopen file. Don't need to reinit channel stuff since it's all the same as before
+                stream_rewind(&audio->stream);
+                ogg_open_stream(audio);
             } else // Error :(
             { 
                 DEBUG("<update_audio> Vorbis play error: %ld\n", read);
@@ -98,7 +115,7 @@ void thread_audio_ogg(void * data) {
     ndspChnWaveBufClear(0);
     ndspChnReset(0);
     ov_clear(&audio->vf);
-    free(audio->filebuf);
+    stream_close(&audio->stream);
     linearFree((void *)audio->wave_buf[0].data_vaddr);
     linearFree((void *)audio->wave_buf[1].data_vaddr);
 }
@@ -118,6 +135,7 @@ void stop_audio_ogg(audio_ogg_s ** audio_ptr) {
     free(audio);
     *audio_ptr = NULL;
 }
+#endif
 
 typedef struct {
     u16 type;
@@ -232,6 +250,7 @@ int init_audio(audio_s *audio)
     return 0;
 }
 
+#ifdef __3DS__
 int start_play(audio_s *audio) {
     audio->current_block = 0;
     for (u8 i = 0; i < audio->channel_count; ++i)
@@ -331,7 +350,7 @@ void fill_buffers(audio_s *audio)
 // Play a given audio struct
 void update_audio(audio_s * audio) 
 {
-    u32 current_time = svcGetSystemTick();
+    u32 current_time = platform_ticks();
     if (current_time - audio->last_time > 1e8)
     {
         fill_buffers(audio);
@@ -377,3 +396,4 @@ void stop_audio(audio_s ** audio_ptr) {
     free(audio);
     *audio_ptr = NULL;
 }
+#endif
@@ -0,0 +1,148 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+// The parts of the platform layer that are the same everywhere
+
+#include <string.h>
+
+#include "platform.h"
+
+static const u32 sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void sha256_block(u32 state[8], const u8 * block)
+{
+    u32 w[64];
+    for(int i = 0; i < 16; i++)
+        w[i] = ((u32)block[i * 4] << 24) | (block[i * 4 + 1] << 16) | (block[i * 4 + 2] << 8) | block[i * 4 + 3];
+    for(int i = 16; i < 64; i++)
+    {
+        const u32 s0 = ROTR(w[i - 15], 7) ^ ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        const u32 s1 = ROTR(w[i - 2], 17) ^ ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    u32 a = state[0], b = state[1], c = state[2], d = state[3];
+    u32 e = state[4], f = state[5], g = state[6], h = state[7];
+    for(int i = 0; i < 64; i++)
+    {
+        const u32 t1 = h + (ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25)) + ((e & f) ^ (~e & g)) + sha256_k[i] + w[i];
+        const u32 t2 = (ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+void platform_sha256_init(Platform_Sha256_s * context)
+{
+    static const u32 initial_state[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+    memcpy(context->state, initial_state, sizeof(initial_state));
+    context->size = 0;
+}
+
+void platform_sha256_update(Platform_Sha256_s * context, const void * data, size_t size)
+{
+    const u8 * bytes = data;
+    const u32 used = context->size & 63;
+    context->size += size;
+
+    // first fill the block the previous updates started
+    if(used != 0)
+    {
+        const size_t taken = size < 64 - used ? size : 64 - used;
+        memcpy(context->block + used, bytes, taken);
+        if(used + taken < 64)
+            return;
+
+        sha256_block(context->state, context->block);
+        bytes += taken;
+        size -= taken;
+    }
+
+    for(; size >= 64; size -= 64, bytes += 64)
+        sha256_block(context->state, bytes);
+    memcpy(context->block, bytes, size);
+}
+
+void platform_sha256_final(Platform_Sha256_s * context, u8 hash[SHA256_HASH_SIZE])
+{
+    // the last bytes, a 1 bit, and the size in bits at the end of the last block
+    u32 used = context->size & 63;
+    context->block[used++] = 0x80;
+    if(used > 56)
+    {
+        memset(context->block + used, 0, 64 - used);
+        sha256_block(context->state, context->block);
+        used = 0;
+    }
+    memset(context->block + used, 0, 56 - used);
+    const u64 bits = context->size * 8;
+    for(int i = 0; i < 8; i++)
+        context->block[63 - i] = bits >> (i * 8);
+    sha256_block(context->state, context->block);
+
+    for(int i = 0; i < 8; i++)
+    {
+        hash[i * 4] = context->state[i] >> 24;
+        hash[i * 4 + 1] = context->state[i] >> 16;
+        hash[i * 4 + 2] = context->state[i] >> 8;
+        hash[i * 4 + 3] = context->state[i];
+    }
+}
+
+#ifndef __3DS__
+
+// the console hashes whole buffers with FSUSER_UpdateSha256Context, see platform_ctr.c
+void platform_sha256(const void * data, size_t size, u8 hash[SHA256_HASH_SIZE])
+{
+    Platform_Sha256_s context;
+    platform_sha256_init(&context);
+    platform_sha256_update(&context, data, size);
+    platform_sha256_final(&context, hash);
+}
+
+#endif
@@ -0,0 +1,291 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifdef __3DS__
+
+#include "platform.h"
+#include "common.h"
+
+static FS_Archive archives[PLATFORM_ARCHIVES_AMOUNT];
+
+static FS_Archive get_archive(PlatformArchive archive)
+{
+    return archives[archive];
+}
+
+static FS_Path extdata_path(u32 * binary_path, u32 extdata_id)
+{
+    binary_path[0] = MEDIATYPE_SD;
+    binary_path[1] = extdata_id;
+    binary_path[2] = 0;
+    return (FS_Path){PATH_BINARY, 0xC, binary_path};
+}
+
+bool platform_not_found(Result res)
+{
+    return R_SUMMARY(res) == RS_NOTFOUND;
+}
+
+Result platform_archive_open(PlatformArchive archive, u32 extdata_id)
+{
+    if(archive == PLATFORM_ARCHIVE_SD)
+        return FSUSER_OpenArchive(&archives[archive], ARCHIVE_SDMC, fsMakePath(PATH_EMPTY, ""));
+
+    u32 binary_path[3];
+    return FSUSER_OpenArchive(&archives[archive], ARCHIVE_EXTDATA, extdata_path(binary_path, extdata_id));
+}
+
+Result platform_archive_create(PlatformArchive archive, u32 extdata_id)
+{
+    if(archive == PLATFORM_ARCHIVE_SD)
+        return MAKERESULT(RL_USAGE, RS_NOTSUPPORTED, RM_APPLICATION, RD_NOT_IMPLEMENTED);
+
+    // FSUSER_CreateExtSaveData, with an empty SMDH
+    u8 null_smdh[0x36C0] = {0};
+    Handle * handle = fsGetSessionHandle();
+
+    u32 * cmdbuf = getThreadCommandBuffer();
+
+    u32 directory_limit = 1000;
+    u32 file_limit = 1000;
+
+    cmdbuf[0] = 0x08300182;
+    cmdbuf[1] = MEDIATYPE_SD;
+    cmdbuf[2] = extdata_id;
+    cmdbuf[3] = 0;
+    cmdbuf[4] = 0x36C0;
+    cmdbuf[5] = directory_limit;
+    cmdbuf[6] = file_limit;
+    cmdbuf[7] = (0x36C0 << 4) | 0xA;
+    cmdbuf[8] = (u32)&null_smdh;
+
+    Result res = 0;
+    if((res = svcSendSyncRequest(*handle)))
+        return res;
+
+    return cmdbuf[1];
+}
+
+Result platform_archive_close(PlatformArchive archive)
+{
+    return FSUSER_CloseArchive(archives[archive]);
+}
+
+Result platform_file_open(Platform_File * file, PlatformArchive archive, const u16 * path, u32 flags)
+{
+    u32 open_flags = 0;
+    if(flags & PLATFORM_OPEN_READ)
+        open_flags |= FS_OPEN_READ;
+    if(flags & PLATFORM_OPEN_WRITE)
+        open_flags |= FS_OPEN_WRITE;
+
+    return FSUSER_OpenFile(file, get_archive(archive), fsMakePath(PATH_UTF16, path), open_flags, 0);
+}
+
+Result platform_file_read(Platform_File file, u64 offset, void * buf, u32 size, u32 * read)
+{
+    return FSFILE_Read(file, read, offset, buf, size);
+}
+
+Result platform_file_write(Platform_File file, u64 offset, const void * buf, u32 size, u32 * written)
+{
+    return FSFILE_Write(file, written, offset, buf, size, 0);
+}
+
+Result platform_file_get_size(Platform_File file, u64 * size)
+{
+    return FSFILE_GetSize(file, size);
+}
+
+Result platform_file_flush(Platform_File file)
+{
+    return FSFILE_Flush(file);
+}
+
+void platform_file_close(Platform_File file)
+{
+    FSFILE_Close(file);
+}
+
+Result platform_file_create(PlatformArchive archive, const u16 * path, u64 size)
+{
+    return FSUSER_CreateFile(get_archive(archive), fsMakePath(PATH_UTF16, path), 0, size);
+}
+
+Result platform_file_delete(PlatformArchive archive, const u16 * path)
+{
+    return FSUSER_DeleteFile(get_archive(archive), fsMakePath(PATH_UTF16, path));
+}
+
+Result platform_file_get_mtime(PlatformArchive archive, const u16 * path, u64 * mtime)
+{
+    if(archive != PLATFORM_ARCHIVE_SD)
+        return MAKERESULT(RL_USAGE, RS_NOTSUPPORTED, RM_APPLICATION, RD_NOT_IMPLEMENTED);
+
+    // goes through the sdmc: devoptab, which asks the archive for the timestamp
+    char utf8_path[0x106 * 3 + 6] = "sdmc:";
+    const ssize_t len = utf16_to_utf8((u8 *)utf8_path + 5, path, sizeof(utf8_path) - 6);
+    if(len < 0)
+        return MAKERESULT(RL_USAGE, RS_INVALIDARG, RM_APPLICATION, RD_INVALID_COMBINATION);
+    utf8_path[5 + len] = '\0';
+
+    return sdmc_getmtime(utf8_path, mtime);
+}
+
+Result platform_dir_open(Platform_Dir * dir, PlatformArchive archive, const u16 * path)
+{
+    return FSUSER_OpenDirectory(dir, get_archive(archive), fsMakePath(PATH_UTF16, path));
+}
+
+#define DIR_READ_BATCH 0x40
+
+Result platform_dir_read(Platform_Dir dir, Platform_Dir_Entry_s * entries, u32 count, u32 * read)
+{
+    *read = 0;
+    // an FS_DirectoryEntry doesn't fit in a Platform_Dir_Entry_s, they go through a buffer
+    const u32 buffer_count = count < DIR_READ_BATCH ? count : DIR_READ_BATCH;
+    FS_DirectoryEntry * dir_entries = malloc(buffer_count * sizeof(FS_DirectoryEntry));
+    if(dir_entries == NULL)
+        return MAKERESULT(RL_PERMANENT, RS_OUTOFRESOURCE, RM_APPLICATION, RD_OUT_OF_MEMORY);
+
+    Result res = 0;
+    while(*read < count)
+    {
+        const u32 batch = count - *read < buffer_count ? count - *read : buffer_count;
+        u32 entries_read = 0;
+        if(R_FAILED(res = FSDIR_Read(dir, &entries_read, batch, dir_entries)))
+            break;
+
+        for(u32 i = 0; i < entries_read; i++)
+        {
+            const FS_DirectoryEntry * dir_entry = &dir_entries[i];
+            Platform_Dir_Entry_s * entry = &entries[*read + i];
+            memcpy(entry->name, dir_entry->name, sizeof(entry->name));
+            memcpy(entry->short_ext, dir_entry->shortExt, sizeof(entry->short_ext));
+            entry->is_directory = dir_entry->attributes & FS_ATTRIBUTE_DIRECTORY;
+            entry->is_hidden = dir_entry->attributes & FS_ATTRIBUTE_HIDDEN;
+            entry->size = dir_entry->fileSize;
+        }
+        *read += entries_read;
+
+        if(entries_read != batch)
+            break;
+    }
+
+    free(dir_entries);
+    return res;
+}
+
+void platform_dir_close(Platform_Dir dir)
+{
+    FSDIR_Close(dir);
+}
+
+Result platform_dir_create(PlatformArchive archive, const u16 * path)
+{
+    return FSUSER_CreateDirectory(get_archive(archive), fsMakePath(PATH_UTF16, path), FS_ATTRIBUTE_DIRECTORY);
+}
+
+Result platform_dir_delete(PlatformArchive archive, const u16 * path)
+{
+    return FSUSER_DeleteDirectoryRecursively(get_archive(archive), fsMakePath(PATH_UTF16, path));
+}
+
+Platform_Thread platform_thread_create(void (*entry)(void *), void * arg, size_t stack_size, int priority, int core)
+{
+    return threadCreate(entry, arg, stack_size, priority, core, false);
+}
+
+void platform_thread_join(Platform_Thread thread)
+{
+    threadJoin(thread, U64_MAX);
+    threadFree(thread);
+}
+
+int platform_core_count(void)
+{
+    // the system core is mostly taken, but the New 3DS has a whole extra one
+    bool is_new3ds = false;
+    APT_CheckNew3DS(&is_new3ds);
+    return is_new3ds ? 2 : 1;
+}
+
+int platform_core_id(int n)
+{
+    return n == 0 ? -2 : 2;
+}
+
+void platform_mutex_init(Platform_Mutex * mutex)
+{
+    LightLock_Init(mutex);
+}
+
+void platform_mutex_lock(Platform_Mutex * mutex)
+{
+    LightLock_Lock(mutex);
+}
+
+void platform_mutex_unlock(Platform_Mutex * mutex)
+{
+    LightLock_Unlock(mutex);
+}
+
+void platform_event_init(Platform_Event * event, bool sticky)
+{
+    LightEvent_Init(event, sticky ? RESET_STICKY : RESET_ONESHOT);
+}
+
+void platform_event_signal(Platform_Event * event)
+{
+    LightEvent_Signal(event);
+}
+
+void platform_event_wait(Platform_Event * event)
+{
+    LightEvent_Wait(event);
+}
+
+void platform_event_clear(Platform_Event * event)
+{
+    LightEvent_Clear(event);
+}
+
+u64 platform_ticks(void)
+{
+    return svcGetSystemTick();
+}
+
+u64 platform_ticks_to_us(u64 ticks)
+{
+    return ticks * 1000 / CPU_TICKS_PER_MSEC;
+}
+
+void platform_sha256(const void * data, size_t size, u8 hash[SHA256_HASH_SIZE])
+{
+    FSUSER_UpdateSha256Context(data, size, hash);
+}
+
+#endif
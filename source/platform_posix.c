@@ -0,0 +1,476 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef __3DS__
+
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "platform.h"
+
+#define PLATFORM_PATH_SIZE 0x400
+
+struct Platform_Dir_s {
+    DIR * dir;
+    char path[PLATFORM_PATH_SIZE];
+};
+
+struct Platform_Thread_s {
+    pthread_t thread;
+    void (*entry)(void *);
+    void * arg;
+};
+
+static const char * archive_dirs[PLATFORM_ARCHIVES_AMOUNT] = {
+    "sdmc",
+    "home_ext",
+    "theme_ext",
+    "badge_ext",
+};
+
+// <root>/<archive dir><path>, with the path turned into UTF-8
+static void make_path(char * out, PlatformArchive archive, const u16 * path)
+{
+    const char * root = getenv("PLATFORM_ROOT");
+    int len = snprintf(out, PLATFORM_PATH_SIZE, "%s/%s", root != NULL ? root : ".", archive_dirs[archive]);
+
+    for(; *path != 0 && len < PLATFORM_PATH_SIZE - 4; path++)
+    {
+        u32 c = *path;
+        if(c >= 0xD800 && c < 0xDC00 && path[1] >= 0xDC00 && path[1] < 0xE000)
+        {
+            c = 0x10000 + ((c - 0xD800) << 10) + (path[1] - 0xDC00);
+            path++;
+        }
+
+        if(c < 0x80)
+        {
+            out[len++] = c;
+        }
+        else if(c < 0x800)
+        {
+            out[len++] = 0xC0 | (c >> 6);
+            out[len++] = 0x80 | (c & 0x3F);
+        }
+        else if(c < 0x10000)
+        {
+            out[len++] = 0xE0 | (c >> 12);
+            out[len++] = 0x80 | ((c >> 6) & 0x3F);
+            out[len++] = 0x80 | (c & 0x3F);
+        }
+        else
+        {
+            out[len++] = 0xF0 | (c >> 18);
+            out[len++] = 0x80 | ((c >> 12) & 0x3F);
+            out[len++] = 0x80 | ((c >> 6) & 0x3F);
+            out[len++] = 0x80 | (c & 0x3F);
+        }
+    }
+    out[len] = '\0';
+}
+
+// names coming back from readdir, UTF-8 to UTF-16
+static void to_utf16(u16 * out, const char * in, size_t out_size)
+{
+    const u8 * cursor = (const u8 *)in;
+    size_t len = 0;
+    while(*cursor != 0 && len < out_size - 2)
+    {
+        u32 c = *cursor++;
+        int following = 0;
+        if(c >= 0xF0)
+        {
+            c &= 0x07;
+            following = 3;
+        }
+        else if(c >= 0xE0)
+        {
+            c &= 0x0F;
+            following = 2;
+        }
+        else if(c >= 0xC0)
+        {
+            c &= 0x1F;
+            following = 1;
+        }
+
+        for(; following > 0 && (*cursor & 0xC0) == 0x80; following--)
+            c = (c << 6) | (*cursor++ & 0x3F);
+
+        if(c >= 0x10000)
+        {
+            c -= 0x10000;
+            out[len++] = 0xD800 | (c >> 10);
+            out[len++] = 0xDC00 | (c & 0x3FF);
+        }
+        else
+        {
+            out[len++] = c;
+        }
+    }
+    out[len] = 0;
+}
+
+static Result errno_result(void)
+{
+    return errno != 0 ? -errno : -EIO;
+}
+
+bool platform_not_found(Result res)
+{
+    return res == -ENOENT;
+}
+
+Result platform_archive_open(PlatformArchive archive, u32 extdata_id)
+{
+    (void)extdata_id;
+
+    char full_path[PLATFORM_PATH_SIZE];
+    const u16 root[] = {0};
+    make_path(full_path, archive, root);
+
+    // the SD is always there, the extdata has to be made first
+    if(archive == PLATFORM_ARCHIVE_SD)
+        mkdir(full_path, 0755);
+
+    struct stat st;
+    if(stat(full_path, &st) != 0)
+        return errno_result();
+    return S_ISDIR(st.st_mode) ? 0 : -ENOTDIR;
+}
+
+Result platform_archive_create(PlatformArchive archive, u32 extdata_id)
+{
+    (void)extdata_id;
+
+    char full_path[PLATFORM_PATH_SIZE];
+    const u16 root[] = {0};
+    make_path(full_path, archive, root);
+    return mkdir(full_path, 0755) != 0 ? errno_result() : 0;
+}
+
+Result platform_archive_close(PlatformArchive archive)
+{
+    (void)archive;
+    return 0;
+}
+
+Result platform_file_open(Platform_File * file, PlatformArchive archive, const u16 * path, u32 flags)
+{
+    char full_path[PLATFORM_PATH_SIZE];
+    make_path(full_path, archive, path);
+
+    int open_flags = O_RDONLY;
+    if((flags & PLATFORM_OPEN_READ) && (flags & PLATFORM_OPEN_WRITE))
+        open_flags = O_RDWR;
+    else if(flags & PLATFORM_OPEN_WRITE)
+        open_flags = O_WRONLY;
+
+    *file = open(full_path, open_flags);
+    return *file < 0 ? errno_result() : 0;
+}
+
+Result platform_file_read(Platform_File file, u64 offset, void * buf, u32 size, u32 * read)
+{
+    ssize_t done = pread(file, buf, size, offset);
+    if(read != NULL)
+        *read = done < 0 ? 0 : done;
+    return done < 0 ? errno_result() : 0;
+}
+
+Result platform_file_write(Platform_File file, u64 offset, const void * buf, u32 size, u32 * written)
+{
+    ssize_t done = pwrite(file, buf, size, offset);
+    if(written != NULL)
+        *written = done < 0 ? 0 : done;
+    return done < 0 ? errno_result() : 0;
+}
+
+Result platform_file_get_size(Platform_File file, u64 * size)
+{
+    struct stat st;
+    if(fstat(file, &st) != 0)
+        return errno_result();
+    *size = st.st_size;
+    return 0;
+}
+
+Result platform_file_flush(Platform_File file)
+{
+    return fsync(file) != 0 ? errno_result() : 0;
+}
+
+void platform_file_close(Platform_File file)
+{
+    close(file);
+}
+
+Result platform_file_create(PlatformArchive archive, const u16 * path, u64 size)
+{
+    char full_path[PLATFORM_PATH_SIZE];
+    make_path(full_path, archive, path);
+
+    // like the console, fails if the file is already there
+    int fd = open(full_path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+    if(fd < 0)
+        return errno_result();
+
+    Result res = ftruncate(fd, size) != 0 ? errno_result() : 0;
+    close(fd);
+    return res;
+}
+
+Result platform_file_delete(PlatformArchive archive, const u16 * path)
+{
+    char full_path[PLATFORM_PATH_SIZE];
+    make_path(full_path, archive, path);
+    return unlink(full_path) != 0 ? errno_result() : 0;
+}
+
+Result platform_file_get_mtime(PlatformArchive archive, const u16 * path, u64 * mtime)
+{
+    char full_path[PLATFORM_PATH_SIZE];
+    make_path(full_path, archive, path);
+
+    struct stat st;
+    if(stat(full_path, &st) != 0)
+        return errno_result();
+    *mtime = st.st_mtime;
+    return 0;
+}
+
+Result platform_dir_open(Platform_Dir * dir, PlatformArchive archive, const u16 * path)
+{
+    *dir = calloc(1, sizeof(struct Platform_Dir_s));
+    if(*dir == NULL)
+        return -ENOMEM;
+
+    make_path((*dir)->path, archive, path);
+    (*dir)->dir = opendir((*dir)->path);
+    if((*dir)->dir == NULL)
+    {
+        const Result res = errno_result();
+        free(*dir);
+        *dir = NULL;
+        return res;
+    }
+    return 0;
+}
+
+// one entry, false once every entry was read
+static bool dir_next(Platform_Dir dir, Platform_Dir_Entry_s * entry)
+{
+    struct dirent * dir_entry;
+    do {
+        dir_entry = readdir(dir->dir);
+    } while(dir_entry != NULL && (!strcmp(dir_entry->d_name, ".") || !strcmp(dir_entry->d_name, "..")));
+
+    if(dir_entry == NULL)
+        return false;
+
+    char full_path[PLATFORM_PATH_SIZE * 2];
+    snprintf(full_path, sizeof(full_path), "%s/%s", dir->path, dir_entry->d_name);
+    struct stat st;
+    if(stat(full_path, &st) != 0)
+        memset(&st, 0, sizeof(st));
+
+    to_utf16(entry->name, dir_entry->d_name, sizeof(entry->name) / sizeof(u16));
+    entry->is_directory = S_ISDIR(st.st_mode);
+    entry->is_hidden = dir_entry->d_name[0] == '.';
+    entry->size = entry->is_directory ? 0 : st.st_size;
+
+    // the console only has an extension in the short name of files with one of up to 3 characters
+    memset(entry->short_ext, 0, sizeof(entry->short_ext));
+    const char * ext = strrchr(dir_entry->d_name, '.');
+    if(!entry->is_directory && ext != NULL && ext != dir_entry->d_name)
+    {
+        for(int i = 0; i < 3 && ext[i + 1] != '\0'; i++)
+            entry->short_ext[i] = toupper((unsigned char)ext[i + 1]);
+    }
+    return true;
+}
+
+Result platform_dir_read(Platform_Dir dir, Platform_Dir_Entry_s * entries, u32 count, u32 * read)
+{
+    for(*read = 0; *read < count && dir_next(dir, &entries[*read]); (*read)++)
+        ;
+    return 0;
+}
+
+void platform_dir_close(Platform_Dir dir)
+{
+    if(dir == NULL)
+        return;
+    closedir(dir->dir);
+    free(dir);
+}
+
+Result platform_dir_create(PlatformArchive archive, const u16 * path)
+{
+    char full_path[PLATFORM_PATH_SIZE];
+    make_path(full_path, archive, path);
+    return mkdir(full_path, 0755) != 0 ? errno_result() : 0;
+}
+
+static int delete_callback(const char * path, const struct stat * st, int type, struct FTW * ftw)
+{
+    (void)st;
+    (void)type;
+    (void)ftw;
+    return remove(path);
+}
+
+Result platform_dir_delete(PlatformArchive archive, const u16 * path)
+{
+    char full_path[PLATFORM_PATH_SIZE];
+    make_path(full_path, archive, path);
+    return nftw(full_path, delete_callback, 16, FTW_DEPTH | FTW_PHYS) != 0 ? errno_result() : 0;
+}
+
+#define HOST_STACK_MIN 0x40000
+
+static void * thread_entry(void * arg)
+{
+    Platform_Thread thread = (Platform_Thread)arg;
+    thread->entry(thread->arg);
+    return NULL;
+}
+
+Platform_Thread platform_thread_create(void (*entry)(void *), void * arg, size_t stack_size, int priority, int core)
+{
+    (void)priority;
+    (void)core;
+
+    Platform_Thread thread = malloc(sizeof(struct Platform_Thread_s));
+    if(thread == NULL)
+        return NULL;
+
+    thread->entry = entry;
+    thread->arg = arg;
+
+    // the stack sizes are the ones of the console, the libc and the sanitizers of a computer want more
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, stack_size > HOST_STACK_MIN ? stack_size : HOST_STACK_MIN);
+    const int res = pthread_create(&thread->thread, &attr, thread_entry, thread);
+    pthread_attr_destroy(&attr);
+
+    if(res != 0)
+    {
+        free(thread);
+        return NULL;
+    }
+    return thread;
+}
+
+void platform_thread_join(Platform_Thread thread)
+{
+    pthread_join(thread->thread, NULL);
+    free(thread);
+}
+
+int platform_core_count(void)
+{
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count < 1 ? 1 : (int)count;
+}
+
+int platform_core_id(int n)
+{
+    return n;
+}
+
+void platform_mutex_init(Platform_Mutex * mutex)
+{
+    pthread_mutex_init(mutex, NULL);
+}
+
+void platform_mutex_lock(Platform_Mutex * mutex)
+{
+    pthread_mutex_lock(mutex);
+}
+
+void platform_mutex_unlock(Platform_Mutex * mutex)
+{
+    pthread_mutex_unlock(mutex);
+}
+
+void platform_event_init(Platform_Event * event, bool sticky)
+{
+    pthread_mutex_init(&event->mutex, NULL);
+    pthread_cond_init(&event->cond, NULL);
+    event->signaled = false;
+    event->sticky = sticky;
+}
+
+void platform_event_signal(Platform_Event * event)
+{
+    pthread_mutex_lock(&event->mutex);
+    event->signaled = true;
+    pthread_cond_broadcast(&event->cond);
+    pthread_mutex_unlock(&event->mutex);
+}
+
+void platform_event_wait(Platform_Event * event)
+{
+    pthread_mutex_lock(&event->mutex);
+    while(!event->signaled)
+        pthread_cond_wait(&event->cond, &event->mutex);
+    if(!event->sticky)
+        event->signaled = false;
+    pthread_mutex_unlock(&event->mutex);
+}
+
+void platform_event_clear(Platform_Event * event)
+{
+    pthread_mutex_lock(&event->mutex);
+    event->signaled = false;
+    pthread_mutex_unlock(&event->mutex);
+}
+
+u64 platform_ticks(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (u64)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+u64 platform_ticks_to_us(u64 ticks)
+{
+    return ticks / 1000;
+}
+
+#endif
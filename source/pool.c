@@ -0,0 +1,144 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include "pool.h"
+
+// put in front of every buffer, so pool_free knows where it goes back to
+typedef struct {
+    u32 size_class; // POOL_CLASSES_COUNT for buffers that didn't fit in one
+    u32 size; // usable size
+} Pool_Header_s;
+
+typedef struct {
+    Pool_Header_s * free[POOL_KEEP_PER_CLASS];
+    int free_count;
+} Pool_Class_s;
+
+static Pool_Class_s classes[POOL_CLASSES_COUNT];
+static Pool_Stats_s pool_stats;
+static Platform_Mutex pool_lock;
+
+static u32 get_size_class(u32 size)
+{
+    u32 size_class = 0;
+    u32 class_size = POOL_MIN_SIZE;
+    while(class_size < size && size_class < POOL_CLASSES_COUNT)
+    {
+        class_size <<= 1;
+        size_class++;
+    }
+    return size_class;
+}
+
+void pool_init(void)
+{
+    platform_mutex_init(&pool_lock);
+}
+
+void pool_exit(void)
+{
+    platform_mutex_lock(&pool_lock);
+    DEBUG("pool: %lu allocations, %lu reused, high water 0x%lx bytes\n", pool_stats.allocations, pool_stats.reuses, pool_stats.high_water);
+    for(int i = 0; i < POOL_CLASSES_COUNT; i++)
+    {
+        for(int j = 0; j < classes[i].free_count; j++)
+            free(classes[i].free[j]);
+        classes[i].free_count = 0;
+    }
+    pool_stats.cached = 0;
+    platform_mutex_unlock(&pool_lock);
+}
+
+void * pool_alloc(u32 size)
+{
+    const u32 size_class = get_size_class(size);
+    Pool_Header_s * header = NULL;
+
+    platform_mutex_lock(&pool_lock);
+    pool_stats.allocations++;
+    if(size_class < POOL_CLASSES_COUNT && classes[size_class].free_count != 0)
+    {
+        header = classes[size_class].free[--classes[size_class].free_count];
+        pool_stats.cached -= header->size;
+        pool_stats.reuses++;
+    }
+    platform_mutex_unlock(&pool_lock);
+
+    if(header == NULL)
+    {
+        const u32 usable = size_class < POOL_CLASSES_COUNT ? (u32)(POOL_MIN_SIZE << size_class) : size;
+        header = malloc(sizeof(Pool_Header_s) + usable);
+        if(header == NULL)
+        {
+            DEBUG("pool: out of memory for 0x%lx bytes\n", size);
+            return NULL;
+        }
+
+        header->size_class = size_class;
+        header->size = usable;
+    }
+
+    platform_mutex_lock(&pool_lock);
+    pool_stats.in_use += header->size;
+    if(pool_stats.in_use > pool_stats.high_water)
+        pool_stats.high_water = pool_stats.in_use;
+    platform_mutex_unlock(&pool_lock);
+
+    return header + 1;
+}
+
+void pool_free(void * buf)
+{
+    if(buf == NULL)
+        return;
+
+    Pool_Header_s * header = (Pool_Header_s *)buf - 1;
+    bool kept = false;
+
+    platform_mutex_lock(&pool_lock);
+    pool_stats.in_use -= header->size;
+    if(header->size_class < POOL_CLASSES_COUNT)
+    {
+        Pool_Class_s * const size_class = &classes[header->size_class];
+        if(size_class->free_count < POOL_KEEP_PER_CLASS)
+        {
+            size_class->free[size_class->free_count++] = header;
+            pool_stats.cached += header->size;
+            kept = true;
+        }
+    }
+    platform_mutex_unlock(&pool_lock);
+
+    if(!kept)
+        free(header);
+}
+
+void pool_get_stats(Pool_Stats_s * stats)
+{
+    platform_mutex_lock(&pool_lock);
+    memcpy(stats, &pool_stats, sizeof(Pool_Stats_s));
+    platform_mutex_unlock(&pool_lock);
+}
@@ -89,7 +89,7 @@ static void load_remote_metadata(Entry_s * entry)
     }
 }
 */ 
-static void load_remote_smdh(Entry_s * entry, C3D_Tex * into_tex, const Entry_Icon_s * icon_info, bool ignore_cache)
+static void load_remote_smdh(Entry_List_s * list, Entry_s * entry, C3D_Tex * into_tex, const Entry_Icon_s * icon_info, bool ignore_cache)
 {
     bool not_cached = true;
     char * smdh_buf = NULL;
@@ -120,22 +120,18 @@ static void load_remote_smdh(Entry_s * entry, C3D_Tex * into_tex, const Entry_Ic
 
     Icon_s * smdh = (Icon_s *)smdh_buf;
 
-    u16 fallback_name[0x81] = { 0 };
-    utf8_to_utf16(fallback_name, (u8 *)"No name", 0x80);
-
-    parse_smdh(smdh, entry, fallback_name);
+    parse_smdh(smdh, entry, (const u16 *)u"No name", &list->strings);
 
     if(smdh_buf != NULL)
     {
         copy_texture_data(into_tex, smdh->big_icon, icon_info);
         if (not_cached)
         {
-            FSUSER_CreateDirectory(ArchiveSD, fsMakePath(PATH_UTF16, entry->path), FS_ATTRIBUTE_DIRECTORY);
+            platform_dir_create(PLATFORM_ARCHIVE_SD, entry->path);
             u16 path[0x107] = { 0 };
             strucat(path, entry->path);
             struacat(path, "/info.smdh");
-            remake_file(fsMakePath(PATH_UTF16, path), ArchiveSD, smdh_size);
-            buf_to_file(smdh_size, fsMakePath(PATH_UTF16, path), ArchiveSD, smdh_buf);
+            write_file(path, PLATFORM_ARCHIVE_SD, smdh_buf, smdh_size, smdh_size);
         }
         free(smdh_buf);
     }
@@ -143,26 +139,37 @@ static void load_remote_smdh(Entry_s * entry, C3D_Tex * into_tex, const Entry_Ic
 
 static void load_remote_entries(Entry_List_s * list, json_t * ids_array, bool ignore_cache, InstallType type)
 {
-    free(list->entries);
-    list->entries_count = json_array_size(ids_array);
-    list->entries = calloc(list->entries_count, sizeof(Entry_s));
-    list->entries_loaded = list->entries_count;
+    list_free_entries(list);
+    arena_free(&list->strings);
+    const int entries_count = json_array_size(ids_array);
+    list_init_capacity(list, entries_count);
+    list->entries_loaded = entries_count;
 
     size_t i = 0;
     json_t * id = NULL;
     json_array_foreach(ids_array, i, id)
     {
-        draw_loading_bar(i, list->entries_count, type);
-        Entry_s * current_entry = &list->entries[i];
+        draw_loading_bar(i, entries_count, type);
+        const ssize_t new_entry_index = list_add_entry(list);
+        if(new_entry_index < 0)
+            break;
+
+        Entry_s * current_entry = get_entry_at(list, new_entry_index);
+        memset(current_entry, 0, sizeof(Entry_s));
         current_entry->tp_download_id = json_integer_value(id);
 
+        // the cache folder is an absolute path, there's no loading path for remote entries
         char * entry_path = NULL;
         asprintf(&entry_path, CACHE_PATH_FORMAT, current_entry->tp_download_id);
-        utf8_to_utf16(current_entry->path, (u8 *)entry_path, 0x106);
+        current_entry->path = arena_add_utf8(&list->strings, entry_path);
         free(entry_path);
+        current_entry->name = (const u16 *)u"";
+        current_entry->desc = (const u16 *)u"";
+        current_entry->author = (const u16 *)u"";
 
-        load_remote_smdh(current_entry, &list->icons_texture, &list->icons_info[i], ignore_cache);
+        load_remote_smdh(list, current_entry, &list->icons_texture, &list->icons_info[i], ignore_cache);
     }
+    flush_texture_data(&list->icons_texture);
 }
 
 static void load_remote_list(Entry_List_s * list, json_int_t page, RemoteMode mode, bool ignore_cache)
@@ -241,7 +248,7 @@ static bool load_remote_preview(const Entry_s * entry, C2D_Image * preview_image
 {
     bool not_cached = true;
 
-    if (!memcmp(&previous_path_preview, entry->path, 0x106 * sizeof(u16))) return true;
+    if (!memcmp(&previous_path_preview, entry->path, (strulen(entry->path, 0x105) + 1) * sizeof(u16))) return true;
 
     char * preview_png = NULL;
     u32 preview_size = load_data("/preview.png", entry, &preview_png);
@@ -287,8 +294,7 @@ static bool load_remote_preview(const Entry_s * entry, C2D_Image * preview_image
         u16 path[0x107] = { 0 };
         strucat(path, entry->path);
         struacat(path, "/preview.png");
-        remake_file(fsMakePath(PATH_UTF16, path), ArchiveSD, preview_size);
-        buf_to_file(preview_size, fsMakePath(PATH_UTF16, path), ArchiveSD, preview_png);
+        write_file(path, PLATFORM_ARCHIVE_SD, preview_png, preview_size, preview_size);
     }
 
     free(preview_png);
@@ -300,7 +306,7 @@ static u16 previous_path_bgm[0x106];
 
 static void load_remote_bgm(const Entry_s * entry)
 {
-    if (!memcmp(&previous_path_bgm, entry->path, 0x106 * sizeof(u16))) return;
+    if (!memcmp(&previous_path_bgm, entry->path, (strulen(entry->path, 0x105) + 1) * sizeof(u16))) return;
 
     char * bgm_ogg = NULL;
     u32 bgm_size = load_data("/bgm.ogg", entry, &bgm_ogg);
@@ -326,10 +332,9 @@ static void load_remote_bgm(const Entry_s * entry)
         u16 path[0x107] = { 0 };
         strucat(path, entry->path);
         struacat(path, "/bgm.ogg");
-        remake_file(fsMakePath(PATH_UTF16, path), ArchiveSD, bgm_size);
-        buf_to_file(bgm_size, fsMakePath(PATH_UTF16, path), ArchiveSD, bgm_ogg);
+        write_file(path, PLATFORM_ARCHIVE_SD, bgm_ogg, bgm_size, bgm_size);
 
-        memcpy(&previous_path_bgm, entry->path, 0x106 * sizeof(u16));
+        memcpy(&previous_path_bgm, entry->path, (strulen(entry->path, 0x105) + 1) * sizeof(u16));
     }
 
     free(bgm_ogg);
@@ -616,7 +621,7 @@ bool themeplaza_browser(RemoteMode mode)
         }
 
         int selected_entry = current_list->selected_entry;
-        Entry_s * current_entry = &current_list->entries[selected_entry];
+        Entry_s * current_entry = list_get_entry(current_list, selected_entry);
 
         if (kDown & KEY_Y)
         {
@@ -793,7 +798,8 @@ bool themeplaza_browser(RemoteMode mode)
     free_preview(preview);
 
     free_icons(current_list);
-    free(current_list->entries);
+    list_free_entries(current_list);
+    arena_free(&current_list->strings);
     free(current_list->tp_search);
     free(last_search);
 
@@ -0,0 +1,256 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include "search_index.h"
+#include "unicode.h"
+
+#define SEARCH_QUERY_MAX 0x100
+
+static u32 hash_trigram(u16 a, u16 b, u16 c)
+{
+    u32 hash = (a * 0x9E3779B1u) ^ (b * 0x85EBCA77u) ^ (c * 0xC2B2AE3Du);
+    return (hash ^ (hash >> 15)) & (SEARCH_INDEX_BUCKETS - 1);
+}
+
+// counts the buckets of the entry's trigrams, and puts its id in them if ids is given
+static void add_entry_trigrams(const Entry_s * entry, u32 * last, u32 * counts, u32 * ids)
+{
+    const u16 * fields[3] = { entry->name, entry->author, entry->desc };
+    for(int i = 0; i < 3; i++)
+    {
+        const u16 * str = fields[i];
+        if(str == NULL || str[0] == 0 || str[1] == 0)
+            continue;
+
+        u16 a = fold_case(str[0]), b = fold_case(str[1]);
+        for(const u16 * c = str + 2; *c != 0; c++)
+        {
+            const u16 folded = fold_case(*c);
+            const u32 bucket = hash_trigram(a, b, folded);
+            a = b;
+            b = folded;
+
+            // once per entry, even if the trigram shows up again
+            if(last[bucket] == entry->id + 1)
+                continue;
+            last[bucket] = entry->id + 1;
+
+            if(ids != NULL)
+                ids[counts[bucket]] = entry->id;
+            counts[bucket]++;
+        }
+    }
+}
+
+bool search_index_build(Search_Index_s * index, Entry_List_s * list)
+{
+    search_index_free(index);
+
+    const u32 count = list->entries_count;
+    u32 * last = malloc(2 * SEARCH_INDEX_BUCKETS * sizeof(u32));
+    index->starts = calloc(SEARCH_INDEX_BUCKETS + 1, sizeof(u32));
+    if(last == NULL || index->starts == NULL)
+    {
+        free(last);
+        search_index_free(index);
+        return false;
+    }
+
+    platform_mutex_lock(&list->info_lock);
+
+    // going through the entries by id keeps the ids of every bucket in order
+    Entry_Walk_s walk;
+    list_walk_start(&walk, list);
+    memset(last, 0, SEARCH_INDEX_BUCKETS * sizeof(u32));
+    for(u32 id = 0; id < count; id++)
+        add_entry_trigrams(list_walk_entry(&walk, id), last, index->starts + 1, NULL);
+
+    for(u32 i = 0; i < SEARCH_INDEX_BUCKETS; i++)
+        index->starts[i + 1] += index->starts[i];
+
+    index->ids = malloc(max(index->starts[SEARCH_INDEX_BUCKETS], 1) * sizeof(u32));
+    if(index->ids != NULL)
+    {
+        u32 * const fill = last + SEARCH_INDEX_BUCKETS;
+        memcpy(fill, index->starts, SEARCH_INDEX_BUCKETS * sizeof(u32));
+        memset(last, 0, SEARCH_INDEX_BUCKETS * sizeof(u32));
+        for(u32 id = 0; id < count; id++)
+            add_entry_trigrams(list_walk_entry(&walk, id), last, fill, index->ids);
+
+        index->generation = list->info_generation;
+    }
+
+    list_walk_end(&walk);
+    platform_mutex_unlock(&list->info_lock);
+
+    free(last);
+
+    if(index->ids == NULL)
+    {
+        search_index_free(index);
+        return false;
+    }
+
+    DEBUG("search index: %lu trigrams for %lu entries\n", index->starts[SEARCH_INDEX_BUCKETS], count);
+    return true;
+}
+
+void search_index_free(Search_Index_s * index)
+{
+    free(index->starts);
+    free(index->ids);
+    memset(index, 0, sizeof(Search_Index_s));
+}
+
+static bool bucket_has_id(const Search_Index_s * index, u32 bucket, u32 id)
+{
+    u32 low = index->starts[bucket], high = index->starts[bucket + 1];
+    while(low < high)
+    {
+        const u32 middle = low + (high - low) / 2;
+        if(index->ids[middle] < id)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low < index->starts[bucket + 1] && index->ids[low] == id;
+}
+
+static bool contains_folded(const u16 * str, const u16 * query, int len)
+{
+    if(str == NULL)
+        return false;
+
+    for(; *str != 0; str++)
+    {
+        int i = 0;
+        while(i < len && str[i] != 0 && fold_case(str[i]) == query[i])
+            i++;
+        if(i == len)
+            return true;
+    }
+    return false;
+}
+
+static bool entry_matches(const Entry_s * entry, const u16 * query, int len)
+{
+    return contains_folded(entry->name, query, len) || contains_folded(entry->author, query, len) || contains_folded(entry->desc, query, len);
+}
+
+static int compare_view_indexes(const void * a, const void * b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+int search_index_filter(Search_Index_s * index, Entry_List_s * list, const char * query)
+{
+    u16 folded[SEARCH_QUERY_MAX + 1] = {0};
+    const ssize_t utf16_len = utf8_to_utf16(folded, (const u8 *)query, SEARCH_QUERY_MAX);
+    const int len = utf16_len < 0 ? 0 : utf16_len;
+    if(len == 0 || list->entries == NULL)
+    {
+        platform_mutex_lock(&list->info_lock);
+        list_clear_view(list);
+        platform_mutex_unlock(&list->info_lock);
+        return list->entries_count;
+    }
+
+    for(int i = 0; i < len; i++)
+        folded[i] = fold_case(folded[i]);
+
+    // the info thread fills entries in, the index is made again on the first search after that
+    bool use_index = len >= 3;
+    if(use_index && (index->starts == NULL || index->generation != list->info_generation))
+        use_index = search_index_build(index, list);
+
+    const u32 count = list->entries_count;
+    int * view = malloc(count * sizeof(int));
+    u32 * positions = malloc(count * sizeof(u32));
+    if(view == NULL || positions == NULL)
+    {
+        free(view);
+        free(positions);
+        return 0;
+    }
+
+    // the entries are gone through by id, so every page is read once
+    int matches = 0;
+    platform_mutex_lock(&list->info_lock);
+    for(u32 i = 0; i < count; i++)
+        positions[list_id_at(list, i)] = i;
+
+    Entry_Walk_s walk;
+    list_walk_start(&walk, list);
+    if(use_index)
+    {
+        // the rarest trigram of the query gives the fewest entries to check
+        u32 buckets[SEARCH_QUERY_MAX];
+        int rarest = 0;
+        for(int i = 0; i < len - 2; i++)
+        {
+            buckets[i] = hash_trigram(folded[i], folded[i + 1], folded[i + 2]);
+            if(index->starts[buckets[i] + 1] - index->starts[buckets[i]] < index->starts[buckets[rarest] + 1] - index->starts[buckets[rarest]])
+                rarest = i;
+        }
+
+        for(u32 j = index->starts[buckets[rarest]]; j < index->starts[buckets[rarest] + 1]; j++)
+        {
+            const u32 id = index->ids[j];
+            bool candidate = true;
+            for(int i = 0; i < len - 2 && candidate; i++)
+                candidate = i == rarest || bucket_has_id(index, buckets[i], id);
+
+            if(candidate && entry_matches(list_walk_entry(&walk, id), folded, len))
+                view[matches++] = positions[id];
+        }
+    }
+    else
+    {
+        for(u32 id = 0; id < count; id++)
+        {
+            if(entry_matches(list_walk_entry(&walk, id), folded, len))
+                view[matches++] = positions[id];
+        }
+    }
+    list_walk_end(&walk);
+    platform_mutex_unlock(&list->info_lock);
+    free(positions);
+
+    if(matches == 0)
+    {
+        free(view);
+        return 0;
+    }
+
+    // shown in the order of the list
+    qsort(view, matches, sizeof(int), compare_view_indexes);
+    platform_mutex_lock(&list->info_lock);
+    list_clear_view(list);
+    list->view = view;
+    list->view_count = matches;
+    platform_mutex_unlock(&list->info_lock);
+    return matches;
+}
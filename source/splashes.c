@@ -37,22 +37,26 @@ void splash_delete(void)
 
 void splash_install(const Entry_s * splash)
 {
-    char *screen_buf = NULL;
+    const char * splash_files[2] = { "/splash.bin", "/splashbottom.bin" };
+    char * screen_bufs[2] = {NULL};
+    u32 screen_sizes[2] = {0};
+    load_data_multi(splash_files, splash, screen_bufs, screen_sizes, 2);
 
-    u32 size = load_data("/splash.bin", splash, &screen_buf);
+    u32 size = screen_sizes[0];
     if(size != 0)
     {
-        remake_file(fsMakePath(PATH_ASCII, "/luma/splash.bin"), ArchiveSD, size);
-        buf_to_file(size, fsMakePath(PATH_ASCII, "/luma/splash.bin"), ArchiveSD, screen_buf);
+        write_file(u"/luma/splash.bin", PLATFORM_ARCHIVE_SD, screen_bufs[0], size, size);
     }
 
-    u32 bottom_size = load_data("/splashbottom.bin", splash, &screen_buf);
+    u32 bottom_size = screen_sizes[1];
     if(bottom_size != 0)
     {
-        remake_file(fsMakePath(PATH_ASCII, "/luma/splashbottom.bin"), ArchiveSD, bottom_size);
-        buf_to_file(bottom_size, fsMakePath(PATH_ASCII, "/luma/splashbottom.bin"), ArchiveSD, screen_buf);
+        write_file(u"/luma/splashbottom.bin", PLATFORM_ARCHIVE_SD, screen_bufs[1], bottom_size, bottom_size);
     }
 
+    free(screen_bufs[0]);
+    free(screen_bufs[1]);
+
     if(size == 0 && bottom_size == 0)
     {
         throw_error(language.splashes.no_splash_found, ERROR_LEVEL_WARNING);
@@ -60,7 +64,7 @@ void splash_install(const Entry_s * splash)
     else
     {
         char *config_buf;
-        size = file_to_buf(fsMakePath(PATH_ASCII, "/luma/config.bin"), ArchiveSD, &config_buf);
+        size = file_to_buf(u"/luma/config.bin", PLATFORM_ARCHIVE_SD, &config_buf);
         if(size)
         {
             if(config_buf[0xC] == 0)
@@ -80,9 +84,9 @@ void splash_check_installed(void * void_arg)
 
     #ifndef CITRA_MODE
     char * top_buf = NULL;
-    u32 top_size = file_to_buf(fsMakePath(PATH_ASCII, "/luma/splash.bin"), ArchiveSD, &top_buf);
+    u32 top_size = file_to_buf(u"/luma/splash.bin", PLATFORM_ARCHIVE_SD, &top_buf);
     char * bottom_buf = NULL;
-    u32 bottom_size = file_to_buf(fsMakePath(PATH_ASCII, "/luma/splashbottom.bin"), ArchiveSD, &bottom_buf);
+    u32 bottom_size = file_to_buf(u"/luma/splashbottom.bin", PLATFORM_ARCHIVE_SD, &bottom_buf);
 
     if(!top_size && !bottom_size)
     {
@@ -91,41 +95,50 @@ void splash_check_installed(void * void_arg)
         return;
     }
 
-    #define HASH_SIZE_BYTES 256/8
-    u8 top_hash[HASH_SIZE_BYTES] = {0};
-    FSUSER_UpdateSha256Context(top_buf, top_size, top_hash);
+    u8 top_hash[SHA256_HASH_SIZE] = {0};
+    platform_sha256(top_buf, top_size, top_hash);
     free(top_buf);
     top_buf = NULL;
-    u8 bottom_hash[HASH_SIZE_BYTES] = {0};
-    FSUSER_UpdateSha256Context(bottom_buf, bottom_size, bottom_hash);
+    u8 bottom_hash[SHA256_HASH_SIZE] = {0};
+    platform_sha256(bottom_buf, bottom_size, bottom_hash);
     free(bottom_buf);
     bottom_buf = NULL;
 
-    for(int i = 0; i < list->entries_count && arg->run_thread; i++)
+    // the list can be sorted while the splashes are read
+    int count = 0;
+    Entry_Ref_s * splashes = list_snapshot(list, &count);
+    for(int i = 0; i < count && arg->run_thread; i++)
     {
-        Entry_s * splash = &list->entries[i];
-        top_size = load_data("/splash.bin", splash, &top_buf);
-        bottom_size = load_data("/splashbottom.bin", splash, &bottom_buf);
+        const Entry_s splash = entry_from_ref(&splashes[i]);
+        const char * splash_files[2] = { "/splash.bin", "/splashbottom.bin" };
+        char * splash_bufs[2] = {NULL};
+        u32 splash_sizes[2] = {0};
+        load_data_multi(splash_files, &splash, splash_bufs, splash_sizes, 2);
+        top_buf = splash_bufs[0];
+        top_size = splash_sizes[0];
+        bottom_buf = splash_bufs[1];
+        bottom_size = splash_sizes[1];
 
         if(!top_size && !bottom_size)
         {
             continue;
         }
 
-        u8 splash_top_hash[HASH_SIZE_BYTES] = {0};
-        FSUSER_UpdateSha256Context(top_buf, top_size, splash_top_hash);
+        u8 splash_top_hash[SHA256_HASH_SIZE] = {0};
+        platform_sha256(top_buf, top_size, splash_top_hash);
         free(top_buf);
         top_buf = NULL;
-        u8 splash_bottom_hash[HASH_SIZE_BYTES] = {0};
-        FSUSER_UpdateSha256Context(bottom_buf, bottom_size, splash_bottom_hash);
+        u8 splash_bottom_hash[SHA256_HASH_SIZE] = {0};
+        platform_sha256(bottom_buf, bottom_size, splash_bottom_hash);
         free(bottom_buf);
         bottom_buf = NULL;
 
-        if(!memcmp(splash_bottom_hash, bottom_hash, HASH_SIZE_BYTES) && !memcmp(splash_top_hash, top_hash, HASH_SIZE_BYTES))
+        if(!memcmp(splash_bottom_hash, bottom_hash, SHA256_HASH_SIZE) && !memcmp(splash_top_hash, top_hash, SHA256_HASH_SIZE))
         {
-            splash->installed = true;
+            list_set_installed(list, &splashes[i]);
             break;
         }
     }
+    free(splashes);
     #endif
 }
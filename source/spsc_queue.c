@@ -0,0 +1,74 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include "spsc_queue.h"
+
+bool spsc_queue_init(Spsc_Queue_s * queue, u32 capacity, u32 item_size)
+{
+    u32 size = 1;
+    while(size < capacity)
+        size <<= 1;
+
+    memset(queue, 0, sizeof(Spsc_Queue_s));
+    queue->items = malloc(size * item_size);
+    if(queue->items == NULL)
+        return false;
+
+    queue->item_size = item_size;
+    queue->mask = size - 1;
+    return true;
+}
+
+void spsc_queue_free(Spsc_Queue_s * queue)
+{
+    free(queue->items);
+    memset(queue, 0, sizeof(Spsc_Queue_s));
+}
+
+// the item is written before the tail that makes it visible, and read before the head that gives its room back
+bool spsc_queue_push(Spsc_Queue_s * queue, const void * item)
+{
+    const u32 tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+    const u32 head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    if(queue->items == NULL || tail - head > queue->mask)
+        return false;
+
+    memcpy(queue->items + (tail & queue->mask) * queue->item_size, item, queue->item_size);
+    __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool spsc_queue_pop(Spsc_Queue_s * queue, void * item)
+{
+    const u32 head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+    const u32 tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+    if(head == tail)
+        return false;
+
+    memcpy(item, queue->items + (head & queue->mask) * queue->item_size, queue->item_size);
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
@@ -0,0 +1,94 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include "string_arena.h"
+#include "unicode.h"
+
+static const u16 empty_string[1] = {0};
+
+static u16 * arena_reserve(String_Arena_s * arena, size_t size)
+{
+    if(arena->chunks == NULL || arena->chunks->size - arena->used < size)
+    {
+        // bigger strings than a chunk get one of their own
+        const u32 chunk_size = size > STRING_ARENA_CHUNK_SIZE ? size : STRING_ARENA_CHUNK_SIZE;
+        String_Arena_Chunk_s * chunk = malloc(sizeof(String_Arena_Chunk_s) + chunk_size * sizeof(u16));
+        if(chunk == NULL)
+        {
+            DEBUG("string arena: out of memory\n");
+            return NULL;
+        }
+
+        chunk->next = arena->chunks;
+        chunk->size = chunk_size;
+        arena->chunks = chunk;
+        arena->used = 0;
+    }
+
+    u16 * out = arena->chunks->data + arena->used;
+    arena->used += size;
+    return out;
+}
+
+const u16 * arena_add(String_Arena_s * arena, const u16 * str, size_t len)
+{
+    u16 * out = arena_reserve(arena, len + 1);
+    if(out == NULL)
+        return empty_string;
+
+    memcpy(out, str, len * sizeof(u16));
+    out[len] = 0;
+    return out;
+}
+
+const u16 * arena_add_utf8(String_Arena_s * arena, const char * str)
+{
+    // a UTF-8 string never has less bytes than its UTF-16 version has characters
+    const size_t max_len = strlen(str);
+    u16 * out = arena_reserve(arena, max_len + 1);
+    if(out == NULL)
+        return empty_string;
+
+    const ssize_t len = utf8_to_utf16(out, (const u8 *)str, max_len);
+    out[len < 0 ? 0 : len] = 0;
+    // give back what wasn't used, if nothing else was taken from the chunk in between
+    if(len >= 0)
+        arena->used -= max_len - len;
+    return out;
+}
+
+void arena_free(String_Arena_s * arena)
+{
+    String_Arena_Chunk_s * chunk = arena->chunks;
+    while(chunk != NULL)
+    {
+        String_Arena_Chunk_s * next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    arena->chunks = NULL;
+    arena->used = 0;
+}
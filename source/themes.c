@@ -33,10 +33,69 @@
 #define BODY_CACHE_SIZE 0x150000
 #define BGM_MAX_SIZE 0x337000
 
-static Result install_theme_internal(const Entry_List_s * themes, int installmode)
+#define BGM_COPY_CHUNK_SIZE 0x10000
+
+// copies the BGM of a theme to a BgmCache file a chunk at a time, instead of loading it whole.
+// *music_size is left at 0 and nothing is written if the theme has no BGM
+static Result install_bgm(const Entry_s * theme, const u16 * cache_path, u32 * music_size, bool * mono_audio)
+{
+    *music_size = 0;
+
+    Data_Stream_s stream;
+    if(!open_data_stream("/bgm.bcstm", theme, &stream))
+        return 0;
+
+    const u32 size = stream.size;
+    if(size > BGM_MAX_SIZE)
+    {
+        stream_close(&stream);
+        DEBUG("bgm too big\n");
+        return MAKERESULT(RL_PERMANENT, RS_CANCELED, RM_APPLICATION, RD_TOO_LARGE);
+    }
+
+    create_file(cache_path, PLATFORM_ARCHIVE_THEME_EXT, BGM_MAX_SIZE);
+
+    Platform_File handle;
+    Result res = platform_file_open(&handle, PLATFORM_ARCHIVE_THEME_EXT, cache_path, PLATFORM_OPEN_WRITE);
+    if(R_SUCCEEDED(res))
+    {
+        char * chunk = malloc(BGM_COPY_CHUNK_SIZE);
+        u32 read = 0;
+        while(chunk != NULL && R_SUCCEEDED(res) && (read = stream_read(&stream, chunk, BGM_COPY_CHUNK_SIZE)) != 0)
+        {
+            if(*music_size == 0 && read > 0x62 && chunk[0x62] == 1)
+            {
+                *mono_audio = true;
+            }
+
+            res = write_handle(handle, *music_size, chunk, read);
+            *music_size += read;
+        }
+
+        // the part of the file after the BGM is zeroed
+        if(R_SUCCEEDED(res))
+            res = zero_fill_handle(handle, *music_size, BGM_MAX_SIZE);
+
+        platform_file_flush(handle);
+        platform_file_close(handle);
+        free(chunk);
+    }
+
+    stream_close(&stream);
+
+    if(R_SUCCEEDED(res) && *music_size != size)
+    {
+        DEBUG("bgm couldn't be read whole\n");
+        res = MAKERESULT(RL_PERMANENT, RS_CANCELED, RM_APPLICATION, RD_NO_DATA);
+    }
+
+    return res;
+}
+
+// themes are copies of the entries, the ones of the shuffle or only the one to install
+static Result install_theme_internal(const Entry_s * themes, int themes_count, int installmode)
 {
     Result res = 0;
-    char * music = NULL;
     u32 music_size = 0;
     u32 shuffle_music_sizes[MAX_SHUFFLE_THEMES] = {0};
     char * body = NULL;
@@ -46,135 +105,100 @@ static Result install_theme_internal(const Entry_List_s * themes, int installmod
 
     if(installmode & THEME_INSTALL_SHUFFLE)
     {
-        if(themes->shuffle_count < 2)
+        if(themes_count < 2)
         {
             DEBUG("not enough themes selected for shuffle\n");
             return MAKERESULT(RL_USAGE, RS_INVALIDARG, RM_COMMON, RD_INVALID_SELECTION);
         }
 
-        if(themes->shuffle_count > MAX_SHUFFLE_THEMES)
+        if(themes_count > MAX_SHUFFLE_THEMES)
         {
             DEBUG("too many themes selected for shuffle\n");
             return MAKERESULT(RL_USAGE, RS_INVALIDARG, RM_COMMON, RD_INVALID_SELECTION);
         }
 
-        char * padded = NULL;
-
         int shuffle_count = 0;
-        draw_loading_bar(shuffle_count, themes->shuffle_count + 1, INSTALL_SHUFFLE);
-        Handle body_cache_handle;
+        draw_loading_bar(shuffle_count, themes_count + 1, INSTALL_SHUFFLE);
+        Platform_File body_cache_handle = 0;
 
         if(installmode & THEME_INSTALL_BODY)
         {
-            remake_file(fsMakePath(PATH_ASCII, "/BodyCache_rd.bin"), ArchiveThemeExt, BODY_CACHE_SIZE * MAX_SHUFFLE_THEMES);
-            FSUSER_OpenFile(&body_cache_handle, ArchiveThemeExt, fsMakePath(PATH_ASCII, "/BodyCache_rd.bin"), FS_OPEN_WRITE, 0);
+            create_file(u"/BodyCache_rd.bin", PLATFORM_ARCHIVE_THEME_EXT, BODY_CACHE_SIZE * MAX_SHUFFLE_THEMES);
+            platform_file_open(&body_cache_handle, PLATFORM_ARCHIVE_THEME_EXT, u"/BodyCache_rd.bin", PLATFORM_OPEN_WRITE);
         }
 
-        for(int i = 0; i < themes->entries_count; i++)
+        for(int i = 0; i < themes_count; i++)
         {
-            const Entry_s * current_theme = &themes->entries[i];
+            const Entry_s * current_theme = &themes[i];
 
-            if(current_theme->in_shuffle)
+            if(installmode & THEME_INSTALL_BODY)
             {
-                if(installmode & THEME_INSTALL_BODY)
+                body_size = load_data("/body_LZ.bin", current_theme, &body);
+                if(body_size == 0)
                 {
-                    body_size = load_data("/body_LZ.bin", current_theme, &body);
-                    if(body_size == 0)
-                    {
-                        free(body);
-                        DEBUG("body not found\n");
-                        throw_error(language.themes.no_body_found, ERROR_LEVEL_WARNING);
-                        return MAKERESULT(RL_PERMANENT, RS_CANCELED, RM_APPLICATION, RD_NOT_FOUND);
-                    }
-
-                    shuffle_body_sizes[shuffle_count] = body_size;
-
-                    padded = calloc(BODY_CACHE_SIZE, sizeof(char));
-                    memcpy(padded, body, body_size);
                     free(body);
-
-                    FSFILE_Write(body_cache_handle, NULL, BODY_CACHE_SIZE * shuffle_count, padded, BODY_CACHE_SIZE, FS_WRITE_FLUSH);
-
-                    free(padded);
-                    padded = NULL;
+                    DEBUG("body not found\n");
+                    throw_error(language.themes.no_body_found, ERROR_LEVEL_WARNING);
+                    return MAKERESULT(RL_PERMANENT, RS_CANCELED, RM_APPLICATION, RD_NOT_FOUND);
                 }
 
-                if(installmode & THEME_INSTALL_BGM)
-                {
-                    char bgm_cache_path[26] = {0};
-                    sprintf(bgm_cache_path, "/BgmCache_%.2i.bin", shuffle_count);
-
-                    if(current_theme->no_bgm_shuffle)
-                    {
-                        music = NULL;
-                        music_size = 0;
-                    }
-                    else
-                    {
-                        music_size = load_data("/bgm.bcstm", current_theme, &music);
-
-                        if(music_size > BGM_MAX_SIZE)
-                        {
-                            free(music);
-                            DEBUG("bgm too big\n");
-                            return MAKERESULT(RL_PERMANENT, RS_CANCELED, RM_APPLICATION, RD_TOO_LARGE);
-                        }
-
-                        if (music_size > 0)
-                        {
-                            if (music[0x62] == 1)
-                            {
-                                mono_audio = true;
-                            }
-                        }
-                    }
+                shuffle_body_sizes[shuffle_count] = body_size;
 
-                    shuffle_music_sizes[shuffle_count] = music_size;
-                    remake_file(fsMakePath(PATH_ASCII, bgm_cache_path), ArchiveThemeExt, BGM_MAX_SIZE);
-
-                    Handle bgm_cache_handle;
-                    FSUSER_OpenFile(&bgm_cache_handle, ArchiveThemeExt, fsMakePath(PATH_ASCII, bgm_cache_path), FS_OPEN_WRITE, 0);
-
-                    padded = calloc(BGM_MAX_SIZE, sizeof(char));
-                    if(!current_theme->no_bgm_shuffle && music_size)
-                    {
-                        memcpy(padded, music, music_size);
-                        free(music);
-                    }
+                // each body gets a slot, zero padded
+                const u32 slot = BODY_CACHE_SIZE * shuffle_count;
+                write_handle(body_cache_handle, slot, body, min(body_size, BODY_CACHE_SIZE));
+                free(body);
+                zero_fill_handle(body_cache_handle, slot + body_size, slot + BODY_CACHE_SIZE);
+            }
 
-                    FSFILE_Write(bgm_cache_handle, NULL, 0, padded, BGM_MAX_SIZE, FS_WRITE_FLUSH);
+            if(installmode & THEME_INSTALL_BGM)
+            {
+                char bgm_cache_name[26] = {0};
+                sprintf(bgm_cache_name, "/BgmCache_%.2i.bin", shuffle_count);
+                u16 bgm_cache_path[26] = {0};
+                struacat(bgm_cache_path, bgm_cache_name);
 
-                    FSFILE_Close(bgm_cache_handle);
-                    free(padded);
-                    padded = NULL;
+                music_size = 0;
+                if(!current_theme->no_bgm_shuffle)
+                {
+                    res = install_bgm(current_theme, bgm_cache_path, &music_size, &mono_audio);
+                    if(R_FAILED(res)) return res;
                 }
 
-                shuffle_count++;
-                draw_loading_bar(shuffle_count, themes->shuffle_count + 1, INSTALL_SHUFFLE);
+                // no BGM: the cache is left blank
+                if(music_size == 0)
+                    write_file(bgm_cache_path, PLATFORM_ARCHIVE_THEME_EXT, NULL, 0, BGM_MAX_SIZE);
+
+                shuffle_music_sizes[shuffle_count] = music_size;
             }
+
+            shuffle_count++;
+            draw_loading_bar(shuffle_count, themes_count + 1, INSTALL_SHUFFLE);
         }
 
         if(installmode & THEME_INSTALL_BGM)
         {
-            char * blank = calloc(BGM_MAX_SIZE, sizeof(char));
             for(int i = shuffle_count; i < MAX_SHUFFLE_THEMES; i++)
             {
-                char bgm_cache_path[26] = {0};
-                sprintf(bgm_cache_path, "/BgmCache_%.2i.bin", i);
-                remake_file(fsMakePath(PATH_ASCII, bgm_cache_path), ArchiveThemeExt, BGM_MAX_SIZE);
-                buf_to_file(BGM_MAX_SIZE, fsMakePath(PATH_ASCII, bgm_cache_path), ArchiveThemeExt, blank);
+                char bgm_cache_name[26] = {0};
+                sprintf(bgm_cache_name, "/BgmCache_%.2i.bin", i);
+                u16 bgm_cache_path[26] = {0};
+                struacat(bgm_cache_path, bgm_cache_name);
+                write_file(bgm_cache_path, PLATFORM_ARCHIVE_THEME_EXT, NULL, 0, BGM_MAX_SIZE);
             }
-            free(blank);
         }
 
         if(installmode & THEME_INSTALL_BODY)
         {
-            FSFILE_Close(body_cache_handle);
+            // the slots no theme uses
+            zero_fill_handle(body_cache_handle, BODY_CACHE_SIZE * shuffle_count, BODY_CACHE_SIZE * MAX_SHUFFLE_THEMES);
+            platform_file_flush(body_cache_handle);
+            platform_file_close(body_cache_handle);
         }
     }
     else
     {
-        const Entry_s * current_theme = &themes->entries[themes->selected_entry];
+        const Entry_s * current_theme = &themes[0];
 
         if(installmode & THEME_INSTALL_BODY)
         {
@@ -187,7 +211,7 @@ static Result install_theme_internal(const Entry_List_s * themes, int installmod
                 return MAKERESULT(RL_PERMANENT, RS_CANCELED, RM_APPLICATION, RD_NOT_FOUND);
             }
 
-            res = buf_to_file(body_size, fsMakePath(PATH_ASCII, "/BodyCache.bin"), ArchiveThemeExt, body); // Write body data to file
+            res = buf_to_file(body_size, u"/BodyCache.bin", PLATFORM_ARCHIVE_THEME_EXT, body); // Write body data to file
             free(body);
 
             if(R_FAILED(res)) return res;
@@ -195,49 +219,57 @@ static Result install_theme_internal(const Entry_List_s * themes, int installmod
 
         if(installmode & THEME_INSTALL_BGM)
         {
-            music_size = load_data("/bgm.bcstm", current_theme, &music);
-            if (music_size > BGM_MAX_SIZE)
-            {
-                free(music);
-                DEBUG("bgm too big\n");
-                return MAKERESULT(RL_PERMANENT, RS_CANCELED, RM_APPLICATION, RD_TOO_LARGE);
-            }
+            res = install_bgm(current_theme, u"/BgmCache.bin", &music_size, &mono_audio);
+            if(R_FAILED(res)) return res;
 
             if (music_size != 0)
             {
-                if (music[0x62] == 1)
+                // the body has to say it uses the BGM: patch the flag in the compressed data
+                // without going through the whole body, or recompress it if that fails
+                u32 compressed_body_size = body_size;
+                if(!(installmode & THEME_INSTALL_BODY))
                 {
-                    mono_audio = true;
+                    char * thememanage_buf = NULL;
+                    if(file_to_buf(u"/ThemeManage.bin", PLATFORM_ARCHIVE_THEME_EXT, &thememanage_buf) >= sizeof(ThemeManage_bin_s))
+                        compressed_body_size = ((ThemeManage_bin_s *)thememanage_buf)->body_size;
+                    free(thememanage_buf);
                 }
 
-                remake_file(fsMakePath(PATH_ASCII, "/BgmCache.bin"), ArchiveThemeExt, BGM_MAX_SIZE);
-                res = buf_to_file(music_size, fsMakePath(PATH_ASCII, "/BgmCache.bin"), ArchiveThemeExt, music);
-                free(music);
-
-                char * body_buf = NULL;
-                u32 uncompressed_size = decompress_lz_file(fsMakePath(PATH_ASCII, "/BodyCache.bin"), ArchiveThemeExt, &body_buf);
-                if (body_buf != NULL && body_buf[5] != 1)
+                const char uses_bgm = 1;
+                u32 patched_size = patch_lz_file(u"/BodyCache.bin", PLATFORM_ARCHIVE_THEME_EXT, compressed_body_size, 5, &uses_bgm, 1);
+                if (patched_size != 0)
                 {
-                    installmode |= THEME_INSTALL_BODY;
-                    body_buf[5] = 1;
-                    body_size = compress_lz_file_fast(fsMakePath(PATH_ASCII, "/BodyCache.bin"), ArchiveThemeExt, body_buf, uncompressed_size);
+                    if (patched_size != compressed_body_size)
+                    {
+                        installmode |= THEME_INSTALL_BODY;
+                        body_size = patched_size;
+                    }
+                }
+                else
+                {
+                    char * body_buf = NULL;
+                    u32 uncompressed_size = decompress_lz_file(u"/BodyCache.bin", PLATFORM_ARCHIVE_THEME_EXT, &body_buf);
+                    if (body_buf != NULL && body_buf[5] != 1)
+                    {
+                        installmode |= THEME_INSTALL_BODY;
+                        body_buf[5] = 1;
+                        body_size = compress_lz_file(u"/BodyCache.bin", PLATFORM_ARCHIVE_THEME_EXT, body_buf, uncompressed_size, LZ11_LEVEL_LAZY);
+                    }
+
+                    free(body_buf);
                 }
-                    
-                free(body_buf);
             }
 
             if(R_FAILED(res)) return res;
         } else
         {
-            music = calloc(BGM_MAX_SIZE, 1);
-            res = buf_to_file(BGM_MAX_SIZE, fsMakePath(PATH_ASCII, "/BgmCache.bin"), ArchiveThemeExt, music);
-            free(music);
+            res = write_file(u"/BgmCache.bin", PLATFORM_ARCHIVE_THEME_EXT, NULL, 0, BGM_MAX_SIZE);
         }
     }
 
      //----------------------------------------
     char * thememanage_buf = NULL;
-    file_to_buf(fsMakePath(PATH_ASCII, "/ThemeManage.bin"), ArchiveThemeExt, &thememanage_buf);
+    file_to_buf(u"/ThemeManage.bin", PLATFORM_ARCHIVE_THEME_EXT, &thememanage_buf);
     ThemeManage_bin_s * theme_manage = (ThemeManage_bin_s *)thememanage_buf;
 
     theme_manage->unk1 = 1;
@@ -267,14 +299,14 @@ static Result install_theme_internal(const Entry_List_s * themes, int installmod
     theme_manage->dlc_theme_content_index = 0xFF;
     theme_manage->use_theme_cache = 0x0200;
 
-    res = buf_to_file(0x800, fsMakePath(PATH_ASCII, "/ThemeManage.bin"), ArchiveThemeExt, thememanage_buf);
+    res = buf_to_file(0x800, u"/ThemeManage.bin", PLATFORM_ARCHIVE_THEME_EXT, thememanage_buf);
     free(thememanage_buf);
     if(R_FAILED(res)) return res;
     //----------------------------------------
 
     //----------------------------------------
     char * savedata_buf = NULL;
-    u32 savedata_size = file_to_buf(fsMakePath(PATH_ASCII, "/SaveData.dat"), ArchiveHomeExt, &savedata_buf);
+    u32 savedata_size = file_to_buf(u"/SaveData.dat", PLATFORM_ARCHIVE_HOME_EXT, &savedata_buf);
     SaveData_dat_s * savedata = (SaveData_dat_s *)savedata_buf;
 
     memset(&savedata->theme_entry, 0, sizeof(ThemeEntry_s));
@@ -283,7 +315,7 @@ static Result install_theme_internal(const Entry_List_s * themes, int installmod
     memset(savedata->shuffle_themes, 0, sizeof(ThemeEntry_s) * MAX_SHUFFLE_THEMES);
     if(installmode & THEME_INSTALL_SHUFFLE)
     {
-        for(int i = 0; i < themes->shuffle_count; i++)
+        for(int i = 0; i < themes_count; i++)
         {
             savedata->shuffle_themes[i].type = 3;
             savedata->shuffle_themes[i].index = i;
@@ -298,7 +330,7 @@ static Result install_theme_internal(const Entry_List_s * themes, int installmod
         savedata->theme_entry.index = 0xff;
     }
 
-    res = buf_to_file(savedata_size, fsMakePath(PATH_ASCII, "/SaveData.dat"), ArchiveHomeExt, savedata_buf);
+    res = buf_to_file(savedata_size, u"/SaveData.dat", PLATFORM_ARCHIVE_HOME_EXT, savedata_buf);
     free(savedata_buf);
     if(R_FAILED(res)) return res;
     //----------------------------------------
@@ -311,36 +343,29 @@ static Result install_theme_internal(const Entry_List_s * themes, int installmod
 
 Result theme_install(Entry_s * theme)
 {
-    Entry_List_s list = {0};
-    list.entries_count = 1;
-    list.entries = theme;
-    list.selected_entry = 0;
-    return install_theme_internal(&list, THEME_INSTALL_BODY | THEME_INSTALL_BGM);
+    return install_theme_internal(theme, 1, THEME_INSTALL_BODY | THEME_INSTALL_BGM);
 }
 
 Result bgm_install(Entry_s * theme)
 {
-    Entry_List_s list = {0};
-    list.entries_count = 1;
-    list.entries = theme;
-    list.selected_entry = 0;
-    return install_theme_internal(&list, THEME_INSTALL_BGM);
+    return install_theme_internal(theme, 1, THEME_INSTALL_BGM);
 }
 
 Result no_bgm_install(Entry_s * theme)
 {
-    Entry_List_s list = {0};
-    list.entries_count = 1;
-    list.entries = theme;
-    list.selected_entry = 0;
-    return install_theme_internal(&list, THEME_INSTALL_BODY);
+    return install_theme_internal(theme, 1, THEME_INSTALL_BODY);
 }
 
-Result shuffle_install(const Entry_List_s * themes)
+Result shuffle_install(Entry_List_s * themes)
 {
-    return install_theme_internal(themes, THEME_INSTALL_SHUFFLE | THEME_INSTALL_BODY | THEME_INSTALL_BGM);
+    // one more than fits, so too many of them is noticed
+    Entry_s shuffle[MAX_SHUFFLE_THEMES + 1];
+    const int shuffle_count = list_get_shuffle(themes, shuffle, MAX_SHUFFLE_THEMES + 1);
+    return install_theme_internal(shuffle, shuffle_count, THEME_INSTALL_SHUFFLE | THEME_INSTALL_BODY | THEME_INSTALL_BGM);
 }
 
+// the dumps ask for a folder name and read the themes of the console, so they are only built for it
+#ifdef __3DS__
 static SwkbdCallbackResult
 dir_name_callback(void * data, const char ** ppMessage, const char * text, size_t textlen)
 {
@@ -380,30 +405,28 @@ Result dump_current_theme(void)
     u16 path[0x107] = { 0 };
     struacat(path, main_paths[REMOTE_MODE_THEMES]);
     struacat(path, output_dir);
-    FSUSER_CreateDirectory(ArchiveSD, fsMakePath(PATH_UTF16, path), FS_ATTRIBUTE_DIRECTORY);
+    platform_dir_create(PLATFORM_ARCHIVE_SD, path);
 
     char * thememanage_buf = NULL;
-    file_to_buf(fsMakePath(PATH_ASCII, "/ThemeManage.bin"), ArchiveThemeExt, &thememanage_buf);
+    file_to_buf(u"/ThemeManage.bin", PLATFORM_ARCHIVE_THEME_EXT, &thememanage_buf);
     ThemeManage_bin_s * theme_manage = (ThemeManage_bin_s *)thememanage_buf;
     u32 theme_size = theme_manage->body_size;
     u32 bgm_size = theme_manage->music_size;
     free(thememanage_buf);
 
     char * temp_buf = NULL;
-    file_to_buf(fsMakePath(PATH_ASCII, "/BodyCache.bin"), ArchiveThemeExt, &temp_buf);
+    file_to_buf(u"/BodyCache.bin", PLATFORM_ARCHIVE_THEME_EXT, &temp_buf);
     u16 path_output[0x107] = { 0 };
     memcpy(path_output, path, 0x107);
     struacat(path_output, "/body_LZ.bin");
-    remake_file(fsMakePath(PATH_UTF16, path_output), ArchiveSD, theme_size);
-    buf_to_file(theme_size, fsMakePath(PATH_UTF16, path_output), ArchiveSD, temp_buf);
+    write_file(path_output, PLATFORM_ARCHIVE_SD, temp_buf, theme_size, theme_size);
     free(temp_buf);
     temp_buf = NULL;
 
-    file_to_buf(fsMakePath(PATH_ASCII, "/BgmCache.bin"), ArchiveThemeExt, &temp_buf);
+    file_to_buf(u"/BgmCache.bin", PLATFORM_ARCHIVE_THEME_EXT, &temp_buf);
     memcpy(path_output, path, 0x107);
     struacat(path_output, "/bgm.bcstm");
-    remake_file(fsMakePath(PATH_UTF16, path_output), ArchiveSD, bgm_size);
-    buf_to_file(bgm_size, fsMakePath(PATH_UTF16, path_output), ArchiveSD, temp_buf);
+    write_file(path_output, PLATFORM_ARCHIVE_SD, temp_buf, bgm_size, bgm_size);
     free(temp_buf);
     temp_buf = NULL;
 
@@ -433,8 +456,7 @@ Result dump_current_theme(void)
     
     memcpy(path_output, path, 0x107);
     struacat(path_output, "/info.smdh");
-    remake_file(fsMakePath(PATH_UTF16, path_output), ArchiveSD, 0x36c0);
-    buf_to_file(0x36c0, fsMakePath(PATH_UTF16, path_output), ArchiveSD, smdh_file);
+    write_file(path_output, PLATFORM_ARCHIVE_SD, smdh_file, 0x36c0, 0x36c0);
 
     free(smdh_file);
 
@@ -616,7 +638,9 @@ Result dump_all_themes(void)
                     char path[0x107] = { 0 };
                     sprintf(path, "%sDump-%02lx-%ld-%s", main_paths[REMOTE_MODE_THEMES], dlc_index, extra_index, themename);
                     DEBUG("theme folder to create: %s\n", path);
-                    FSUSER_CreateDirectory(ArchiveSD, fsMakePath(PATH_ASCII, path), FS_ATTRIBUTE_DIRECTORY);
+                    u16 utf16_path[0x107] = {0};
+                    struacat(utf16_path, path);
+                    platform_dir_create(PLATFORM_ARCHIVE_SD, utf16_path);
 
                     memset(smdh_data->name, 0, sizeof(smdh_data->name));
                     utf8_to_utf16(smdh_data->name, (u8 *)(content_data + 0), 0x40);
@@ -633,8 +657,9 @@ Result dump_all_themes(void)
 
                         char themepath[0x107] = {0};
                         sprintf(themepath, "%s/body_LZ.bin", path);
-                        remake_file(fsMakePath(PATH_ASCII, themepath), ArchiveSD, theme_size);
-                        buf_to_file(theme_size, fsMakePath(PATH_ASCII, themepath), ArchiveSD, theme_data);
+                        u16 utf16_themepath[0x107] = {0};
+                        struacat(utf16_themepath, themepath);
+                        write_file(utf16_themepath, PLATFORM_ARCHIVE_SD, theme_data, theme_size, theme_size);
                         free(theme_data);
                     }
 
@@ -650,8 +675,9 @@ Result dump_all_themes(void)
 
                         char bgmpath[0x107] = {0};
                         sprintf(bgmpath, "%s/bgm.bcstm", path);
-                        remake_file(fsMakePath(PATH_ASCII, bgmpath), ArchiveSD, bgm_size);
-                        buf_to_file(bgm_size, fsMakePath(PATH_ASCII, bgmpath), ArchiveSD, bgm_data);
+                        u16 utf16_bgmpath[0x107] = {0};
+                        struacat(utf16_bgmpath, bgmpath);
+                        write_file(utf16_bgmpath, PLATFORM_ARCHIVE_SD, bgm_data, bgm_size, bgm_size);
                         free(bgm_data);
                     }
 
@@ -662,9 +688,8 @@ Result dump_all_themes(void)
                     fread(smdh_data->big_icon, 1, sizeof(smdh_data->big_icon), iconfile);
                     fclose(iconfile);
 
-                    strcat(path, "/info.smdh");
-                    remake_file(fsMakePath(PATH_ASCII, path), ArchiveSD, 0x36c0);
-                    buf_to_file(0x36c0, fsMakePath(PATH_ASCII, path), ArchiveSD, (char *)smdh_data);
+                    struacat(utf16_path, "/info.smdh");
+                    write_file(utf16_path, PLATFORM_ARCHIVE_SD, (char *)smdh_data, 0x36c0, 0x36c0);
                 }
             }
 
@@ -683,6 +708,7 @@ Result dump_all_themes(void)
     amExit();
     return res;
 }
+#endif
 
 void themes_check_installed(void * void_arg)
 {
@@ -692,18 +718,17 @@ void themes_check_installed(void * void_arg)
 
     #ifndef CITRA_MODE
     char * savedata_buf = NULL;
-    u32 savedata_size = file_to_buf(fsMakePath(PATH_ASCII, "/SaveData.dat"), ArchiveHomeExt, &savedata_buf);
+    u32 savedata_size = file_to_buf(u"/SaveData.dat", PLATFORM_ARCHIVE_HOME_EXT, &savedata_buf);
     if(!savedata_size) return;
     SaveData_dat_s * savedata = (SaveData_dat_s *)savedata_buf;
     bool shuffle = savedata->shuffle;
     free(savedata_buf);
 
-    #define HASH_SIZE_BYTES 256/8
-    u8 body_hash[MAX_SHUFFLE_THEMES][HASH_SIZE_BYTES];
-    memset(body_hash, 0, MAX_SHUFFLE_THEMES * HASH_SIZE_BYTES);
+    u8 body_hash[MAX_SHUFFLE_THEMES][SHA256_HASH_SIZE];
+    memset(body_hash, 0, MAX_SHUFFLE_THEMES * SHA256_HASH_SIZE);
 
     char * thememanage_buf = NULL;
-    u32 theme_manage_size = file_to_buf(fsMakePath(PATH_ASCII, "/ThemeManage.bin"), ArchiveThemeExt, &thememanage_buf);
+    u32 theme_manage_size = file_to_buf(u"/ThemeManage.bin", PLATFORM_ARCHIVE_THEME_EXT, &thememanage_buf);
     if(!theme_manage_size) return;
     ThemeManage_bin_s * theme_manage = (ThemeManage_bin_s *)thememanage_buf;
 
@@ -715,12 +740,12 @@ void themes_check_installed(void * void_arg)
     if(shuffle)
     {
         char * body_buf = NULL;
-        u32 body_cache_size = file_to_buf(fsMakePath(PATH_ASCII, "/BodyCache_rd.bin"), ArchiveThemeExt, &body_buf);
+        u32 body_cache_size = file_to_buf(u"/BodyCache_rd.bin", PLATFORM_ARCHIVE_THEME_EXT, &body_buf);
         if(!body_cache_size) return;
 
         for(int i = 0; i < MAX_SHUFFLE_THEMES; i++)
         {
-            FSUSER_UpdateSha256Context(body_buf + BODY_CACHE_SIZE * i, shuffle_body_sizes[i], body_hash[i]);
+            platform_sha256(body_buf + BODY_CACHE_SIZE * i, shuffle_body_sizes[i], body_hash[i]);
         }
 
         free(body_buf);
@@ -728,35 +753,39 @@ void themes_check_installed(void * void_arg)
     else
     {
         char * body_buf = NULL;
-        u32 body_size = file_to_buf(fsMakePath(PATH_ASCII, "/BodyCache.bin"), ArchiveThemeExt, &body_buf);
+        u32 body_size = file_to_buf(u"/BodyCache.bin", PLATFORM_ARCHIVE_THEME_EXT, &body_buf);
         if(!body_size) return;
 
         u8 * hash = body_hash[0];
-        FSUSER_UpdateSha256Context(body_buf, single_body_size, hash);
+        platform_sha256(body_buf, single_body_size, hash);
         free(body_buf);
     }
 
+    // the list can be sorted while the bodies are read
+    int count = 0;
+    Entry_Ref_s * themes = list_snapshot(list, &count);
     int total_installed = 0;
-    for(int i = 0; i < list->entries_count && total_installed < MAX_SHUFFLE_THEMES && arg->run_thread; i++)
+    for(int i = 0; i < count && total_installed < MAX_SHUFFLE_THEMES && arg->run_thread; i++)
     {
-        Entry_s * theme = &list->entries[i];
+        const Entry_s theme = entry_from_ref(&themes[i]);
         char * theme_body = NULL;
-        u32 theme_body_size = load_data("/body_LZ.bin", theme, &theme_body);
-        if(!theme_body_size) return;
+        u32 theme_body_size = load_data("/body_LZ.bin", &theme, &theme_body);
+        if(!theme_body_size) break;
 
-        u8 theme_body_hash[HASH_SIZE_BYTES];
-        FSUSER_UpdateSha256Context(theme_body, theme_body_size, theme_body_hash);
+        u8 theme_body_hash[SHA256_HASH_SIZE];
+        platform_sha256(theme_body, theme_body_size, theme_body_hash);
         free(theme_body);
 
         for(int j = 0; j < MAX_SHUFFLE_THEMES; j++)
         {
-            if(!memcmp(body_hash[j], theme_body_hash, HASH_SIZE_BYTES))
+            if(!memcmp(body_hash[j], theme_body_hash, SHA256_HASH_SIZE))
             {
-                theme->installed = true;
+                list_set_installed(list, &themes[i]);
                 total_installed++;
                 if(!shuffle) break; //only need to check the first if the installed theme inst shuffle
             }
         }
     }
+    free(themes);
     #endif
 }
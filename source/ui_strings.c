@@ -108,7 +108,7 @@ const Language_s language_english = {
                 },
                 {
                     "\uE07B Sort by filename",
-                    NULL
+                    "\uE07C Search"
                 },
                 {
                     NULL,
@@ -150,7 +150,7 @@ const Language_s language_english = {
                 },
                 {
                     "\uE07B Dump Badges",
-                    NULL
+                    "\uE07C Find duplicates"
                 },
                 {
                     NULL,
@@ -248,6 +248,13 @@ const Language_s language_english = {
         .not_enough_themes = "You don't have enough themes selected.",
         .uninstall_confirm = "Are you sure you would like to delete\nthe installed splash?",
         .delete_confirm = "Are you sure you would like to delete this?",
+        .search_q = "What are you looking for?\nLeave empty to show everything.",
+        .search = "Search",
+        .no_matches = "Nothing matches this search.",
+        .duplicates_busy = "Still looking for duplicates,\ntry again in a bit.",
+        .no_duplicates = "No duplicates found.",
+        .delete_duplicates_confirm = "These are copies of each other.\nDelete all but one of each?",
+        .hide_duplicates_confirm = "Hide all but one of each instead?",
     },
     .remote =
     {
@@ -514,7 +521,7 @@ const Language_s language_spanish = {
                 },
                 {
                     "\uE07B Ordenar por nombre de archivo",
-                    NULL
+                    "\uE07C Buscar"
                 },
                 {
                     NULL,
@@ -556,7 +563,7 @@ const Language_s language_spanish = {
                 },
                 {
                     "\uE07B Volcar Insignias",
-                    NULL
+                    "\uE07C Buscar duplicados"
                 },
                 {
                     NULL,
@@ -654,6 +661,13 @@ const Language_s language_spanish = {
         .not_enough_themes = "No tienes suficientes temas seleccionados.",
         .uninstall_confirm = "¿Estás seguro de que deseas eliminar\nel fondo instalado?",
         .delete_confirm = "¿Estás seguro de que deseas eliminar esto?",
+        .search_q = "¿Qué estás buscando?\nDéjalo vacío para mostrar todo.",
+        .search = "Buscar",
+        .no_matches = "Nada coincide con esta búsqueda.",
+        .duplicates_busy = "Todavía buscando duplicados,\ninténtalo de nuevo en un momento.",
+        .no_duplicates = "No se encontraron duplicados.",
+        .delete_duplicates_confirm = "Estos son copias entre sí.\n¿Borrar todos menos uno de cada uno?",
+        .hide_duplicates_confirm = "¿Ocultar todos menos uno de cada uno?",
     },
     .remote =
     {
@@ -921,7 +935,7 @@ const Language_s language_french = {
                 },
                 {
                     "\uE07B par nom de fichier",
-                    NULL
+                    "\uE07C Rechercher"
                 },
                 {
                     NULL,
@@ -963,7 +977,7 @@ const Language_s language_french = {
                 },
                 {
                     "\uE07B tous les badges",
-                    NULL
+                    "\uE07C doublons"
                 },
                 {
                     NULL,
@@ -1061,6 +1075,13 @@ const Language_s language_french = {
         .not_enough_themes = "Il n'y a pas assez de thèmes sélectionnés.",
         .uninstall_confirm = "Voulez-vous supprimer le splash\nactuellement installé?",
         .delete_confirm = "Voulez-vous supprimer ceci?",
+        .search_q = "Que recherchez-vous?\nLaissez vide pour tout afficher.",
+        .search = "Rechercher",
+        .no_matches = "Aucun résultat pour cette recherche.",
+        .duplicates_busy = "Recherche des doublons en cours,\nréessayez dans un instant.",
+        .no_duplicates = "Aucun doublon trouvé.",
+        .delete_duplicates_confirm = "Ce sont des copies les uns des autres.\nSupprimer tous sauf un de chaque?",
+        .hide_duplicates_confirm = "Masquer tous sauf un de chaque à la place?",
     },
     .remote =
     {
@@ -1327,7 +1348,7 @@ const Language_s language_portuguese = {
                 },
                 {
                     "\uE07B Classificar por arquivo",
-                    NULL
+                    "\uE07C Pesquisar"
                 },
                 {
                     NULL,
@@ -1369,7 +1390,7 @@ const Language_s language_portuguese = {
                 },
                 {
                     "\uE07B Exportar Insígnias",
-                    NULL
+                    "\uE07C Procurar duplicados"
                 },
                 {
                     NULL,
@@ -1467,6 +1488,13 @@ const Language_s language_portuguese = {
         .not_enough_themes = "Você não tem temas suficientes selecionados.",
         .uninstall_confirm = "Tem certeza de que deseja excluir\no splash instalado?",
         .delete_confirm = "Tem certeza de que deseja excluir isso?",
+        .search_q = "O que você está procurando?\nDeixe vazio para mostrar tudo.",
+        .search = "Pesquisar",
+        .no_matches = "Nada corresponde a esta pesquisa.",
+        .duplicates_busy = "Ainda procurando duplicados,\ntente novamente em instantes.",
+        .no_duplicates = "Nenhum duplicado encontrado.",
+        .delete_duplicates_confirm = "Estes são cópias uns dos outros.\nApagar todos menos um de cada?",
+        .hide_duplicates_confirm = "Ocultar todos menos um de cada?",
     },
     .remote =
     {
@@ -1735,7 +1763,7 @@ const Language_s language_korean = {
                 },
                 {
                     "\uE07B Sort by filename",
-                    NULL
+                    "\uE07C Search"
                 },
                 {
                     NULL,
@@ -1777,7 +1805,7 @@ const Language_s language_korean = {
                 },
                 {
                     "\uE07B Badges",
-                    NULL
+                    "\uE07C Find duplicates"
                 },
                 {
                     NULL,
@@ -1876,6 +1904,13 @@ const Language_s language_korean = {
         .not_enough_themes = "You don't have enough themes selected.",
         .uninstall_confirm = "Are you sure you would like to delete\nthe installed splash?",
         .delete_confirm = "Are you sure you would like\nto delete this?",
+        .search_q = "What are you looking for?\nLeave empty to show everything.",
+        .search = "Search",
+        .no_matches = "Nothing matches this search.",
+        .duplicates_busy = "Still looking for duplicates,\ntry again in a bit.",
+        .no_duplicates = "No duplicates found.",
+        .delete_duplicates_confirm = "These are copies of each other.\nDelete all but one of each?",
+        .hide_duplicates_confirm = "Hide all but one of each instead?",
     },
     .remote =
     {
@@ -2090,8 +2125,10 @@ Language_s init_strings(CFG_Language lang)
 CFG_Language get_system_language(void)
 {
     u8 lang = CFG_LANGUAGE_EN;
+#ifdef __3DS__
     // can never fail, cfguInit is one of the very first thing that happens on start
     // and if it does anyway, default to english
     CFGU_GetSystemLanguage(&lang);
+#endif
     return (CFG_Language)lang;
 }
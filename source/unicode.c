@@ -75,4 +75,173 @@ size_t strucat(u16 * destination, const u16 * source)
     memcpy(&destination[dest_len], source, source_len * sizeof(u16));
     destination[min(dest_len + source_len, 0x106 - 1)] = 0;
     return source_len;
-}
\ No newline at end of file
+}
+u16 fold_case(u16 c)
+{
+    if((c >= 'A' && c <= 'Z') || (c >= 0xC0 && c <= 0xDE && c != 0xD7))
+        return c + 0x20;
+    if(c >= 0xFF01 && c <= 0xFF5E)
+        return fold_case(c - 0xFEE0);
+    return c;
+}
+
+#ifndef __3DS__
+// one code point from in, returns how many units it took or -1
+static ssize_t decode_utf8(u32 * out, const u8 * in)
+{
+    if(in[0] < 0x80)
+    {
+        *out = in[0];
+        return 1;
+    }
+
+    int following;
+    u32 code;
+    if((in[0] & 0xE0) == 0xC0)
+    {
+        following = 1;
+        code = in[0] & 0x1F;
+    }
+    else if((in[0] & 0xF0) == 0xE0)
+    {
+        following = 2;
+        code = in[0] & 0x0F;
+    }
+    else if((in[0] & 0xF8) == 0xF0)
+    {
+        following = 3;
+        code = in[0] & 0x07;
+    }
+    else
+    {
+        return -1;
+    }
+
+    for(int i = 1; i <= following; i++)
+    {
+        if((in[i] & 0xC0) != 0x80)
+            return -1;
+        code = (code << 6) | (in[i] & 0x3F);
+    }
+
+    if(code > 0x10FFFF || (code >= 0xD800 && code < 0xE000))
+        return -1;
+
+    *out = code;
+    return following + 1;
+}
+
+static ssize_t decode_utf16(u32 * out, const u16 * in)
+{
+    if(in[0] >= 0xD800 && in[0] < 0xDC00)
+    {
+        if(in[1] < 0xDC00 || in[1] >= 0xE000)
+            return -1;
+        *out = 0x10000 + ((in[0] - 0xD800) << 10) + (in[1] - 0xDC00);
+        return 2;
+    }
+    if(in[0] >= 0xDC00 && in[0] < 0xE000)
+        return -1;
+
+    *out = in[0];
+    return 1;
+}
+
+static ssize_t encode_utf8(u8 * out, u32 code)
+{
+    if(code < 0x80)
+    {
+        out[0] = code;
+        return 1;
+    }
+    if(code < 0x800)
+    {
+        out[0] = 0xC0 | (code >> 6);
+        out[1] = 0x80 | (code & 0x3F);
+        return 2;
+    }
+    if(code < 0x10000)
+    {
+        out[0] = 0xE0 | (code >> 12);
+        out[1] = 0x80 | ((code >> 6) & 0x3F);
+        out[2] = 0x80 | (code & 0x3F);
+        return 3;
+    }
+    out[0] = 0xF0 | (code >> 18);
+    out[1] = 0x80 | ((code >> 12) & 0x3F);
+    out[2] = 0x80 | ((code >> 6) & 0x3F);
+    out[3] = 0x80 | (code & 0x3F);
+    return 4;
+}
+
+static ssize_t encode_utf16(u16 * out, u32 code)
+{
+    if(code < 0x10000)
+    {
+        out[0] = code;
+        return 1;
+    }
+    code -= 0x10000;
+    out[0] = 0xD800 | (code >> 10);
+    out[1] = 0xDC00 | (code & 0x3FF);
+    return 2;
+}
+
+ssize_t utf8_to_utf16(u16 * out, const u8 * in, size_t len)
+{
+    ssize_t written = 0;
+    u32 code;
+    u16 encoded[2];
+    while(*in != 0)
+    {
+        const ssize_t units = decode_utf8(&code, in);
+        if(units == -1)
+            return -1;
+        in += units;
+
+        const ssize_t out_units = encode_utf16(encoded, code);
+        if(out != NULL && written + out_units <= (ssize_t)len)
+            memcpy(out + written, encoded, out_units * sizeof(u16));
+        written += out_units;
+    }
+    return written;
+}
+
+ssize_t utf16_to_utf8(u8 * out, const u16 * in, size_t len)
+{
+    ssize_t written = 0;
+    u32 code;
+    u8 encoded[4];
+    while(*in != 0)
+    {
+        const ssize_t units = decode_utf16(&code, in);
+        if(units == -1)
+            return -1;
+        in += units;
+
+        const ssize_t out_units = encode_utf8(encoded, code);
+        if(out != NULL && written + out_units <= (ssize_t)len)
+            memcpy(out + written, encoded, out_units);
+        written += out_units;
+    }
+    return written;
+}
+
+ssize_t utf16_to_utf32(u32 * out, const u16 * in, size_t len)
+{
+    ssize_t written = 0;
+    u32 code;
+    while(*in != 0)
+    {
+        const ssize_t units = decode_utf16(&code, in);
+        if(units == -1)
+            return -1;
+        in += units;
+
+        if(out != NULL && written < (ssize_t)len)
+            out[written] = code;
+        written++;
+    }
+    return written;
+}
+#endif
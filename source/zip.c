@@ -0,0 +1,545 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include <strings.h>
+#include <zlib.h>
+
+#include "zip.h"
+#include "unicode.h"
+
+#define ZIP_EOCD_SIGNATURE 0x06054B50
+#define ZIP_CENTRAL_SIGNATURE 0x02014B50
+#define ZIP_LOCAL_SIGNATURE 0x04034B50
+
+#define ZIP_EOCD_SIZE 22
+#define ZIP_CENTRAL_HEADER_SIZE 46
+#define ZIP_LOCAL_HEADER_SIZE 30
+#define ZIP_MAX_COMMENT_SIZE 0xFFFF
+
+#define ZIP_METHOD_STORED 0
+#define ZIP_METHOD_DEFLATE 8
+#define ZIP_FLAG_ENCRYPTED 0x0001
+
+#define ZIP_INFLATE_CHUNK_SIZE 0x4000
+
+static Zip_Index_s * index_cache[ZIP_INDEX_CACHE_SIZE];
+static u32 index_use_counter;
+static Platform_Mutex index_lock;
+
+static inline u16 read_u16(const u8 * p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static inline u32 read_u32(const u8 * p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((u32)p[3] << 24);
+}
+
+static void free_index(Zip_Index_s * index)
+{
+    if(index == NULL)
+        return;
+
+    free(index->members);
+    free(index->names);
+    free(index);
+}
+
+static bool parse_central_directory(Zip_Index_s * index, const u8 * directory, u32 directory_size, u32 count)
+{
+    index->members = malloc(count * sizeof(Zip_Member_s));
+    // names are stored NUL terminated, so at most one more byte per member than in the directory
+    index->names = malloc(directory_size + count);
+    if(index->members == NULL || index->names == NULL)
+        return false;
+
+    u32 pos = 0;
+    u32 names_size = 0;
+    index->members_count = 0;
+    for(u32 i = 0; i < count; i++)
+    {
+        if(directory_size - pos < ZIP_CENTRAL_HEADER_SIZE)
+            return false;
+
+        const u8 * const header = directory + pos;
+        if(read_u32(header) != ZIP_CENTRAL_SIGNATURE)
+            return false;
+
+        const u16 name_size = read_u16(header + 28);
+        const u16 extra_size = read_u16(header + 30);
+        const u16 comment_size = read_u16(header + 32);
+        const u32 header_size = ZIP_CENTRAL_HEADER_SIZE + name_size + extra_size + comment_size;
+        if(directory_size - pos < header_size)
+            return false;
+
+        Zip_Member_s * const member = &index->members[index->members_count];
+        member->flags = read_u16(header + 8);
+        member->method = read_u16(header + 10);
+        member->crc = read_u32(header + 16);
+        member->compressed_size = read_u32(header + 20);
+        member->size = read_u32(header + 24);
+        member->local_header_offset = read_u32(header + 42);
+        pos += header_size;
+
+        // zip64 sizes and offsets are in the extra field, let libarchive deal with those
+        if(member->compressed_size == 0xFFFFFFFF || member->size == 0xFFFFFFFF || member->local_header_offset == 0xFFFFFFFF)
+            return false;
+
+        // directories are never read
+        if(name_size == 0 || header[ZIP_CENTRAL_HEADER_SIZE + name_size - 1] == '/')
+            continue;
+
+        member->name_offset = names_size;
+        memcpy(index->names + names_size, header + ZIP_CENTRAL_HEADER_SIZE, name_size);
+        names_size += name_size;
+        index->names[names_size++] = '\0';
+        index->members_count++;
+    }
+
+    return true;
+}
+
+static Zip_Index_s * build_index(Platform_File file, const u16 * zip_path, u64 zip_size)
+{
+    if(zip_size < ZIP_EOCD_SIZE || zip_size > 0xFFFFFFFF)
+        return NULL;
+
+    // the end of central directory record is at the end of the file, before a comment of up to 64KB
+    const u32 tail_size = min(zip_size, ZIP_EOCD_SIZE + ZIP_MAX_COMMENT_SIZE);
+    u8 * tail = malloc(tail_size);
+    if(tail == NULL || R_FAILED(platform_file_read(file, zip_size - tail_size, tail, tail_size, NULL)))
+    {
+        free(tail);
+        return NULL;
+    }
+
+    const u8 * eocd = NULL;
+    for(u32 pos = tail_size - ZIP_EOCD_SIZE + 1; pos-- > 0;)
+    {
+        if(read_u32(tail + pos) == ZIP_EOCD_SIGNATURE)
+        {
+            eocd = tail + pos;
+            break;
+        }
+    }
+
+    if(eocd == NULL)
+    {
+        DEBUG("No end of central directory in zip\n");
+        free(tail);
+        return NULL;
+    }
+
+    const u16 count = read_u16(eocd + 10);
+    const u32 directory_size = read_u32(eocd + 12);
+    const u32 directory_offset = read_u32(eocd + 16);
+    free(tail);
+
+    if(count == 0xFFFF || directory_offset == 0xFFFFFFFF || (u64)directory_offset + directory_size > zip_size)
+        return NULL;
+
+    Zip_Index_s * index = calloc(1, sizeof(Zip_Index_s));
+    u8 * directory = malloc(directory_size);
+    bool success = index != NULL && directory != NULL;
+    if(success)
+        success = R_SUCCEEDED(platform_file_read(file, directory_offset, directory, directory_size, NULL));
+    if(success)
+        success = parse_central_directory(index, directory, directory_size, count);
+
+    free(directory);
+
+    if(!success)
+    {
+        free_index(index);
+        return NULL;
+    }
+
+    memcpy(index->path, zip_path, sizeof(index->path));
+    index->zip_size = zip_size;
+    return index;
+}
+
+// has to be called with index_lock held
+static int find_cached_index(const u16 * zip_path)
+{
+    for(int i = 0; i < ZIP_INDEX_CACHE_SIZE; i++)
+    {
+        if(index_cache[i] != NULL && !memcmp(index_cache[i]->path, zip_path, strulen(zip_path, 0x106) * sizeof(u16) + sizeof(u16)))
+            return i;
+    }
+
+    return -1;
+}
+
+// has to be called with index_lock held
+static void cache_index(Zip_Index_s * index)
+{
+    int slot = find_cached_index(index->path);
+    if(slot < 0)
+    {
+        slot = 0;
+        for(int i = 0; i < ZIP_INDEX_CACHE_SIZE; i++)
+        {
+            if(index_cache[i] == NULL)
+            {
+                slot = i;
+                break;
+            }
+
+            if(index_cache[i]->last_used < index_cache[slot]->last_used)
+                slot = i;
+        }
+    }
+
+    free_index(index_cache[slot]);
+    index_cache[slot] = index;
+}
+
+// looks up every file of file_names, members[i].size is 0 for the ones not in the zip.
+// returns false if the zip isn't in the cache, or was replaced
+static bool find_members(const u16 * zip_path, u64 zip_size, const char ** file_names, Zip_Member_s * members, int count)
+{
+    platform_mutex_lock(&index_lock);
+
+    bool cached = false;
+    const int slot = find_cached_index(zip_path);
+    if(slot >= 0 && index_cache[slot]->zip_size == zip_size)
+    {
+        Zip_Index_s * const index = index_cache[slot];
+        index->last_used = ++index_use_counter;
+        cached = true;
+
+        for(int i = 0; i < count; i++)
+        {
+            memset(&members[i], 0, sizeof(Zip_Member_s));
+            for(u32 j = 0; j < index->members_count; j++)
+            {
+                if(!strcasecmp(index->names + index->members[j].name_offset, file_names[i]))
+                {
+                    // copied out, so reading it doesn't need the index to stay in the cache
+                    members[i] = index->members[j];
+                    break;
+                }
+            }
+        }
+    }
+
+    platform_mutex_unlock(&index_lock);
+    return cached;
+}
+
+static bool member_reader_start(Zip_Member_Reader_s * reader, Platform_File file, const Zip_Member_s * member)
+{
+    memset(reader, 0, sizeof(Zip_Member_Reader_s));
+    reader->file = file;
+    reader->member = *member;
+
+    if(member->flags & ZIP_FLAG_ENCRYPTED)
+        return false;
+    if(member->method != ZIP_METHOD_STORED && member->method != ZIP_METHOD_DEFLATE)
+        return false;
+    if(member->method == ZIP_METHOD_STORED && member->compressed_size != member->size)
+        return false;
+
+    u8 local_header[ZIP_LOCAL_HEADER_SIZE];
+    if(R_FAILED(platform_file_read(file, member->local_header_offset, local_header, ZIP_LOCAL_HEADER_SIZE, NULL)))
+        return false;
+    if(read_u32(local_header) != ZIP_LOCAL_SIGNATURE)
+        return false;
+
+    // the local extra field can be different from the central one
+    reader->data_offset = (u64)member->local_header_offset + ZIP_LOCAL_HEADER_SIZE + read_u16(local_header + 26) + read_u16(local_header + 28);
+    reader->offset = reader->data_offset;
+    reader->compressed_left = member->compressed_size;
+
+    if(member->method == ZIP_METHOD_DEFLATE)
+    {
+        reader->inflate = calloc(1, sizeof(z_stream));
+        reader->chunk = malloc(ZIP_INFLATE_CHUNK_SIZE);
+        if(reader->inflate == NULL || reader->chunk == NULL || inflateInit2(reader->inflate, -MAX_WBITS) != Z_OK)
+        {
+            free(reader->inflate);
+            free(reader->chunk);
+            reader->inflate = NULL;
+            reader->chunk = NULL;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void member_reader_end(Zip_Member_Reader_s * reader)
+{
+    if(reader->inflate != NULL)
+    {
+        inflateEnd(reader->inflate);
+        free(reader->inflate);
+        free(reader->chunk);
+        reader->inflate = NULL;
+        reader->chunk = NULL;
+    }
+}
+
+static u32 inflate_chunk(Zip_Member_Reader_s * reader, u8 * buf, u32 size)
+{
+    z_stream * const stream = reader->inflate;
+    stream->next_out = buf;
+    stream->avail_out = size;
+
+    while(stream->avail_out != 0)
+    {
+        if(stream->avail_in == 0)
+        {
+            u32 read = 0;
+            if(reader->compressed_left == 0 || R_FAILED(platform_file_read(reader->file, reader->offset, reader->chunk, min(reader->compressed_left, ZIP_INFLATE_CHUNK_SIZE), &read)) || read == 0)
+            {
+                reader->error = true;
+                break;
+            }
+
+            reader->offset += read;
+            reader->compressed_left -= read;
+            stream->next_in = reader->chunk;
+            stream->avail_in = read;
+        }
+
+        const int ret = inflate(stream, Z_NO_FLUSH);
+        if(ret == Z_STREAM_END)
+            break;
+        if(ret != Z_OK)
+        {
+            reader->error = true;
+            break;
+        }
+    }
+
+    return size - stream->avail_out;
+}
+
+u32 zip_member_read(Zip_Member_Reader_s * reader, char * buf, u32 size)
+{
+    size = min(size, reader->member.size - reader->produced);
+    if(reader->error || size == 0)
+        return 0;
+
+    u32 read = 0;
+    if(reader->inflate == NULL)
+    {
+        if(R_FAILED(platform_file_read(reader->file, reader->data_offset + reader->produced, buf, size, &read)) || read != size)
+            reader->error = true;
+    }
+    else
+    {
+        read = inflate_chunk(reader, (u8 *)buf, size);
+        if(read != size)
+            reader->error = true;
+    }
+
+    reader->crc = crc32(reader->crc, (const u8 *)buf, read);
+    reader->produced += read;
+    if(reader->produced == reader->member.size && reader->crc != reader->member.crc)
+    {
+        DEBUG("CRC mismatch in zip\n");
+        reader->error = true;
+    }
+
+    return reader->error ? 0 : read;
+}
+
+bool zip_member_rewind(Zip_Member_Reader_s * reader)
+{
+    if(reader->inflate != NULL && inflateReset(reader->inflate) != Z_OK)
+        return false;
+
+    reader->offset = reader->data_offset;
+    reader->compressed_left = reader->member.compressed_size;
+    reader->produced = 0;
+    reader->crc = 0;
+    reader->error = false;
+    return true;
+}
+
+static bool read_member(Platform_File file, const Zip_Member_s * member, char ** buf)
+{
+    Zip_Member_Reader_s reader;
+    if(!member_reader_start(&reader, file, member))
+        return false;
+
+    char * out = malloc(member->size);
+    const bool success = out != NULL && zip_member_read(&reader, out, member->size) == member->size;
+    member_reader_end(&reader);
+
+    if(!success)
+    {
+        free(out);
+        return false;
+    }
+
+    *buf = out;
+    return true;
+}
+
+void zip_index_init(void)
+{
+    platform_mutex_init(&index_lock);
+}
+
+void zip_index_exit(void)
+{
+    platform_mutex_lock(&index_lock);
+    for(int i = 0; i < ZIP_INDEX_CACHE_SIZE; i++)
+    {
+        free_index(index_cache[i]);
+        index_cache[i] = NULL;
+    }
+    platform_mutex_unlock(&index_lock);
+}
+
+void zip_index_forget(const u16 * zip_path)
+{
+    platform_mutex_lock(&index_lock);
+    const int slot = find_cached_index(zip_path);
+    if(slot >= 0)
+    {
+        free_index(index_cache[slot]);
+        index_cache[slot] = NULL;
+    }
+    platform_mutex_unlock(&index_lock);
+}
+
+bool zip_index_open(Zip_Member_Reader_s * reader, const u16 * zip_path, const char * file_name)
+{
+    memset(reader, 0, sizeof(Zip_Member_Reader_s));
+
+    Platform_File file;
+    if(R_FAILED(platform_file_open(&file, PLATFORM_ARCHIVE_SD, zip_path, PLATFORM_OPEN_READ)))
+        return false;
+
+    u64 zip_size = 0;
+    platform_file_get_size(file, &zip_size);
+
+    Zip_Member_s member;
+    if(!find_members(zip_path, zip_size, &file_name, &member, 1))
+    {
+        Zip_Index_s * index = build_index(file, zip_path, zip_size);
+        if(index == NULL)
+        {
+            platform_file_close(file);
+            return false;
+        }
+
+        platform_mutex_lock(&index_lock);
+        cache_index(index);
+        platform_mutex_unlock(&index_lock);
+
+        find_members(zip_path, zip_size, &file_name, &member, 1);
+    }
+
+    if(member.size == 0)
+    {
+        platform_file_close(file);
+        return true;
+    }
+
+    if(!member_reader_start(reader, file, &member))
+    {
+        platform_file_close(file);
+        memset(reader, 0, sizeof(Zip_Member_Reader_s));
+        return false;
+    }
+
+    return true;
+}
+
+void zip_index_close(Zip_Member_Reader_s * reader)
+{
+    member_reader_end(reader);
+    if(reader->member.size != 0)
+        platform_file_close(reader->file);
+    memset(reader, 0, sizeof(Zip_Member_Reader_s));
+}
+
+bool zip_index_read(const u16 * zip_path, const char ** file_names, char ** bufs, u32 * sizes, int count)
+{
+    for(int i = 0; i < count; i++)
+    {
+        sizes[i] = 0;
+        if(bufs != NULL)
+            bufs[i] = NULL;
+    }
+
+    Platform_File file;
+    if(R_FAILED(platform_file_open(&file, PLATFORM_ARCHIVE_SD, zip_path, PLATFORM_OPEN_READ)))
+        return false;
+
+    u64 zip_size = 0;
+    platform_file_get_size(file, &zip_size);
+
+    Zip_Member_s members[count];
+    if(!find_members(zip_path, zip_size, file_names, members, count))
+    {
+        Zip_Index_s * index = build_index(file, zip_path, zip_size);
+        if(index == NULL)
+        {
+            platform_file_close(file);
+            return false;
+        }
+
+        platform_mutex_lock(&index_lock);
+        cache_index(index);
+        platform_mutex_unlock(&index_lock);
+
+        find_members(zip_path, zip_size, file_names, members, count);
+    }
+
+    bool success = true;
+    for(int i = 0; i < count && success; i++)
+    {
+        if(members[i].size == 0)
+            continue;
+
+        if(bufs != NULL)
+            success = read_member(file, &members[i], &bufs[i]);
+        if(success)
+            sizes[i] = members[i].size;
+    }
+
+    platform_file_close(file);
+
+    if(!success && bufs != NULL)
+    {
+        for(int i = 0; i < count; i++)
+        {
+            free(bufs[i]);
+            bufs[i] = NULL;
+            sizes[i] = 0;
+        }
+    }
+
+    return success;
+}
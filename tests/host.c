@@ -0,0 +1,68 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+// What main.c and draw.c give the other modules on the console, for the tests and benchmarks built with make host.
+// Nothing is drawn: the errors and the loading bars go to stderr
+
+#include "common.h"
+#include "draw.h"
+#include "loading.h"
+#include "ui_strings.h"
+
+bool quit = false;
+bool dspfirm = false;
+Language_s language = {0};
+
+const char * main_paths[REMOTE_MODE_AMOUNT] = {
+    "/Themes/",
+    "/Splashes/",
+    "/Badges/"
+};
+
+// the strings are used as formats, they have to be there before anything runs
+__attribute__((constructor)) static void init_language(void)
+{
+    language = init_strings(CFG_LANGUAGE_EN);
+}
+
+void throw_error(const char * error, ErrorLevel level)
+{
+    DEBUG("%s: %s\n", level == ERROR_LEVEL_ERROR ? "error" : "warning", error);
+}
+
+void draw_loading_bar(u32 current, u32 max, InstallType type)
+{
+    (void)current;
+    (void)max;
+    (void)type;
+}
+
+void copy_texture_data(C3D_Tex * texture, const u16 * src, const Entry_Icon_s * current_icon)
+{
+    (void)texture;
+    (void)src;
+    (void)current_icon;
+}
@@ -0,0 +1,199 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include "test.h"
+#include "lz.h"
+
+int test_failures = 0;
+
+int test_result(void)
+{
+    if(test_failures)
+        printf("%d checks failed\n", test_failures);
+    return test_failures != 0;
+}
+
+// xorshift32, the state can't be 0
+u32 test_random(u32 * state)
+{
+    u32 x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+char * samples_noise(u32 size, u32 seed)
+{
+    char * data = malloc(size ? size : 1);
+    u32 state = seed | 1;
+    for(u32 i = 0; i < size; i++)
+        data[i] = test_random(&state);
+    return data;
+}
+
+static char * make_text(u32 size)
+{
+    static const char * const words[] = {
+        "theme", "badge", "splash", "shuffle", "the", "a", "of", "background", "music", "menu",
+        "folder", "icon", "home", "screen", "top", "bottom", "color", "and", "with", "download",
+    };
+    const int words_count = sizeof(words) / sizeof(words[0]);
+
+    char * data = malloc(size);
+    u32 state = 0x7E57;
+    u32 pos = 0;
+    while(pos < size)
+    {
+        const char * word = words[test_random(&state) % words_count];
+        for(; *word != '\0' && pos < size; word++)
+            data[pos++] = *word;
+        if(pos < size)
+            data[pos++] = test_random(&state) % 8 == 0 ? '\n' : ' ';
+    }
+    return data;
+}
+
+// a gradient with a bit of noise, like the textures of a body
+static char * make_picture(u32 width, u32 height)
+{
+    u16 * data = malloc(width * height * sizeof(u16));
+    u32 state = 0xC010;
+    for(u32 y = 0; y < height; y++)
+    {
+        for(u32 x = 0; x < width; x++)
+        {
+            const u32 noise = test_random(&state) % 4 == 0;
+            const u16 r = (x * 31 / width + noise) & 0x1F;
+            const u16 g = (y * 63 / height) & 0x3F;
+            const u16 b = ((x + y) * 31 / (width + height)) & 0x1F;
+            data[y * width + x] = (r << 11) | (g << 5) | b;
+        }
+    }
+    return (char *)data;
+}
+
+// runs of one byte, some longer than a back-reference can be
+static char * make_runs(u32 size)
+{
+    char * data = malloc(size);
+    u32 state = 0x2B2B;
+    u32 pos = 0;
+    for(u32 run = 1; pos < size; run++)
+    {
+        const u32 len = run % 0x100 == 0 ? LZ11_MAX_MATCH + 0x100 : test_random(&state) % 0x200 + 1;
+        const char value = test_random(&state);
+        for(u32 i = 0; i < len && pos < size; i++)
+            data[pos++] = value;
+    }
+    return data;
+}
+
+// noise repeated exactly one window later, and a bit further
+static char * make_far_repeats(u32 size)
+{
+    char * data = samples_noise(size, 0xFA2);
+    for(u32 pos = LZ11_WINDOW_SIZE; pos < size; pos++)
+        data[pos] = data[pos - LZ11_WINDOW_SIZE];
+    return data;
+}
+
+void samples_make(Sample_s samples[SAMPLES_AMOUNT])
+{
+    samples[0] = (Sample_s){"zeroes", calloc(1, 0x10000), 0x10000};
+    samples[1] = (Sample_s){"noise", samples_noise(0x10000, 0x5EED), 0x10000};
+    samples[2] = (Sample_s){"text", make_text(0x40000), 0x40000};
+    samples[3] = (Sample_s){"picture", make_picture(400, 240), 400 * 240 * sizeof(u16)};
+    samples[4] = (Sample_s){"runs", make_runs(0x40000), 0x40000};
+    samples[5] = (Sample_s){"far repeats", make_far_repeats(0x8000), 0x8000};
+}
+
+void samples_free(Sample_s samples[SAMPLES_AMOUNT])
+{
+    for(int i = 0; i < SAMPLES_AMOUNT; i++)
+        free(samples[i].data);
+}
+
+u32 reference_lz11_decompress(const u8 * in, u32 in_size, u8 ** out)
+{
+    if(in_size < LZ11_HEADER_SIZE || in[0] != LZ11_MAGIC)
+        return 0;
+
+    const u32 size = in[1] | (in[2] << 8) | (in[3] << 16);
+    *out = malloc(size ? size : 1);
+    u32 pos = LZ11_HEADER_SIZE, written = 0;
+
+    while(written < size)
+    {
+        if(pos >= in_size)
+            goto corrupt;
+        const u8 flags = in[pos++];
+        for(int bit = 7; bit >= 0 && written < size; bit--)
+        {
+            if(!(flags & (1 << bit)))
+            {
+                if(pos >= in_size)
+                    goto corrupt;
+                (*out)[written++] = in[pos++];
+                continue;
+            }
+
+            if(pos + 2 > in_size)
+                goto corrupt;
+            u32 len;
+            switch(in[pos] >> 4)
+            {
+                case 0:
+                    if(pos + 3 > in_size)
+                        goto corrupt;
+                    len = (((in[pos] & 0xF) << 4) | (in[pos + 1] >> 4)) + 0x11;
+                    pos += 1;
+                    break;
+                case 1:
+                    if(pos + 4 > in_size)
+                        goto corrupt;
+                    len = (((in[pos] & 0xF) << 12) | (in[pos + 1] << 4) | (in[pos + 2] >> 4)) + 0x111;
+                    pos += 2;
+                    break;
+                default:
+                    len = (in[pos] >> 4) + 1;
+                    break;
+            }
+            const u32 disp = (((in[pos] & 0xF) << 8) | in[pos + 1]) + 1;
+            pos += 2;
+            if(disp > written || len > size - written)
+                goto corrupt;
+            for(u32 i = 0; i < len; i++, written++)
+                (*out)[written] = (*out)[written - disp];
+        }
+    }
+    return size;
+
+    corrupt:
+    free(*out);
+    *out = NULL;
+    return 0;
+}
@@ -0,0 +1,69 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+// What the tests and benchmarks share, built into libanemone.a with the modules
+
+#ifndef TEST_H
+#define TEST_H
+
+#include "common.h"
+
+extern int test_failures;
+
+// failures go to stdout, stderr is what the modules tell with DEBUG
+#define CHECK(cond) do { \
+        if(!(cond)) \
+        { \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            test_failures++; \
+        } \
+    } while(0)
+
+// what main returns
+int test_result(void);
+
+// xorshift32, the state can't be 0
+u32 test_random(u32 * state);
+
+typedef struct {
+    const char * name;
+    char * data;
+    u32 size;
+} Sample_s;
+
+// Made up data like the one in themes, the same on every run:
+// zeroes, noise, text, 16 bit pictures, long runs and repeats a whole window away
+#define SAMPLES_AMOUNT 6
+void samples_make(Sample_s samples[SAMPLES_AMOUNT]);
+void samples_free(Sample_s samples[SAMPLES_AMOUNT]);
+// size bytes of noise from seed, allocated with malloc
+char * samples_noise(u32 size, u32 seed);
+
+// LZ11 the way the format describes it, one token at a time, to check the real decoders against.
+// Returns the decompressed size allocated into *out, 0 if the data is corrupt
+u32 reference_lz11_decompress(const u8 * in, u32 in_size, u8 ** out);
+
+#endif
@@ -0,0 +1,280 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+// The pages of a list of 100k entries: only the ones around the scrolling stay in memory,
+// the others go to the swap file and come back as they were
+
+#include "test.h"
+#include "entries_list.h"
+#include "loading.h"
+#include "draw.h"
+#include "unicode.h"
+
+#define ENTRIES_AMOUNT 100000
+#define SMALL_AMOUNT 300
+#define WALK_AMOUNT 4096
+
+static const char * const big_roots[] = { "/paging_test/" };
+static const char * const small_roots[] = { "/paging_small/" };
+
+static void make_entries(const char * root, int count)
+{
+    u16 path[0x106] = {0};
+    struacat(path, root);
+    platform_dir_delete(PLATFORM_ARCHIVE_SD, path);
+    CHECK(R_SUCCEEDED(platform_dir_create(PLATFORM_ARCHIVE_SD, path)));
+
+    for(int i = 0; i < count; i++)
+    {
+        char name[0x40];
+        sprintf(name, "%se%05d.zip", root, i);
+        path[0] = 0;
+        struacat(path, name);
+        platform_file_create(PLATFORM_ARCHIVE_SD, path, 0);
+    }
+}
+
+static void delete_entries(const char * root)
+{
+    u16 path[0x106] = {0};
+    struacat(path, root);
+    CHECK(R_SUCCEEDED(platform_dir_delete(PLATFORM_ARCHIVE_SD, path)));
+}
+
+static bool same_string(const u16 * a, const char * b)
+{
+    u16 expected[0x106] = {0};
+    struacat(expected, b);
+    const size_t len = strulen(expected, 0x106);
+    return strulen(a, 0x106) == len && !memcmp(a, expected, len * sizeof(u16));
+}
+
+static int compare_paths(const u16 * a, const u16 * b)
+{
+    while(*a && *a == *b)
+    {
+        a++;
+        b++;
+    }
+    return (int)*a - (int)*b;
+}
+
+static bool load_list(Entry_List_s * list, const char * const * roots)
+{
+    memset(list, 0, sizeof(Entry_List_s));
+    list->mode = MODE_THEMES;
+    list->entries_loaded = 4;
+    // nothing saves the entries index, the test leaves nothing behind in the cache
+    list->info_loading = true;
+    return R_SUCCEEDED(load_entries(roots, 1, list, INSTALL_LOADING_THEMES));
+}
+
+static bool is_resident(const Entry_List_s * list, int id)
+{
+    return list->entries[id >> ENTRIES_PAGE_SHIFT].entries != NULL;
+}
+
+// the other pages get used until the one of id is the least recently used and goes
+static void scroll_away(Entry_List_s * list, int id)
+{
+    list->scroll = 0;
+    list->selected_entry = 0;
+    const int pages = list->entries_count >> ENTRIES_PAGE_SHIFT;
+    for(int page = 1; page < pages && is_resident(list, id); page++)
+    {
+        if(page != id >> ENTRIES_PAGE_SHIFT)
+            get_entry_at(list, page << ENTRIES_PAGE_SHIFT);
+        list_trim(list);
+    }
+}
+
+static void test_walk(Entry_List_s * list)
+{
+    CHECK(list->entries_count == ENTRIES_AMOUNT);
+    CHECK(list->resident_pages <= ENTRIES_RESIDENT_PAGES + 1);
+    CHECK(list->swap_opened);
+
+    sort_by_filename(list);
+    CHECK(list->resident_pages <= ENTRIES_RESIDENT_PAGES + 1);
+
+    // the paths stay in memory
+    bool * seen = calloc(ENTRIES_AMOUNT, sizeof(bool));
+    bool sorted = true, once = true;
+    for(int i = 0; i < ENTRIES_AMOUNT; i++)
+    {
+        const int id = list_get_id(list, i);
+        sorted &= i == 0 || compare_paths(list->paths[list_get_id(list, i - 1)], list->paths[id]) < 0;
+        once &= !seen[id];
+        seen[id] = true;
+    }
+    CHECK(sorted);
+    CHECK(once);
+    free(seen);
+
+    // going down the list, the pages are trimmed as if a frame went by every few entries
+    bool same = true;
+    for(int i = 0; i < WALK_AMOUNT; i++)
+    {
+        const int id = list_get_id(list, i);
+        const Entry_s * const entry = get_entry_at(list, id);
+        same &= entry->id == (u32)id && entry->path == list->paths[id] && entry->info_pending;
+
+        if(i % 16 == 15)
+        {
+            list->scroll = i;
+            list->selected_entry = i;
+            list_trim(list);
+            CHECK(list->resident_pages <= ENTRIES_RESIDENT_PAGES);
+        }
+    }
+    CHECK(same);
+
+    CHECK(same_string(list_get_entry(list, 0)->path, "e00000.zip"));
+    CHECK(same_string(list_get_entry(list, ENTRIES_AMOUNT - 1)->path, "e99999.zip"));
+}
+
+static void test_swapped_changes(Entry_List_s * list)
+{
+    list->scroll = 50000;
+    list->selected_entry = 50000;
+    const int marked = list_get_id(list, 50000);
+    const int other = list_get_id(list, 10);
+
+    Icon_s * icon = calloc(1, sizeof(Icon_s));
+    memcpy(icon->name, u"Swapped", sizeof(u"Swapped"));
+    memcpy(icon->desc, u"Read back", sizeof(u"Read back"));
+    memcpy(icon->author, u"Tester", sizeof(u"Tester"));
+    Entry_s * entry = get_entry_at(list, marked);
+    parse_smdh(icon, entry, entry->path, list_entry_strings(list, entry));
+    entry->info_pending = false;
+    entry->installed = true;
+    free(icon);
+
+    scroll_away(list, marked);
+    CHECK(!is_resident(list, marked));
+
+    entry = get_entry_at(list, marked);
+    CHECK(entry->installed);
+    CHECK(!entry->info_pending);
+    CHECK(same_string(entry->name, "Swapped"));
+    CHECK(same_string(entry->desc, "Read back"));
+    CHECK(same_string(entry->author, "Tester"));
+    CHECK(entry->path == list->paths[marked]);
+    CHECK(list_next_pending(list, marked) != marked);
+
+    // the swapped out pages with something installed are gone through too
+    scroll_away(list, marked);
+    CHECK(!is_resident(list, marked));
+    list_mark_installed(list, get_entry_at(list, other));
+    CHECK(!get_entry_at(list, marked)->installed);
+    CHECK(get_entry_at(list, other)->installed);
+}
+
+static void test_resort(Entry_List_s * list)
+{
+    list->selected_entry = 500;
+    list->scroll = 498;
+    const int selected_id = list_get_id(list, 500);
+
+    list->current_sort = SORT_NAME;
+    resort_list(list);
+    CHECK(list_get_id(list, list->selected_entry) == selected_id);
+    CHECK(list->selected_entry - list->scroll == 2);
+    list_trim(list);
+    CHECK(list->resident_pages <= ENTRIES_RESIDENT_PAGES);
+}
+
+static void test_insert(Entry_List_s * list)
+{
+    sort_by_filename(list);
+    list->selected_entry = 0;
+    list->scroll = 0;
+
+    platform_file_create(PLATFORM_ARCHIVE_SD, u"/paging_test/new.zip", 0);
+    CHECK(list_insert_zip(list, u"new.zip", 0) == ENTRIES_AMOUNT);
+    CHECK(list->entries_count == ENTRIES_AMOUNT + 1);
+    CHECK(same_string(list_get_entry(list, ENTRIES_AMOUNT)->path, "new.zip"));
+    CHECK(list_get_id(list, ENTRIES_AMOUNT) == ENTRIES_AMOUNT);
+
+    // overwritten, it's the same entry. Without an info.smdh, it goes with the ones without info at the end
+    const int first_id = list_get_id(list, 0);
+    CHECK(list_insert_zip(list, u"e00000.zip", 0) == ENTRIES_AMOUNT - 1);
+    CHECK(list->entries_count == ENTRIES_AMOUNT + 1);
+    CHECK(list_get_id(list, ENTRIES_AMOUNT - 1) == first_id);
+    CHECK(same_string(list_get_entry(list, 0)->path, "e00001.zip"));
+    list_trim(list);
+}
+
+static void test_small(void)
+{
+    make_entries(small_roots[0], SMALL_AMOUNT);
+    Entry_List_s list;
+    CHECK(load_list(&list, small_roots));
+    CHECK(list.entries_count == SMALL_AMOUNT);
+
+    sort_by_filename(&list);
+    for(int i = 0; i < SMALL_AMOUNT; i++)
+        get_entry_at(&list, list_get_id(&list, i));
+    list_trim(&list);
+    CHECK(!list.swap_opened);
+    CHECK(list.resident_pages == (SMALL_AMOUNT + ENTRIES_PAGE_SIZE - 1) / ENTRIES_PAGE_SIZE);
+
+    free_sort_orders(&list);
+    list_free_entries(&list);
+    arena_free(&list.strings);
+    delete_entries(small_roots[0]);
+}
+
+int main(void)
+{
+    CHECK(R_SUCCEEDED(platform_archive_open(PLATFORM_ARCHIVE_SD, 0)));
+    platform_dir_create(PLATFORM_ARCHIVE_SD, u"/3ds");
+    platform_dir_create(PLATFORM_ARCHIVE_SD, u"/3ds/" APP_TITLE);
+    platform_dir_create(PLATFORM_ARCHIVE_SD, u"/3ds/" APP_TITLE "/cache");
+
+    make_entries(big_roots[0], ENTRIES_AMOUNT);
+    Entry_List_s list;
+    CHECK(load_list(&list, big_roots));
+    if(list.entries != NULL)
+    {
+        test_walk(&list);
+        test_swapped_changes(&list);
+        test_resort(&list);
+        test_insert(&list);
+    }
+
+    free_sort_orders(&list);
+    list_free_entries(&list);
+    arena_free(&list.strings);
+    Platform_File file;
+    CHECK(R_FAILED(platform_file_open(&file, PLATFORM_ARCHIVE_SD, u"/3ds/" APP_TITLE "/cache/entries_0.bin", PLATFORM_OPEN_READ)));
+    delete_entries(big_roots[0]);
+
+    test_small();
+
+    platform_archive_close(PLATFORM_ARCHIVE_SD);
+    return test_result();
+}
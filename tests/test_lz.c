@@ -0,0 +1,103 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+// LZ11 compression round trips: every level on every sample, checked with a plain decoder written from the format,
+// and through compress_lz_file and decompress_lz_file like the body of a theme
+
+#include "test.h"
+#include "fs.h"
+#include "lz.h"
+
+#define LZ_TEST_PATH u"/lz_test.bin"
+
+static void round_trip(const char * name, const char * data, u32 size)
+{
+    for(LZ11_Level level = 0; level < LZ11_LEVEL_AMOUNT; level++)
+    {
+        char * compressed = NULL;
+        const u32 compressed_size = lz11_compress(data, size, &compressed, level);
+        CHECK(compressed_size >= LZ11_HEADER_SIZE);
+        // all literals, and a flag byte every 8 of them
+        CHECK(compressed_size <= LZ11_HEADER_SIZE + size + (size + 7) / 8);
+
+        u8 * decompressed = NULL;
+        const u32 decompressed_size = reference_lz11_decompress((const u8 *)compressed, compressed_size, &decompressed);
+        CHECK(decompressed_size == size);
+        CHECK(decompressed != NULL && !memcmp(decompressed, data, size));
+        free(decompressed);
+        free(compressed);
+
+        CHECK(compress_lz_file(LZ_TEST_PATH, PLATFORM_ARCHIVE_SD, (char *)data, size, level) == compressed_size);
+
+        char * file_data = NULL;
+        CHECK(decompress_lz_file(LZ_TEST_PATH, PLATFORM_ARCHIVE_SD, &file_data) == size);
+        CHECK(file_data != NULL && !memcmp(file_data, data, size));
+        free(file_data);
+
+        if(test_failures)
+        {
+            printf("%s, %u bytes, level %d\n", name, size, level);
+            return;
+        }
+    }
+}
+
+int main(void)
+{
+    CHECK(R_SUCCEEDED(platform_archive_open(PLATFORM_ARCHIVE_SD, 0)));
+    // compress_lz_file writes over a file that is there, like the BodyCache
+    platform_file_delete(PLATFORM_ARCHIVE_SD, LZ_TEST_PATH);
+    CHECK(R_SUCCEEDED(platform_file_create(PLATFORM_ARCHIVE_SD, LZ_TEST_PATH, 0)));
+
+    Sample_s samples[SAMPLES_AMOUNT];
+    samples_make(samples);
+    for(int i = 0; i < SAMPLES_AMOUNT && !test_failures; i++)
+        round_trip(samples[i].name, samples[i].data, samples[i].size);
+    samples_free(samples);
+
+    // around the shortest match, a flag group and the window
+    static const u32 sizes[] = {
+        1, 2, 3, 4, 8, 9, 17, 18, 0x111, 0x112,
+        LZ11_WINDOW_SIZE - 1, LZ11_WINDOW_SIZE, LZ11_WINDOW_SIZE + 1, LZ11_MAX_MATCH + 1,
+    };
+    for(u32 i = 0; i < sizeof(sizes) / sizeof(sizes[0]) && !test_failures; i++)
+    {
+        char * noise = samples_noise(sizes[i], sizes[i]);
+        round_trip("noise", noise, sizes[i]);
+        memset(noise, 'A', sizes[i]);
+        round_trip("one byte", noise, sizes[i]);
+        free(noise);
+    }
+
+    // the biggest body the header can tell
+    char * big = calloc(1, LZ11_MAX_SIZE);
+    round_trip("biggest", big, LZ11_MAX_SIZE);
+    free(big);
+
+    platform_file_delete(PLATFORM_ARCHIVE_SD, LZ_TEST_PATH);
+    platform_archive_close(PLATFORM_ARCHIVE_SD);
+    return test_result();
+}
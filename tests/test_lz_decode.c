@@ -0,0 +1,294 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+// The LZ11 decode kernel on streams whose output is known: hand made ones for every kind of token,
+// the samples, and every truncation and thousands of corruptions of them, which have to be rejected
+// the same way the reference decoder rejects them without anything written past the output buffer
+
+#include "test.h"
+#include "lz.h"
+
+// checked after the output buffer, on top of what the sanitizers see
+#define CANARY_SIZE 64
+#define CANARY 0xA5
+
+typedef struct {
+    const char * name;
+    const u8 * data;
+    u32 size;
+    const char * expected;
+    u32 expected_size;
+} Golden_Stream_s;
+
+#define GOLDEN(name, expected, ...) { name, (const u8[]){__VA_ARGS__}, sizeof((const u8[]){__VA_ARGS__}), expected, sizeof(expected) - 1 }
+
+static const Golden_Stream_s golden_streams[] = {
+    GOLDEN("empty", "",
+        0x11, 0x00, 0x00, 0x00),
+    GOLDEN("literals", "hello",
+        0x11, 0x05, 0x00, 0x00, 0x00, 'h', 'e', 'l', 'l', 'o'),
+    GOLDEN("two flag groups", "abcdefghi",
+        0x11, 0x09, 0x00, 0x00, 0x00, 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 0x00, 'i'),
+    // 2 byte token, 6 bytes from 2 back
+    GOLDEN("short match", "abababab",
+        0x11, 0x08, 0x00, 0x00, 0x20, 'a', 'b', 0x50, 0x01),
+    // overlapping, 7 bytes from 3 back
+    GOLDEN("overlap", "abcabcabca",
+        0x11, 0x0A, 0x00, 0x00, 0x10, 'a', 'b', 'c', 0x60, 0x02),
+    // 3 byte token, 0x20 bytes from 1 back
+    GOLDEN("medium run", "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx",
+        0x11, 0x21, 0x00, 0x00, 0x40, 'x', 0x00, 0xF0, 0x00),
+    // 2 byte tokens, literals in between, and a match ending the data in the middle of a group
+    GOLDEN("mixed", "aaaabaaaab",
+        0x11, 0x0A, 0x00, 0x00, 0x50, 'a', 0x20, 0x00, 'b', 0x40, 0x04),
+    // trailing bytes after the end are left alone
+    GOLDEN("trailing", "ok",
+        0x11, 0x02, 0x00, 0x00, 0x00, 'o', 'k', 0xFF, 0xFF, 0xFF),
+};
+
+// 4 byte token: 0x121 bytes from 1 back
+static const u8 long_run[] = {0x11, 0x22, 0x01, 0x00, 0x40, 'z', 0x10, 0x01, 0x00, 0x00};
+
+// corrupt ones, the reference decoder rejects them too
+static const u8 bad_magic[] = {0x10, 0x02, 0x00, 0x00, 0x00, 'o', 'k'};
+static const u8 header_only[] = {0x11, 0x02, 0x00};
+static const u8 disp_too_far[] = {0x11, 0x08, 0x00, 0x00, 0x40, 'a', 0x60, 0x04};
+static const u8 disp_at_start[] = {0x11, 0x08, 0x00, 0x00, 0x80, 0x70, 0x00};
+static const u8 len_too_long[] = {0x11, 0x04, 0x00, 0x00, 0x40, 'a', 0xF0, 0x00};
+static const u8 size_too_big[] = {0x11, 0x00, 0x10, 0x00, 0x00, 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h'};
+
+typedef struct {
+    const u8 * data;
+    u32 size;
+    u32 position;
+    u32 chunk;
+} Memory_Reader_s;
+
+static u32 memory_read_callback(void * userdata, char * buf, u32 size)
+{
+    Memory_Reader_s * reader = userdata;
+    const u32 read = min(min(size, reader->chunk), reader->size - reader->position);
+    memcpy(buf, reader->data + reader->position, read);
+    reader->position += read;
+    return read;
+}
+
+typedef enum {
+    DECODE_NOT_LZ11,
+    DECODE_CORRUPT,
+    DECODE_OK,
+} DecodeResult;
+
+// decodes into a buffer of exactly the size in the header, the way decompress_lz_file does when read_size is the whole data,
+// or read_size bytes at a time. The output is allocated into *out on success
+static DecodeResult decode(const u8 * data, u32 size, u32 chunk, u32 read_size, u8 ** out, u32 * out_size)
+{
+    Memory_Reader_s reader = {data, size, 0, chunk};
+    LZ11_Stream_s * stream = malloc(sizeof(LZ11_Stream_s));
+    *out = NULL;
+    *out_size = 0;
+
+    if(!lz11_stream_open(stream, memory_read_callback, &reader))
+    {
+        free(stream);
+        return DECODE_NOT_LZ11;
+    }
+
+    u8 * buf = malloc(stream->size + CANARY_SIZE);
+    memset(buf + stream->size, CANARY, CANARY_SIZE);
+
+    u32 produced = 0, read = 0;
+    do
+    {
+        read = lz11_stream_read(stream, (char *)buf + produced, min(read_size, stream->size - produced));
+        produced += read;
+    } while(read != 0 && produced < stream->size);
+
+    for(u32 i = 0; i < CANARY_SIZE; i++)
+        CHECK(buf[stream->size + i] == CANARY);
+
+    const bool complete = !stream->error && produced == stream->size;
+    *out_size = produced;
+    free(stream);
+
+    if(!complete)
+    {
+        free(buf);
+        return DECODE_CORRUPT;
+    }
+    *out = buf;
+    return DECODE_OK;
+}
+
+// the kernel has to agree with the reference decoder on everything, whatever the chunking
+static void check_agrees(const char * name, const u8 * data, u32 size)
+{
+    u8 * expected = NULL;
+    const u32 expected_size = reference_lz11_decompress(data, size, &expected);
+    const bool expected_ok = expected != NULL;
+
+    static const u32 chunks[][2] = {
+        {LZ11_STREAM_CHUNK_SIZE, LZ11_MAX_SIZE},
+        {LZ11_STREAM_CHUNK_SIZE, LZ11_STREAM_CHUNK_SIZE},
+        {1, 0x3F},
+    };
+    for(u32 i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++)
+    {
+        u8 * out = NULL;
+        u32 out_size = 0;
+        const DecodeResult result = decode(data, size, chunks[i][0], chunks[i][1], &out, &out_size);
+        if(expected_ok)
+        {
+            CHECK(result == DECODE_OK);
+            CHECK(out_size == expected_size);
+            CHECK(out != NULL && !memcmp(out, expected, expected_size));
+        }
+        else
+        {
+            CHECK(result != DECODE_OK);
+        }
+        free(out);
+
+        if(test_failures)
+        {
+            printf("%s, %u bytes, chunk %u, reads of %u\n", name, size, chunks[i][0], chunks[i][1]);
+            break;
+        }
+    }
+    free(expected);
+}
+
+static void check_golden(void)
+{
+    for(u32 i = 0; i < sizeof(golden_streams) / sizeof(golden_streams[0]); i++)
+    {
+        const Golden_Stream_s * golden = &golden_streams[i];
+        u8 * out = NULL;
+        u32 out_size = 0;
+        CHECK(decode(golden->data, golden->size, LZ11_STREAM_CHUNK_SIZE, LZ11_MAX_SIZE, &out, &out_size) == DECODE_OK);
+        CHECK(out_size == golden->expected_size);
+        CHECK(out != NULL && !memcmp(out, golden->expected, out_size));
+        free(out);
+        check_agrees(golden->name, golden->data, golden->size);
+    }
+
+    u8 * out = NULL;
+    u32 out_size = 0;
+    CHECK(decode(long_run, sizeof(long_run), LZ11_STREAM_CHUNK_SIZE, LZ11_MAX_SIZE, &out, &out_size) == DECODE_OK);
+    CHECK(out_size == 0x122);
+    for(u32 i = 0; out != NULL && i < out_size; i++)
+        CHECK(out[i] == 'z');
+    free(out);
+    check_agrees("long run", long_run, sizeof(long_run));
+}
+
+static void check_corrupt(void)
+{
+    u8 * out = NULL;
+    u32 out_size = 0;
+    CHECK(decode(bad_magic, sizeof(bad_magic), LZ11_STREAM_CHUNK_SIZE, LZ11_MAX_SIZE, &out, &out_size) == DECODE_NOT_LZ11);
+    CHECK(decode(header_only, sizeof(header_only), LZ11_STREAM_CHUNK_SIZE, LZ11_MAX_SIZE, &out, &out_size) == DECODE_NOT_LZ11);
+
+    // stopped at the bad token, after what was before it
+    CHECK(decode(disp_too_far, sizeof(disp_too_far), LZ11_STREAM_CHUNK_SIZE, LZ11_MAX_SIZE, &out, &out_size) == DECODE_CORRUPT);
+    CHECK(out_size == 1);
+    CHECK(decode(disp_at_start, sizeof(disp_at_start), LZ11_STREAM_CHUNK_SIZE, LZ11_MAX_SIZE, &out, &out_size) == DECODE_CORRUPT);
+    CHECK(out_size == 0);
+    CHECK(decode(len_too_long, sizeof(len_too_long), LZ11_STREAM_CHUNK_SIZE, LZ11_MAX_SIZE, &out, &out_size) == DECODE_CORRUPT);
+    CHECK(out_size == 1);
+    CHECK(decode(size_too_big, sizeof(size_too_big), LZ11_STREAM_CHUNK_SIZE, LZ11_MAX_SIZE, &out, &out_size) == DECODE_CORRUPT);
+    CHECK(out_size == 8);
+
+    check_agrees("disp too far", disp_too_far, sizeof(disp_too_far));
+    check_agrees("disp at start", disp_at_start, sizeof(disp_at_start));
+    check_agrees("len too long", len_too_long, sizeof(len_too_long));
+    check_agrees("size too big", size_too_big, sizeof(size_too_big));
+}
+
+// every prefix, then random bytes of the tokens changed
+static void check_damaged(const char * name, const char * data, u32 size, LZ11_Level level)
+{
+    char * compressed = NULL;
+    const u32 compressed_size = lz11_compress(data, size, &compressed, level);
+    CHECK(compressed_size != 0);
+    check_agrees(name, (const u8 *)compressed, compressed_size);
+
+    for(u32 prefix = LZ11_HEADER_SIZE; prefix < compressed_size && !test_failures; prefix++)
+    {
+        u8 * out = NULL;
+        u32 out_size = 0;
+        CHECK(decode((const u8 *)compressed, prefix, LZ11_STREAM_CHUNK_SIZE, LZ11_MAX_SIZE, &out, &out_size) == DECODE_CORRUPT);
+        CHECK(out_size < size);
+        if(test_failures)
+            printf("%s, level %d, cut at %u out of %u\n", name, level, prefix, compressed_size);
+    }
+
+    u8 * damaged = malloc(compressed_size);
+    u32 random = size ^ level;
+    for(u32 i = 0; i < 2000 && !test_failures; i++)
+    {
+        memcpy(damaged, compressed, compressed_size);
+        // the size in the header is checked above, changing it only makes big allocations
+        for(u32 flips = test_random(&random) % 4 + 1; flips != 0; flips--)
+        {
+            const u32 position = LZ11_HEADER_SIZE + test_random(&random) % (compressed_size - LZ11_HEADER_SIZE);
+            damaged[position] ^= test_random(&random) % 0xFF + 1;
+        }
+        check_agrees(name, damaged, compressed_size);
+    }
+    free(damaged);
+    free(compressed);
+}
+
+int main(void)
+{
+    // the decoder tells why it stops on each of the thousands of corrupt streams
+    freopen("/dev/null", "w", stderr);
+
+    check_golden();
+    check_corrupt();
+
+    Sample_s samples[SAMPLES_AMOUNT];
+    samples_make(samples);
+    for(int i = 0; i < SAMPLES_AMOUNT && !test_failures; i++)
+    {
+        for(LZ11_Level level = 0; level < LZ11_LEVEL_AMOUNT; level++)
+        {
+            char * compressed = NULL;
+            const u32 compressed_size = lz11_compress(samples[i].data, samples[i].size, &compressed, level);
+            check_agrees(samples[i].name, (const u8 *)compressed, compressed_size);
+            free(compressed);
+        }
+
+        // small enough for every prefix and damage to be tried
+        const u32 size = min(samples[i].size, 0x600);
+        for(LZ11_Level level = 0; level < LZ11_LEVEL_AMOUNT && !test_failures; level++)
+            check_damaged(samples[i].name, samples[i].data, size, level);
+    }
+    samples_free(samples);
+
+    return test_result();
+}
@@ -0,0 +1,276 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+// Patching LZ11 data in place: in a literal, in a match that gets split, with the rest of a flag group moved
+// under a new one, with every token after the patch regrouped, and data that already has the patch.
+// Every patched stream has to decode to the original data with the patch in it
+
+#include "test.h"
+#include "fs.h"
+#include "lz.h"
+
+#define LZ_PATCH_TEST_PATH u"/lz_patch_test.bin"
+#define BUILDER_SIZE 0x200
+
+// writes the tokens it's told to, so the tests know where the patch lands
+typedef struct {
+    u8 data[BUILDER_SIZE];
+    u32 size;
+    u32 flag_pos;
+    u32 tokens;
+    char decoded[BUILDER_SIZE];
+    u32 decoded_size;
+} Stream_Builder_s;
+
+static void builder_init(Stream_Builder_s * b)
+{
+    memset(b, 0, sizeof(*b));
+    b->data[0] = LZ11_MAGIC;
+    b->size = LZ11_HEADER_SIZE;
+}
+
+static void builder_start_token(Stream_Builder_s * b, bool is_match)
+{
+    if((b->tokens & 7) == 0)
+    {
+        b->flag_pos = b->size;
+        b->data[b->size++] = 0;
+    }
+    if(is_match)
+        b->data[b->flag_pos] |= 0x80 >> (b->tokens & 7);
+    b->tokens++;
+}
+
+static void builder_literals(Stream_Builder_s * b, const char * literals)
+{
+    for(; *literals; literals++)
+    {
+        builder_start_token(b, false);
+        b->data[b->size++] = *literals;
+        b->decoded[b->decoded_size++] = *literals;
+    }
+}
+
+// dist is how far back the match starts, 1 for the byte just before
+static void builder_match(Stream_Builder_s * b, u32 len, u32 dist)
+{
+    builder_start_token(b, true);
+    const u32 disp = dist - 1;
+    if(len <= 0x10)
+    {
+        b->data[b->size++] = ((len - 1) << 4) | (disp >> 8);
+    }
+    else
+    {
+        b->data[b->size++] = (len - 0x11) >> 4;
+        b->data[b->size++] = (((len - 0x11) & 0x0F) << 4) | (disp >> 8);
+    }
+    b->data[b->size++] = disp & 0xFF;
+
+    for(u32 i = 0; i < len; i++, b->decoded_size++)
+        b->decoded[b->decoded_size] = b->decoded[b->decoded_size - dist];
+}
+
+static void builder_finish(Stream_Builder_s * b)
+{
+    b->data[1] = b->decoded_size;
+    b->data[2] = b->decoded_size >> 8;
+    b->data[3] = b->decoded_size >> 16;
+}
+
+// whether data decodes to the original with the patch in it
+static bool decodes_patched(const u8 * data, u32 size, const char * original, u32 original_size, u32 offset, const char * patch, u32 patch_size)
+{
+    u8 * decoded = NULL;
+    const u32 decoded_size = reference_lz11_decompress(data, size, &decoded);
+    bool same = decoded_size == original_size
+        && !memcmp(decoded, original, offset)
+        && !memcmp(decoded + offset, patch, patch_size)
+        && !memcmp(decoded + offset + patch_size, original + offset + patch_size, original_size - offset - patch_size);
+    free(decoded);
+    return same;
+}
+
+// returns how much of the stream lz11_patch replaced, checking what the result decodes to
+static u32 check_patch(const char * name, const Stream_Builder_s * b, u32 offset, const char * patch, u32 patch_size, u32 * out_size)
+{
+    char * out = NULL;
+    u32 replaced = 0;
+    const bool patched = lz11_patch((const char *)b->data, b->size, offset, patch, patch_size, &out, out_size, &replaced);
+    CHECK(patched);
+    CHECK(replaced <= b->size);
+    if(!patched || replaced > b->size)
+    {
+        printf("%s\n", name);
+        return 0;
+    }
+
+    const u32 size = *out_size + b->size - replaced;
+    u8 * stream = malloc(size);
+    memcpy(stream, out, *out_size);
+    memcpy(stream + *out_size, b->data + replaced, b->size - replaced);
+    const bool same = decodes_patched(stream, size, b->decoded, b->decoded_size, offset, patch, patch_size);
+    CHECK(same);
+    if(!same)
+        printf("%s\n", name);
+
+    free(stream);
+    free(out);
+    return replaced;
+}
+
+static void test_literal(void)
+{
+    Stream_Builder_s b;
+    builder_init(&b);
+    builder_literals(&b, "ABCDEFGHIJKLMNOPQRST");
+    builder_finish(&b);
+
+    // the literals are changed where they are
+    u32 out_size = 0;
+    const u32 replaced = check_patch("literal", &b, 9, "xy", 2, &out_size);
+    CHECK(replaced != 0 && out_size == replaced && replaced < b.size);
+
+    // nothing to do when the data already has the patch
+    char * out = NULL;
+    u32 already_replaced = 1;
+    CHECK(lz11_patch((const char *)b.data, b.size, 9, "JK", 2, &out, &out_size, &already_replaced));
+    CHECK(out == NULL && out_size == 0 && already_replaced == 0);
+}
+
+static void test_match(void)
+{
+    // 7 literals and a match fill the first flag group
+    Stream_Builder_s b;
+    builder_init(&b);
+    builder_literals(&b, "abcdefg");
+    builder_match(&b, 40, 7);
+    const u32 group_end = b.size;
+    builder_literals(&b, "ABCDEFGHIJKLMNOPQRST");
+    builder_finish(&b);
+
+    // the match is split around the patch, the groups after it stay where they are
+    u32 out_size = 0;
+    CHECK(check_patch("match", &b, 20, "X", 1, &out_size) == group_end);
+}
+
+static void test_moved_group(void)
+{
+    // the match is in the middle of the first flag group
+    Stream_Builder_s b;
+    builder_init(&b);
+    builder_literals(&b, "abc");
+    builder_match(&b, 30, 3);
+    builder_literals(&b, "ABCD");
+    const u32 group_end = b.size;
+    builder_literals(&b, "EFGHIJKLMN");
+    builder_finish(&b);
+
+    // the literals after it in the group are moved under the flag byte of the new tokens
+    u32 out_size = 0;
+    CHECK(check_patch("moved group", &b, 15, "X", 1, &out_size) == group_end);
+}
+
+static void test_regroup_all(void)
+{
+    // the patch breaks the only match, leaving nothing to split for the groups to line up
+    Stream_Builder_s b;
+    builder_init(&b);
+    builder_literals(&b, "ABCDEFGHIJKLMNOPQRST");
+    builder_match(&b, 3, 20);
+    builder_literals(&b, "abcdefghijklmnopqrst");
+    builder_finish(&b);
+
+    u32 out_size = 0;
+    CHECK(check_patch("regroup all", &b, 21, "z", 1, &out_size) == b.size);
+}
+
+// patch_lz_file on a file with room after the data, returns the new size of the data
+static u32 patch_file(const u8 * data, u32 size, u32 room, u32 offset, const char * patch, u32 patch_size, u8 ** file_data)
+{
+    platform_file_delete(PLATFORM_ARCHIVE_SD, LZ_PATCH_TEST_PATH);
+    CHECK(R_SUCCEEDED(platform_file_create(PLATFORM_ARCHIVE_SD, LZ_PATCH_TEST_PATH, 0)));
+    char * padded = calloc(1, size + room);
+    memcpy(padded, data, size);
+    CHECK(R_SUCCEEDED(buf_to_file(size + room, LZ_PATCH_TEST_PATH, PLATFORM_ARCHIVE_SD, padded)));
+    free(padded);
+
+    const u32 new_size = patch_lz_file(LZ_PATCH_TEST_PATH, PLATFORM_ARCHIVE_SD, size, offset, patch, patch_size);
+    CHECK(file_to_buf(LZ_PATCH_TEST_PATH, PLATFORM_ARCHIVE_SD, (char **)file_data) == size + room);
+    return new_size;
+}
+
+static void test_file(void)
+{
+    Stream_Builder_s b;
+    builder_init(&b);
+    builder_literals(&b, "ABCDEFGHIJKLMNOPQRST");
+    builder_finish(&b);
+
+    // rewritten in place
+    u8 * file_data = NULL;
+    CHECK(patch_file(b.data, b.size, 0, 9, "xy", 2, &file_data) == b.size);
+    CHECK(file_data != NULL && decodes_patched(file_data, b.size, b.decoded, b.decoded_size, 9, "xy", 2));
+    free(file_data);
+
+    // already patched, left as it is
+    CHECK(patch_file(b.data, b.size, 0, 9, "JK", 2, &file_data) == b.size);
+    CHECK(file_data != NULL && !memcmp(file_data, b.data, b.size));
+    free(file_data);
+
+    // a repeat with the patch in it, then more noise than the first read of patch_lz_file gets,
+    // so the tail has to be read and moved after the resized start
+    const u32 size = 0x4000;
+    char * data = samples_noise(size, 0x1234);
+    for(u32 i = 16; i < 64; i++)
+        data[i] = data[i - 16];
+    char * compressed = NULL;
+    const u32 compressed_size = lz11_compress(data, size, &compressed, LZ11_LEVEL_LAZY);
+    CHECK(compressed_size > LZ11_PATCH_INPUT_SIZE(21));
+
+    const u32 new_size = patch_file((const u8 *)compressed, compressed_size, 0x40, 20, "\xFF", 1, &file_data);
+    CHECK(new_size != 0 && new_size != compressed_size);
+    CHECK(file_data != NULL && decodes_patched(file_data, new_size, data, size, 20, "\xFF", 1));
+    free(file_data);
+    free(compressed);
+    free(data);
+
+    platform_file_delete(PLATFORM_ARCHIVE_SD, LZ_PATCH_TEST_PATH);
+}
+
+int main(void)
+{
+    CHECK(R_SUCCEEDED(platform_archive_open(PLATFORM_ARCHIVE_SD, 0)));
+
+    test_literal();
+    test_match();
+    test_moved_group();
+    test_regroup_all();
+    test_file();
+
+    platform_archive_close(PLATFORM_ARCHIVE_SD);
+    return test_result();
+}
@@ -0,0 +1,198 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+// LZ11_Stream_s against the whole buffer decoder: the input comes in chunks of every size the read callback can give,
+// and the output is asked for in pieces of every size, so tokens, flag groups and back-references are cut everywhere
+
+#include "test.h"
+#include "lz.h"
+
+// sizes of the input chunks, in a loop up to the first 0. A pattern of only 0 picks random ones up to 0x200 bytes
+static const u32 chunk_patterns[][4] = {
+    {1},
+    {2},
+    {3},
+    {7, 1, 2},
+    {LZ11_STREAM_CHUNK_SIZE},
+    {0},
+};
+
+// sizes of the lz11_stream_read calls, the same way. The random ones go up to 3 windows
+static const u32 read_patterns[][4] = {
+    {1},
+    {5, 1},
+    {LZ11_WINDOW_SIZE - 1, LZ11_WINDOW_SIZE + 1},
+    {LZ11_STREAM_CHUNK_SIZE},
+    {0},
+    {LZ11_MAX_SIZE}, // everything at once
+};
+
+#define PATTERN_LENGTH(pattern) (sizeof(pattern) / sizeof(pattern[0]))
+
+typedef struct {
+    const u8 * data;
+    u32 size;
+    u32 position;
+    const u32 * pattern;
+    u32 step;
+    u32 random;
+} Chunked_Reader_s;
+
+static u32 next_size(const u32 * pattern, u32 * step, u32 * random, u32 random_max)
+{
+    u32 size = pattern[*step];
+    *step = (*step + 1) % 4;
+    if(pattern[*step] == 0)
+        *step = 0;
+
+    if(size == 0)
+        size = test_random(random) % random_max + 1;
+    return size;
+}
+
+static u32 chunked_read_callback(void * userdata, char * buf, u32 size)
+{
+    Chunked_Reader_s * reader = userdata;
+    u32 chunk = next_size(reader->pattern, &reader->step, &reader->random, 0x200);
+    chunk = min(chunk, size);
+    chunk = min(chunk, reader->size - reader->position);
+    memcpy(buf, reader->data + reader->position, chunk);
+    reader->position += chunk;
+    return chunk;
+}
+
+typedef struct {
+    const u8 * expected;
+    u32 size;
+    u32 position;
+    bool same;
+} Compare_Writer_s;
+
+static bool compare_callback(void * userdata, const char * buf, u32 size)
+{
+    Compare_Writer_s * writer = userdata;
+    if(size > writer->size - writer->position || memcmp(writer->expected + writer->position, buf, size))
+        writer->same = false;
+    else
+        writer->position += size;
+    return writer->same;
+}
+
+static void stream_matches(const char * name, const u8 * compressed, u32 compressed_size, const u8 * expected, u32 size)
+{
+    u8 * out = malloc(size ? size : 1);
+
+    for(u32 c = 0; c < PATTERN_LENGTH(chunk_patterns); c++)
+    {
+        for(u32 r = 0; r < PATTERN_LENGTH(read_patterns); r++)
+        {
+            Chunked_Reader_s reader = {compressed, compressed_size, 0, chunk_patterns[c], 0, c + r + 1};
+            LZ11_Stream_s * stream = malloc(sizeof(LZ11_Stream_s));
+            CHECK(lz11_stream_open(stream, chunked_read_callback, &reader));
+            CHECK(stream->size == size);
+
+            u32 step = 0, random = r + 1, produced = 0, read = 0;
+            do
+            {
+                // exactly the room asked for, so the sanitizers see anything written past it
+                const u32 want = min(next_size(read_patterns[r], &step, &random, 3 * LZ11_WINDOW_SIZE), size - produced);
+                u8 * piece = malloc(want ? want : 1);
+                read = lz11_stream_read(stream, (char *)piece, want);
+                CHECK(read <= want);
+                memcpy(out + produced, piece, read);
+                produced += read;
+                free(piece);
+            } while(read != 0 && produced < size);
+
+            CHECK(!stream->error);
+            CHECK(produced == size);
+            CHECK(!memcmp(out, expected, size));
+            // nothing after the end
+            CHECK(lz11_stream_read(stream, (char *)out, size) == 0);
+            free(stream);
+
+            if(test_failures)
+            {
+                printf("%s, %u bytes, chunk pattern %u, read pattern %u\n", name, size, c, r);
+                free(out);
+                return;
+            }
+        }
+
+        Chunked_Reader_s reader = {compressed, compressed_size, 0, chunk_patterns[c], 0, c + 1};
+        Compare_Writer_s writer = {expected, size, 0, true};
+        CHECK(lz11_decompress_stream(chunked_read_callback, &reader, compare_callback, &writer) == size);
+        CHECK(writer.same && writer.position == size);
+    }
+
+    free(out);
+}
+
+static void check_sample(const char * name, const char * data, u32 size)
+{
+    for(LZ11_Level level = 0; level < LZ11_LEVEL_AMOUNT && !test_failures; level++)
+    {
+        char * compressed = NULL;
+        const u32 compressed_size = lz11_compress(data, size, &compressed, level);
+
+        u8 * golden = NULL;
+        CHECK(reference_lz11_decompress((const u8 *)compressed, compressed_size, &golden) == size);
+        CHECK(golden != NULL && !memcmp(golden, data, size));
+        if(golden != NULL)
+            stream_matches(name, (const u8 *)compressed, compressed_size, golden, size);
+
+        free(golden);
+        free(compressed);
+    }
+}
+
+int main(void)
+{
+    Sample_s samples[SAMPLES_AMOUNT];
+    samples_make(samples);
+    for(int i = 0; i < SAMPLES_AMOUNT && !test_failures; i++)
+        check_sample(samples[i].name, samples[i].data, samples[i].size);
+    samples_free(samples);
+
+    // matches longer than a read, and than the history
+    char * runs = samples_noise(LZ11_MAX_MATCH * 3, 3);
+    for(u32 i = 0; i < LZ11_MAX_MATCH * 2; i++)
+        runs[LZ11_WINDOW_SIZE + i] = runs[i % LZ11_WINDOW_SIZE];
+    check_sample("window runs", runs, LZ11_MAX_MATCH * 3);
+    free(runs);
+
+    static const u32 sizes[] = {0, 1, 2, 8, 9, 0x111, LZ11_WINDOW_SIZE + 1};
+    for(u32 i = 0; i < sizeof(sizes) / sizeof(sizes[0]) && !test_failures; i++)
+    {
+        char * noise = samples_noise(sizes[i], sizes[i] + 7);
+        check_sample("noise", noise, sizes[i]);
+        memset(noise, 'A', sizes[i]);
+        check_sample("one byte", noise, sizes[i]);
+        free(noise);
+    }
+
+    return test_result();
+}
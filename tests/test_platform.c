@@ -0,0 +1,145 @@
+/*
+*   This file is part of Anemone3DS
+*   Copyright (C) 2016-2020 Contributors in CONTRIBUTORS.md
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+// The file and folder calls of the POSIX platform layer, its SHA-256, and the fs.c functions on top of them
+
+#include "test.h"
+#include "fs.h"
+
+static void test_files(void)
+{
+    Platform_File file;
+    CHECK(R_SUCCEEDED(platform_file_create(PLATFORM_ARCHIVE_SD, u"/platform_test/a.zip", 10)));
+    CHECK(R_SUCCEEDED(platform_file_open(&file, PLATFORM_ARCHIVE_SD, u"/platform_test/a.zip", PLATFORM_OPEN_WRITE)));
+    u32 written = 0;
+    CHECK(R_SUCCEEDED(platform_file_write(file, 2, "hello", 5, &written)));
+    CHECK(written == 5);
+    platform_file_close(file);
+
+    CHECK(R_SUCCEEDED(platform_file_open(&file, PLATFORM_ARCHIVE_SD, u"/platform_test/a.zip", PLATFORM_OPEN_READ)));
+    u64 size = 0;
+    CHECK(R_SUCCEEDED(platform_file_get_size(file, &size)));
+    CHECK(size == 10);
+    char buf[16] = {0};
+    u32 read = 0;
+    CHECK(R_SUCCEEDED(platform_file_read(file, 0, buf, sizeof(buf), &read)));
+    CHECK(read == 10);
+    CHECK(!memcmp(buf, "\0\0hello\0\0\0", 10));
+    platform_file_close(file);
+
+    const Result res = platform_file_open(&file, PLATFORM_ARCHIVE_SD, u"/platform_test/missing", PLATFORM_OPEN_READ);
+    CHECK(R_FAILED(res) && platform_not_found(res));
+}
+
+static void test_fs(void)
+{
+    CHECK(R_SUCCEEDED(write_file(u"/platform_test/b.bin", PLATFORM_ARCHIVE_SD, "abc", 3, 8)));
+    char * buf = NULL;
+    CHECK(file_to_buf(u"/platform_test/b.bin", PLATFORM_ARCHIVE_SD, &buf) == 8);
+    CHECK(buf != NULL && !memcmp(buf, "abc\0\0\0\0\0", 8));
+    free(buf);
+}
+
+static void test_dirs(void)
+{
+    CHECK(R_SUCCEEDED(platform_dir_create(PLATFORM_ARCHIVE_SD, u"/platform_test/sub")));
+
+    Platform_Dir dir;
+    CHECK(R_SUCCEEDED(platform_dir_open(&dir, PLATFORM_ARCHIVE_SD, u"/platform_test")));
+    Platform_Dir_Entry_s entries[8];
+    u32 read = 0;
+    CHECK(R_SUCCEEDED(platform_dir_read(dir, entries, 8, &read)));
+    CHECK(read == 3);
+    bool found_zip = false, found_sub = false;
+    for(u32 i = 0; i < read; i++)
+    {
+        if(!memcmp(entries[i].name, u"a.zip", sizeof(u"a.zip")))
+        {
+            found_zip = true;
+            CHECK(!strcmp(entries[i].short_ext, "ZIP"));
+            CHECK(!entries[i].is_directory && entries[i].size == 10);
+        }
+        else if(!memcmp(entries[i].name, u"sub", sizeof(u"sub")))
+        {
+            found_sub = true;
+            CHECK(entries[i].is_directory && entries[i].short_ext[0] == '\0');
+        }
+    }
+    CHECK(found_zip && found_sub);
+    CHECK(R_SUCCEEDED(platform_dir_read(dir, entries, 8, &read)) && read == 0);
+    platform_dir_close(dir);
+
+    CHECK(R_SUCCEEDED(platform_dir_delete(PLATFORM_ARCHIVE_SD, u"/platform_test")));
+    const Result res = platform_dir_open(&dir, PLATFORM_ARCHIVE_SD, u"/platform_test");
+    CHECK(R_FAILED(res) && platform_not_found(res));
+}
+
+static void test_sha256(void)
+{
+    static const u8 abc_hash[SHA256_HASH_SIZE] = {
+        0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+        0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad,
+    };
+    u8 hash[SHA256_HASH_SIZE];
+    platform_sha256("abc", 3, hash);
+    CHECK(!memcmp(hash, abc_hash, SHA256_HASH_SIZE));
+
+    // in random pieces, around the end of a block and of the room left for the size
+    static const u32 sizes[] = {0, 1, 55, 56, 63, 64, 65, 119, 120, 1000, 0x10001};
+    u32 state = 1;
+    for(u32 i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        char * data = samples_noise(sizes[i] + 1, sizes[i] + 1);
+        platform_sha256(data, sizes[i], hash);
+
+        Platform_Sha256_s context;
+        platform_sha256_init(&context);
+        for(u32 done = 0, piece = 0; done < sizes[i]; done += piece)
+        {
+            piece = min(test_random(&state) % 130, sizes[i] - done);
+            platform_sha256_update(&context, data + done, piece);
+        }
+        u8 pieces_hash[SHA256_HASH_SIZE];
+        platform_sha256_final(&context, pieces_hash);
+        CHECK(!memcmp(hash, pieces_hash, SHA256_HASH_SIZE));
+        free(data);
+    }
+}
+
+int main(void)
+{
+    CHECK(R_SUCCEEDED(platform_archive_open(PLATFORM_ARCHIVE_SD, 0)));
+    platform_dir_delete(PLATFORM_ARCHIVE_SD, u"/platform_test");
+    CHECK(R_SUCCEEDED(platform_dir_create(PLATFORM_ARCHIVE_SD, u"/platform_test")));
+
+    test_files();
+    test_fs();
+    test_dirs();
+    test_sha256();
+
+    platform_archive_close(PLATFORM_ARCHIVE_SD);
+    return test_result();
+}